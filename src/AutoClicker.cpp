@@ -1,11 +1,12 @@
 #include "AutoClicker.h"
-#include <QApplication>
+#include "DisplayTopology.h"
 #include <QDebug>
-#include <QScreen>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
 
-// Windows-specific includes
-#include <windows.h>
-#pragma comment(lib, "user32.lib")
+#include <algorithm>
+#include <utility>
 
 AutoClicker::AutoClicker(QObject* parent) : QObject(parent) {
     // Initialize member variables with safe defaults
@@ -16,27 +17,32 @@ AutoClicker::AutoClicker(QObject* parent) : QObject(parent) {
     m_isRunning = false;
     m_useDynamicPosition = true; // Default to using cursor position
 
-    // Configure timer with safer settings
-    m_timer.setSingleShot(false);
-    m_timer.setInterval(1000); // Default 1 second
-    m_timer.setTimerType(Qt::PreciseTimer);
+    // Native injection backend; uinput needs the desktop size for its axes
+    m_display = &DisplayTopology::instance()->cache();
+    m_backend = createDefaultInputBackend(m_display->virtualDesktop());
+    if (m_backend) {
+        m_backend->setDisplayCache(m_display);
+    }
+    m_recorder = createDefaultMacroRecorder(m_display->virtualDesktop());
 
-    // Use queued connection to prevent crashes during rapid start/stop
-    connect(&m_timer, &QTimer::timeout, this, &AutoClicker::performClick, Qt::QueuedConnection);
+    m_tracePath = qEnvironmentVariable("FLAME_TRACE");
 
-    qDebug() << "AutoClicker initialized for Windows";
+    qDebug() << "AutoClicker initialized with input backend:" << (m_backend ? m_backend->name() : "none");
 }
 
 AutoClicker::~AutoClicker() {
-    // Force stop with cleanup
-    if (m_isRunning) {
-        m_timer.stop();
-        m_isRunning = false;
+    // Joins the engine, playback and capture threads before members go away
+    if (m_recorder) {
+        m_recorder->stop();
     }
+    m_player.stop();
+    m_engine.stop();
+    m_scheduler.stop();
+    m_isRunning = false;
 
-    // Ensure timer is completely stopped
-    if (m_timer.isActive()) {
-        m_timer.stop();
+    if (m_trace.isOpen()) {
+        qDebug() << "Click trace closed with" << m_trace.recordCount() << "records," << m_trace.dropped() << "dropped";
+        m_trace.close();
     }
 
     qDebug() << "AutoClicker destroyed safely";
@@ -51,22 +57,37 @@ void AutoClicker::setInterval(qint64 ms) {
     if (ms > MAX_INTERVAL) ms = MAX_INTERVAL;
     if (ms < MIN_INTERVAL) ms = MIN_INTERVAL;
 
-    int interval = static_cast<int>(ms);
+    // Takes effect on the next start()
+    m_intervalUs = ms * 1000;
 
-    // Stop timer before changing interval
-    bool wasActive = m_timer.isActive();
-    if (wasActive) {
-        m_timer.stop();
-    }
+    qDebug() << "Interval set to:" << ms << "ms";
+}
 
-    m_timer.setInterval(interval);
+void AutoClicker::setIntervalMicroseconds(qint64 us) {
+    // High-rate mode floor: 100us (10,000 CPS); bursts go down to 1us (1,000,000 CPS)
+    const qint64 MIN_INTERVAL_US = m_burst ? 1 : 100;
+    const qint64 MAX_INTERVAL_US = 3600000000LL; // 1 hour max
 
-    // Restart if it was active
-    if (wasActive && m_isRunning) {
-        m_timer.start();
-    }
+    if (us > MAX_INTERVAL_US) us = MAX_INTERVAL_US;
+    if (us < MIN_INTERVAL_US) us = MIN_INTERVAL_US;
 
-    qDebug() << "Interval set to:" << interval << "ms";
+    m_intervalUs = us;
+    qDebug() << "Interval set to:" << us << "us";
+}
+
+void AutoClicker::setHighRateMode(bool enabled) {
+    m_highRate = enabled;
+    qDebug() << "High-rate mode:" << (enabled ? "enabled" : "disabled");
+}
+
+void AutoClicker::setAdaptiveRate(bool enabled) {
+    m_adaptive = enabled;
+    qDebug() << "Adaptive rate:" << (enabled ? "enabled" : "disabled");
+}
+
+void AutoClicker::setBurstMode(bool enabled) {
+    m_burst = enabled;
+    qDebug() << "Burst mode:" << (enabled ? "enabled" : "disabled");
 }
 
 void AutoClicker::setClickCount(int count) {
@@ -96,244 +117,678 @@ void AutoClicker::setRightClick(bool enabled) {
     qDebug() << "Right click:" << (enabled ? "enabled" : "disabled");
 }
 
+void AutoClicker::setInstantMove(bool enabled) {
+    m_instantMove = enabled;
+    qDebug() << "Instant move:" << (enabled ? "enabled" : "disabled");
+}
+
+void AutoClicker::setKeyPress(uint16_t key, uint8_t modifiers) {
+    m_pressKey = key;
+    m_pressModifiers = key != 0 ? modifiers : 0;
+    qDebug() << "Key press:" << (key != 0 ? QString("key %1, modifiers %2").arg(key).arg(modifiers) : QString("off"));
+}
+
 bool AutoClicker::start() {
+    const ClickEngine::Clock::time_point trigger = takeTrigger();
     if (m_isRunning) {
         qDebug() << "AutoClicker already running";
         return true;
     }
+    if (isRecording() || m_isPlaying) {
+        emit error("Stop recording or playing the macro first");
+        return false;
+    }
 
-    // Start runtime timer
-    if (m_duration > 0) {
-        m_runtime.start();
+    // Queued jobs were validated when added; otherwise the current settings run
+    m_jobMode = m_scheduler.jobCount() > 0;
+    if (!m_jobMode) {
+        const QString problem = validateSettings();
+        if (!problem.isEmpty()) {
+            emit error(problem);
+            return false;
+        }
     }
 
-    // Enforce 5ms minimum
-    if (m_timer.interval() < 5) {
-        qWarning() << "Cannot start: Interval too low" << m_timer.interval();
-        emit error("Click interval too fast (minimum 5ms)");
+    if (!m_backend) {
+        emit error("No input backend available on this platform");
         return false;
     }
 
-    // Dynamic vs Fixed Position Check (Fixing Lag & Multi-monitor support)
-    if (m_useDynamicPosition) {
-        // Dynamic: Ensure position is invalid to signal `performWindowsClick` to skip movement
-        m_position = QPoint(-1, -1);
-        qDebug() << "Dynamic position mode active: Clicking at live cursor location.";
-    } else {
-        // Validate using Virtual Screen metrics (Multi-monitor fix)
-        int vScreenX = GetSystemMetrics(SM_XVIRTUALSCREEN);
-        int vScreenY = GetSystemMetrics(SM_YVIRTUALSCREEN);
-        int vScreenWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
-        int vScreenHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
-
-        if (m_position.x() < vScreenX || m_position.x() >= (vScreenX + vScreenWidth) ||
-            m_position.y() < vScreenY || m_position.y() >= (vScreenY + vScreenHeight)) {
-            qWarning() << "Cannot start: Position outside virtual screen bounds";
-            emit error("Click position outside virtual screen");
-            return false;
+    // Acquire the backend (probes API access / creates the virtual device)
+    if (!m_backend->open()) {
+        const QString reason = QString::fromStdString(m_backend->lastError());
+        qWarning() << "Cannot open input backend" << m_backend->name() << ":" << reason;
+        emit error(reason);
+        return false;
+    }
+
+    if (m_jobMode) {
+        return startJobs(trigger);
+    }
+
+    // Build the per-click routine once; the engine thread only submits it.
+    // No per-click logging or signals: the UI samples clicksPerformed() instead
+    m_engine.setClickFunction(compileClickProgram(*m_backend, clickConfig(), m_display));
+    const ClickEngine::Settings settings = engineSettings();
+
+    // Trace mode: one file per session, every run appends to it
+    if (!m_tracePath.isEmpty() && !m_trace.isOpen()) {
+        const size_t TRACE_RECORDS = 1 << 20; // 32 MB
+        if (m_trace.open(m_tracePath.toStdString(), TRACE_RECORDS)) {
+            qDebug() << "Tracing clicks to" << m_tracePath;
+        } else {
+            qWarning() << "Click trace disabled:" << QString::fromStdString(m_trace.lastError());
+            m_tracePath.clear();
         }
-        qDebug() << "Fixed position set to:" << m_position;
     }
 
-    // Test Windows API access
-    POINT pt;
-    if (!GetCursorPos(&pt)) {
-        DWORD lastError = GetLastError();
-        qWarning() << "Cannot access Windows cursor API. Error:" << lastError;
-        emit error(QString("Windows API access denied (Error: %1)").arg(lastError));
+    ClickEngine::Probes probes;
+    probes.wakeLateness = &m_latency.wakeLateness;
+    probes.injection = &m_latency.injection;
+    probes.trace = m_trace.isOpen() ? &m_trace : nullptr;
+    m_engine.setProbes(probes);
+
+    // Engine completion arrives on the engine thread; hop back to the GUI thread.
+    // The run id lets the slot ignore a completion queued by an earlier run.
+    const int runId = ++m_runId;
+    m_engine.setFinishedCallback([this, runId](ClickEngine::StopReason reason) {
+        QMetaObject::invokeMethod(this, "onEngineFinished", Qt::QueuedConnection,
+                                  Q_ARG(int, static_cast<int>(reason)), Q_ARG(int, runId));
+    });
+
+    // Set running flag before starting the engine thread
+    m_isRunning = true;
+    m_startTrigger = trigger;
+    m_liveRate.clear();
+
+    if (!m_engine.start(settings)) {
+        m_isRunning = false;
+        emit error("Failed to start click engine thread");
         return false;
     }
 
-    // Set running flag before starting timer
-    m_isRunning = true;
+    if (settings.burst > 1) {
+        qDebug() << "Burst mode:" << settings.burst << "clicks every"
+                 << std::chrono::duration_cast<std::chrono::microseconds>(settings.interval).count() << "us";
+    }
+    qDebug() << "AutoClicker started successfully";
+    emit started();
+    return true;
+}
+
+bool AutoClicker::startJobs(ClickEngine::Clock::time_point trigger) {
+    m_scheduler.setBackend(m_backend.get(), m_display);
 
-    // Start timer with error checking
-    m_timer.start();
+    const int runId = ++m_runId;
+    m_scheduler.setFinishedCallback([this, runId](ClickEngine::StopReason reason) {
+        QMetaObject::invokeMethod(this, "onEngineFinished", Qt::QueuedConnection,
+                                  Q_ARG(int, static_cast<int>(reason)), Q_ARG(int, runId));
+    });
 
-    // Verify timer actually started
-    if (!m_timer.isActive()) {
+    m_isRunning = true;
+    m_startTrigger = trigger;
+    m_liveRate.clear();
+
+    if (!m_scheduler.start()) {
         m_isRunning = false;
-        emit error("Failed to start internal timer");
+        emit error("Failed to start click job scheduler");
         return false;
     }
 
-    qDebug() << "AutoClicker started successfully";
+    qDebug() << "AutoClicker started" << m_scheduler.jobCount() << "click jobs";
     emit started();
     return true;
 }
 
+int AutoClicker::addJob() {
+    if (m_isRunning) {
+        qWarning() << "Cannot add a click job while running";
+        return -1;
+    }
+    const QString problem = validateSettings();
+    if (!problem.isEmpty()) {
+        emit error(problem);
+        return -1;
+    }
+
+    const ClickEngine::Settings settings = engineSettings();
+    ClickJob job;
+    job.click = clickConfig();
+    job.interval = settings.interval;
+    job.clickLimit = settings.clickLimit;
+    job.duration = settings.duration;
+    job.highRate = settings.highRate;
+    job.missPolicy = settings.missPolicy;
+
+    const int id = m_scheduler.addJob(job);
+    qDebug() << "Click job" << id << "added:" << m_intervalUs << "us interval," << m_remainingClicks << "clicks";
+    return id;
+}
+
+void AutoClicker::clearJobs() {
+    if (m_isRunning) {
+        qWarning() << "Cannot clear click jobs while running";
+        return;
+    }
+    m_scheduler.clearJobs();
+    m_jobMode = false;
+}
+
+bool AutoClicker::reconfigure() {
+    // Queued jobs are fixed for the run
+    if (m_jobMode) {
+        return false;
+    }
+    if (!m_isRunning || !m_engine.isRunning()) {
+        return false;
+    }
+    // A rejected edit keeps the running configuration; the run itself is fine
+    const QString problem = validateSettings();
+    if (!problem.isEmpty()) {
+        qWarning() << "Keeping the running configuration:" << problem;
+        return false;
+    }
+
+    // Compiled here on the GUI thread; the engine picks the new snapshot up
+    // at its next wake-up and never waits for this thread
+    if (!m_engine.reconfigure(engineSettings(), compileClickProgram(*m_backend, clickConfig(), m_display))) {
+        qWarning() << "Click engine rejected the new configuration";
+        return false;
+    }
+
+    qDebug() << "AutoClicker reconfigured while running";
+    return true;
+}
+
+QString AutoClicker::validateSettings() {
+    // Enforce 5ms minimum outside of high-rate mode
+    if (!m_highRate && m_intervalUs < 5000) {
+        qWarning() << "Invalid settings: Interval too low" << m_intervalUs << "us";
+        return "Click interval too fast (minimum 5ms)";
+    }
+
+    // Dynamic vs Fixed Position Check (Fixing Lag & Multi-monitor support)
+    if (m_pressKey != 0) {
+        // Keys go to the focused window; the position is not used
+        qDebug() << "Key press mode active: position ignored.";
+    } else if (m_useDynamicPosition) {
+        // Dynamic: position is unused, clicks land at the live cursor
+        m_position = QPoint(-1, -1);
+        qDebug() << "Dynamic position mode active: Clicking at live cursor location.";
+    } else {
+        // Validate against the cached virtual desktop (Multi-monitor fix)
+        if (!m_display->contains(m_position.x(), m_position.y())) {
+            qWarning() << "Invalid settings: Position outside virtual screen bounds";
+            return "Click position outside virtual screen";
+        }
+        qDebug() << "Fixed position set to:" << m_position;
+    }
+    return QString();
+}
+
+ClickConfig AutoClicker::clickConfig() const {
+    ClickConfig config;
+    config.button = m_rightClick ? MouseButton::Right : MouseButton::Left;
+    config.doubleClick = m_doubleClick;
+    config.mode = m_useDynamicPosition ? PositionMode::Dynamic
+                : m_instantMove ? PositionMode::FixedInstant : PositionMode::Fixed;
+    config.x = m_position.x();
+    config.y = m_position.y();
+    config.burst = burstSize();
+    config.key = m_pressKey;
+    config.modifiers = m_pressModifiers;
+    return config;
+}
+
+ClickEngine::Settings AutoClicker::engineSettings() const {
+    ClickEngine::Settings settings;
+    settings.interval = std::chrono::microseconds(m_intervalUs);
+    settings.highRate = m_highRate;
+    settings.clickLimit = m_remainingClicks;
+    settings.duration = std::chrono::milliseconds(m_duration > 0 ? m_duration : 0);
+    settings.missPolicy = m_missPolicy;
+    settings.adaptive = m_adaptive;
+    if (m_burst) {
+        // One wake-up per millisecond, matching the 1 ms timer period the engine
+        // requests; 1000 clicks per injection at the 1us floor
+        const auto BURST_WAKE_PERIOD = std::chrono::milliseconds(1);
+        const int MAX_BURST = 1000;
+        settings = ClickEngine::planBurst(settings, BURST_WAKE_PERIOD, MAX_BURST);
+    }
+    return settings;
+}
+
 void AutoClicker::stop() {
     if (!m_isRunning) {
         return;
     }
 
-    // Force stop timer
-    m_timer.stop();
+    if (m_jobMode) {
+        takeTrigger();
+        m_scheduler.stop();
+        m_isRunning = false;
+        qDebug() << "AutoClicker stopped click jobs:" << m_scheduler.clicksPerformed() << "clicks in"
+                 << m_scheduler.batchesSubmitted() << "batches," << m_scheduler.missedDeadlines() << "missed deadlines";
+        emit stopped();
+        return;
+    }
+
+    // Only a stop that interrupts the engine says anything about stop latency
+    const ClickEngine::Clock::time_point trigger = takeTrigger();
+    const bool interrupted = m_engine.isRunning();
+
+    // Atomic cancellation: the engine thread checks it before every injection,
+    // and stop() returns only after that thread has exited
+    const auto stopBegin = std::chrono::steady_clock::now();
+    m_engine.stop();
     m_isRunning = false;
+    const auto stopUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - stopBegin);
 
-    // Process any pending events to ensure clean shutdown
-    QApplication::processEvents();
+    if (const auto first = m_engine.firstClickTime()) {
+        m_latency.startToFirst.record(*first - m_startTrigger);
+    }
+    const auto end = m_engine.endTime();
+    if (interrupted && end) {
+        m_latency.stopToLast.record(*end - trigger);
+    }
 
-    qDebug() << "AutoClicker stopped";
+    // Keep the count in sync with what the engine actually performed
+    m_remainingClicks = static_cast<int>(m_engine.remainingClicks());
+
+    const std::string diagnostics = m_backend ? m_backend->diagnostics() : std::string();
+    if (!diagnostics.empty()) {
+        qDebug() << "Input backend" << m_backend->name() << QString::fromStdString(diagnostics);
+    }
+
+    const ClickEngine::Stats stats = m_engine.stats();
+    if (stats.missedDeadlines > 0) {
+        qDebug() << "Click engine missed" << stats.missedDeadlines << "deadline(s) during the run";
+    }
+    if (stats.backoffs > 0) {
+        qDebug() << "Click rate backed off" << stats.backoffs << "time(s), ended at"
+                 << qRound(stats.rateFactor * 100.0) << "% of the requested rate";
+    }
+    qDebug() << "AutoClicker stopped, engine joined in" << stopUs.count() << "us";
     emit stopped();
 }
 
-bool AutoClicker::isActive() const {
-    return m_isRunning && m_timer.isActive();
-}
+bool AutoClicker::startRecording() {
+    if (isRecording()) {
+        return true;
+    }
+    if (m_isRunning || m_isPlaying) {
+        emit error("Stop clicking or playing before recording a macro");
+        return false;
+    }
+    if (!m_recorder) {
+        emit error("Macro recording is not available on this platform");
+        return false;
+    }
 
-void AutoClicker::setDuration(qint64 ms) {
-    m_duration = ms;
-    if (ms > 0) {
-        qDebug() << "Duration set to:" << ms << "ms";
-    } else {
-        qDebug() << "No duration limit set";
+    // A few minutes of 1 kHz mouse motion before the capture thread allocates again
+    m_macro.reserve(MacroReserveEvents);
+    if (!m_recorder->start(m_macro)) {
+        const QString reason = QString::fromStdString(m_recorder->lastError());
+        qWarning() << "Cannot start macro recorder" << m_recorder->name() << ":" << reason;
+        emit error(reason);
+        return false;
     }
+    // The new recording is the macro from now on
+    m_macroFile.close();
+    qDebug() << "Macro recording started with" << m_recorder->name();
+    emit recordingStarted();
+    return true;
 }
 
-void AutoClicker::performClick() {
-    // Critical: Check if we're still supposed to be running
-    if (!m_isRunning || !m_timer.isActive()) {
-        qDebug() << "performClick called but autoclicker is not active";
+void AutoClicker::stopRecording(bool dropTrailingClick) {
+    if (!isRecording()) {
         return;
     }
+    m_recorder->stop();
 
-    // Check duration limit
-    if (m_duration > 0 && m_runtime.hasExpired(m_duration)) {
-        stop();
-        emit finished();
-        return;
+    if (dropTrailingClick) {
+        // Cut from the press that belongs to the last release
+        size_t size = m_macro.size();
+        while (size > 0 && m_macro.at(size - 1).type != MacroEvent::Type::ButtonUp) {
+            --size;
+        }
+        if (size > 0) {
+            const uint16_t button = m_macro.at(size - 1).code;
+            while (size > 0) {
+                const MacroEvent event = m_macro.at(--size);
+                if (event.type == MacroEvent::Type::ButtonDown && event.code == button) {
+                    break;
+                }
+            }
+            m_macro.truncate(size);
+        }
     }
 
-    // Check click count limit
-    if (m_remainingClicks == 0) {
-        stop();
-        emit finished();
-        return;
+    qDebug() << "Macro recorded:" << m_macro.size() << "events over" << m_macro.durationUs() / 1000 << "ms";
+    emit recordingStopped();
+}
+
+const MacroTimeline& AutoClicker::macro() const {
+    if (m_macroFile.isOpen()) {
+        return m_macroFile;
     }
+    return m_macro;
+}
 
-    // Use the position that was set (either fixed or the dynamic signal -1, -1)
-    QPoint clickPos = m_position;
+bool AutoClicker::saveMacro(const QString& path) {
+    if (isRecording()) {
+        emit error("Stop recording before saving the macro");
+        return false;
+    }
+    if (m_macro.empty()) {
+        emit error("No macro recorded yet");
+        return false;
+    }
 
-    qDebug() << "Performing click at:" << clickPos << "Remaining:" << m_remainingClicks;
+    std::string reason;
+    if (!saveMacroFile(m_macro, QFile::encodeName(path).toStdString(), reason)) {
+        qWarning() << "Cannot save macro:" << QString::fromStdString(reason);
+        emit error(QString::fromStdString(reason));
+        return false;
+    }
+    qDebug() << "Macro saved to" << path << ":" << m_macro.size() << "events," << QFileInfo(path).size() << "bytes";
+    return true;
+}
 
-    // Perform Windows click
-    bool success = performWindowsClick(clickPos.x(), clickPos.y(), m_rightClick, m_doubleClick);
+bool AutoClicker::loadMacro(const QString& path) {
+    if (isRecording() || m_isPlaying) {
+        emit error("Stop recording or playing before opening a macro");
+        return false;
+    }
+    if (!m_macroFile.open(QFile::encodeName(path).toStdString())) {
+        const QString reason = QString::fromStdString(m_macroFile.lastError());
+        qWarning() << "Cannot open macro" << path << ":" << reason;
+        emit error(reason);
+        return false;
+    }
+    qDebug() << "Macro opened from" << path << ":" << m_macroFile.size() << "events in"
+             << m_macroFile.blockCount() << "blocks";
+    return true;
+}
 
-    if (!success) {
-        qWarning() << "Windows click failed";
-        stop();
-        emit error("Click operation failed");
-        return;
+bool AutoClicker::importTimeline(const QString& source, const QString& target) {
+    if (isRecording() || m_isPlaying) {
+        emit error("Stop recording or playing before importing");
+        return false;
+    }
+    // The target may be the file mapped right now
+    const std::string targetPath = QFile::encodeName(target).toStdString();
+    if (m_macroFile.isOpen() && m_macroFile.path() == targetPath) {
+        m_macroFile.close();
     }
 
-    // Decrement remaining clicks
-    if (m_remainingClicks > 0) {
-        m_remainingClicks--;
+    TimelineImportOptions options;
+    options.display = m_display;
+    std::string reason;
+    if (!::importTimeline(QFile::encodeName(source).toStdString(), targetPath, options, m_lastImport, reason)) {
+        qWarning() << "Cannot import" << source << ":" << QString::fromStdString(reason);
+        emit error(QString::fromStdString(reason));
+        return false;
     }
+    qDebug() << "Imported" << m_lastImport.clicks << "clicks from" << source << "in" << m_lastImport.seconds << "s:"
+             << m_lastImport.rowsPerSecond() << "rows/s," << m_lastImport.megabytesPerSecond() << "MB/s,"
+             << m_lastImport.offScreen << "off-screen," << (m_lastImport.sorted ? "already sorted" : "sorted")
+             << "," << m_lastImport.outputBytes << "bytes written";
+    return loadMacro(target);
+}
 
-    emit clickPerformed(clickPos);
+void AutoClicker::setPlaybackSpeed(double speed) {
+    m_playbackSpeed = std::clamp(speed, MacroPlayer::MinSpeed, MacroPlayer::MaxSpeed);
+    qDebug() << "Playback speed set to:" << m_playbackSpeed << "x";
 }
 
-// LAG FIX IMPLEMENTATION
-bool AutoClicker::performWindowsClick(int x, int y, bool rightClick, bool doubleClick) {
-    // Dynamic detection: (-1, -1) is the signal to click where the mouse is now.
-    bool isDynamic = (x == -1 && y == -1);
+bool AutoClicker::startPlayback() {
+    if (m_isPlaying) {
+        return true;
+    }
+    if (m_isRunning || isRecording()) {
+        emit error("Stop clicking or recording before playing the macro");
+        return false;
+    }
+    MacroTimeline* macro = m_macroFile.isOpen() ? static_cast<MacroTimeline*>(&m_macroFile) : &m_macro;
+    if (macro->empty()) {
+        emit error("No macro recorded yet");
+        return false;
+    }
+    if (!m_backend) {
+        emit error("No input backend available on this platform");
+        return false;
+    }
+    if (!m_backend->open()) {
+        const QString reason = QString::fromStdString(m_backend->lastError());
+        qWarning() << "Cannot open input backend" << m_backend->name() << ":" << reason;
+        emit error(reason);
+        return false;
+    }
+
+    m_player.setBackend(m_backend.get());
+    m_player.setMacro(macro);
 
-    POINT originalPos = {0, 0};
+    // Same hop back to the GUI thread as the click engine's completion
+    const int runId = ++m_runId;
+    m_player.setFinishedCallback([this, runId](ClickEngine::StopReason reason) {
+        QMetaObject::invokeMethod(this, "onPlaybackFinished", Qt::QueuedConnection,
+                                  Q_ARG(int, static_cast<int>(reason)), Q_ARG(int, runId));
+    });
 
-    if (!isDynamic) {
-        // FIXED POSITION LOGIC: Move cursor
+    MacroPlayer::Settings settings;
+    settings.speed = m_playbackSpeed;
+    settings.loops = m_playbackLoops;
 
-        // Validation using Virtual Screen metrics (Multi-monitor fix)
-        int vScreenX = GetSystemMetrics(SM_XVIRTUALSCREEN);
-        int vScreenY = GetSystemMetrics(SM_YVIRTUALSCREEN);
-        int vScreenWidth = GetSystemMetrics(SM_CXVIRTUALSCREEN);
-        int vScreenHeight = GetSystemMetrics(SM_CYVIRTUALSCREEN);
+    m_isPlaying = true;
+    if (!m_player.start(settings)) {
+        m_isPlaying = false;
+        emit error("Failed to start macro playback");
+        return false;
+    }
+    qDebug() << "Macro playback started:" << macro->size() << "events at" << m_playbackSpeed << "x,"
+             << (m_playbackLoops > 0 ? QString::number(m_playbackLoops) : QString("endless")) << "loop(s)";
+    emit playbackStarted();
+    return true;
+}
 
-        if (x < vScreenX || y < vScreenY ||
-            x >= (vScreenX + vScreenWidth) || y >= (vScreenY + vScreenHeight)) {
-            qWarning() << "Click coordinates out of virtual screen bounds:" << x << "," << y;
-            return false;
-        }
+void AutoClicker::stopPlayback() {
+    if (!m_isPlaying) {
+        return;
+    }
+    m_player.stop();
+    m_isPlaying = false;
+    qDebug() << "Macro playback stopped after" << m_player.eventsPlayed() << "events," << m_player.loopsCompleted()
+             << "loop(s) in" << m_player.batchesSubmitted() << "batches, worst lateness"
+             << std::chrono::duration_cast<std::chrono::microseconds>(m_player.maxLateness()).count() << "us";
+    emit playbackStopped();
+}
 
-        // Save original cursor position
-        if (!GetCursorPos(&originalPos)) {
-            DWORD error = GetLastError();
-            qWarning() << "Failed to get cursor position. Error:" << error;
-            return false;
-        }
+bool AutoClicker::pause() {
+    if (!m_isRunning || m_jobMode || m_engine.isPaused()) {
+        return false;
+    }
+    if (!m_engine.pause()) {
+        return false;
+    }
+    qDebug() << "AutoClicker paused after" << m_engine.clicksPerformed() << "click(s)";
+    emit paused();
+    return true;
+}
 
-        // Move cursor to target position
-        if (!SetCursorPos(x, y)) {
-            DWORD error = GetLastError();
-            qWarning() << "Failed to set cursor position. Error:" << error;
-            return false;
-        }
+bool AutoClicker::resume() {
+    if (!m_isRunning || m_jobMode || !m_engine.resume()) {
+        return false;
+    }
+    qDebug() << "AutoClicker resumed";
+    emit resumed();
+    return true;
+}
+
+bool AutoClicker::togglePause() {
+    return isPaused() ? resume() : pause();
+}
 
-        // Reduced delay after moving the cursor (LAG FIX)
-        Sleep(1);
+void AutoClicker::setInputBackend(std::unique_ptr<InputBackend> backend) {
+    if (m_isRunning || m_isPlaying) {
+        qWarning() << "Cannot replace input backend while running";
+        return;
     }
+    m_backend = std::move(backend);
+    if (m_backend) {
+        m_backend->setDisplayCache(m_display);
+    }
+    m_scheduler.setBackend(m_backend.get(), m_display);
+}
 
-    // Use modern SendInput instead of deprecated mouse_event
-    INPUT inputs[4] = {}; // Max 4 for double-click
-    int inputCount = 0;
+void AutoClicker::setClock(EngineClock* clock) {
+    if (m_isRunning || m_isPlaying) {
+        qWarning() << "Cannot replace engine clock while running";
+        return;
+    }
+    m_engine.setClock(clock);
+    m_scheduler.setClock(clock);
+    m_player.setClock(clock);
+}
 
-    // Prepare mouse input events
-    DWORD downFlag = rightClick ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_LEFTDOWN;
-    DWORD upFlag = rightClick ? MOUSEEVENTF_RIGHTUP : MOUSEEVENTF_LEFTUP;
+bool AutoClicker::isActive() const {
+    return m_isRunning && (m_jobMode ? m_scheduler.isRunning() : m_engine.isRunning());
+}
 
-    // First click down
-    inputs[inputCount].type = INPUT_MOUSE;
-    inputs[inputCount].mi.dwFlags = downFlag;
-    inputCount++;
+int AutoClicker::remainingClicks() const {
+    // Jobs have separate limits; the single-job count does not apply
+    if (m_jobMode) {
+        return -1;
+    }
+    return m_isRunning ? static_cast<int>(m_engine.remainingClicks()) : m_remainingClicks;
+}
 
-    // First click up
-    inputs[inputCount].type = INPUT_MOUSE;
-    inputs[inputCount].mi.dwFlags = upFlag;
-    inputCount++;
+qint64 AutoClicker::clicksPerformed() const {
+    return m_jobMode ? m_scheduler.clicksPerformed() : m_engine.clicksPerformed();
+}
 
-    // Double click if requested
-    if (doubleClick) {
-        // Second click down
-        inputs[inputCount].type = INPUT_MOUSE;
-        inputs[inputCount].mi.dwFlags = downFlag;
-        inputCount++;
+ClickEngine::Stats AutoClicker::runStats() const {
+    return m_jobMode ? m_scheduler.stats() : m_engine.stats();
+}
 
-        // Second click up
-        inputs[inputCount].type = INPUT_MOUSE;
-        inputs[inputCount].mi.dwFlags = upFlag;
-        inputCount++;
+AutoClicker::Progress AutoClicker::sampleProgress() {
+    if (m_jobMode) {
+        // No per-click telemetry from the scheduler; the rate is the run average
+        const ClickEngine::Stats stats = m_scheduler.stats();
+        Progress progress;
+        progress.clicks = stats.clicks;
+        progress.clicksPerSecond = stats.clicksPerSecond();
+        progress.missedDeadlines = stats.missedDeadlines;
+        return progress;
     }
 
-    // Send all input events
-    // If isDynamic is true, this click happens at the current cursor position,
-    // and no movement/restore is needed, fixing the lag.
-    UINT result = SendInput(inputCount, inputs, sizeof(INPUT));
-    if (result != inputCount) {
-        DWORD error = GetLastError();
-        qWarning() << "SendInput failed. Expected:" << inputCount << "Sent:" << result << "Error:" << error;
+    m_engine.telemetry().drain([this](const ClickEngine::ClickSample& sample) {
+        m_liveRate.add(sample);
+    });
 
-        // Restore cursor position ONLY if we moved it
-        if (!isDynamic) {
-            SetCursorPos(originalPos.x, originalPos.y);
-        }
+    // Samples are in run time, so the window ends at the elapsed run time,
+    // which stands still while paused
+    const ClickEngine::Stats stats = m_engine.stats();
+    Progress progress;
+    progress.clicks = stats.clicks;
+    progress.remainingClicks = remainingClicks();
+    progress.missedDeadlines = stats.missedDeadlines;
+    progress.rateFactor = stats.rateFactor;
+    progress.clicksPerSecond = m_liveRate.update(stats.elapsed);
+
+    if (m_duration > 0) {
+        const qint64 elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(stats.elapsed).count();
+        progress.remainingMs = qMax<qint64>(0, m_duration - elapsedMs);
+    }
+    return progress;
+}
+
+void AutoClicker::markTrigger() {
+    m_trigger = m_engine.now();
+    m_hasTrigger = true;
+}
+
+ClickEngine::Clock::time_point AutoClicker::takeTrigger() {
+    // Button clicks and other callers without a hotkey start measuring now
+    const ClickEngine::Clock::time_point trigger = m_hasTrigger ? m_trigger : m_engine.now();
+    m_hasTrigger = false;
+    return trigger;
+}
+
+bool AutoClicker::dumpLatency(const QString& path) const {
+    const std::pair<const char*, const LatencyHistogram*> stages[] = {
+        {"wake_lateness", &m_latency.wakeLateness},
+        {"injection", &m_latency.injection},
+        {"start_to_first_click", &m_latency.startToFirst},
+        {"stop_to_last_click", &m_latency.stopToLast},
+    };
+
+    bool any = false;
+    for (const auto& stage : stages) {
+        any = any || stage.second->count() > 0;
+    }
+    if (!any) {
         return false;
     }
 
-    // Restore cursor ONLY if we moved it (Fixed position)
-    if (!isDynamic) {
-        // Reduced delay before restoring cursor (LAG FIX)
-        Sleep(1);
-        // Restore original cursor position
-        if (!SetCursorPos(originalPos.x, originalPos.y)) {
-            qWarning() << "Failed to restore cursor position";
-        }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        qWarning() << "Cannot write latency histograms to" << path << ":" << file.errorString();
+        return false;
     }
 
-    qDebug() << "Click performed successfully at" << (isDynamic ? "live cursor" : QString::number(x) + "," + QString::number(y))
-             << (rightClick ? "(right)" : "(left)")
-             << (doubleClick ? "(double)" : "(single)");
+    QTextStream out(&file);
+    out << "# Flame Autoclicker latency histograms, buckets as: lower_ns upper_ns count\n";
+    for (const auto& stage : stages) {
+        out << "\n[" << stage.first << "] " << QString::fromStdString(stage.second->summary()) << "\n";
+        out << QString::fromStdString(stage.second->buckets());
+    }
 
+    qDebug() << "Latency histograms written to" << path;
     return true;
 }
+
+void AutoClicker::setDuration(qint64 ms) {
+    m_duration = ms;
+    if (ms > 0) {
+        qDebug() << "Duration set to:" << ms << "ms";
+    } else {
+        qDebug() << "No duration limit set";
+    }
+}
+
+void AutoClicker::onEngineFinished(int reason, int runId) {
+    // stop() (and maybe a new start()) may have run since the engine finished
+    if (!m_isRunning || runId != m_runId) {
+        return;
+    }
+
+    const auto stopReason = static_cast<ClickEngine::StopReason>(reason);
+
+    stop();
+    if (stopReason == ClickEngine::StopReason::Error) {
+        qWarning() << "Click injection failed:" << QString::fromStdString(m_backend->lastError());
+        emit error("Click operation failed");
+    } else {
+        emit finished();
+    }
+}
+
+void AutoClicker::onPlaybackFinished(int reason, int runId) {
+    if (!m_isPlaying || runId != m_runId) {
+        return;
+    }
+
+    stopPlayback();
+    if (static_cast<ClickEngine::StopReason>(reason) == ClickEngine::StopReason::Error) {
+        if (m_player.readFailed()) {
+            qWarning() << "Macro playback failed:" << QString::fromStdString(m_macroFile.lastError());
+            emit error("Macro file is damaged, playback stopped");
+        } else {
+            qWarning() << "Macro playback failed:" << QString::fromStdString(m_backend->lastError());
+            emit error("Macro playback failed");
+        }
+    } else {
+        emit playbackFinished();
+    }
+}
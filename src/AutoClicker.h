@@ -2,23 +2,72 @@
 #define AUTOCLICKER_H
 
 #include <QObject>
-#include <QTimer>
-#include <QElapsedTimer>
 #include <QPoint>
+#include <memory>
+
+#include "ClickEngine.h"
+#include "ClickJobScheduler.h"
+#include "ClickProgram.h"
+#include "DisplayCache.h"
+#include "InputBackend.h"
+#include "LatencyHistogram.h"
+#include "LiveClickRate.h"
+#include "MacroBuffer.h"
+#include "MacroPlayer.h"
+#include "MacroRecorder.h"
+#include "MappedMacroFile.h"
+#include "TimelineImporter.h"
+#include "TraceWriter.h"
 
 class AutoClicker : public QObject {
     Q_OBJECT
 
 public:
+    // Live progress of the current (or last) run
+    struct Progress {
+        qint64 clicks = 0;
+        qint64 remainingClicks = -1;  // -1 for infinite
+        qint64 remainingMs = -1;      // -1 without a duration limit
+        double clicksPerSecond = 0.0; // over the last second
+        qint64 missedDeadlines = 0;   // see ClickEngine::MissPolicy
+        double rateFactor = 1.0;      // adaptive rate: share of the requested rate in force
+    };
+
+    // Per-stage timings, accumulated over every run of the session
+    struct Latency {
+        LatencyHistogram wakeLateness; // engine wake-up past each click deadline
+        LatencyHistogram injection;    // backend submit for each click
+        LatencyHistogram startToFirst; // start hotkey/button to the first click
+        LatencyHistogram stopToLast;   // stop hotkey/button until the last click is done
+    };
+
     explicit AutoClicker(QObject* parent = nullptr);
     ~AutoClicker();
 
     // Configuration methods
     void setInterval(qint64 ms);
+    // High-rate mode only: sub-millisecond intervals in microseconds
+    void setIntervalMicroseconds(qint64 us);
+    void setHighRateMode(bool enabled);
+    // High-rate intervals below 1 ms are sent as bursts of clicks, one injection
+    // per 1 ms wake-up, so the rate is bounded by the OS input queue rather than
+    // by wake-ups; lowers the interval floor to 1us. Set before the interval.
+    void setBurstMode(bool enabled);
     void setClickCount(int count);
     void setPosition(const QPoint& pos);
     void setDoubleClick(bool enabled);
     void setRightClick(bool enabled);
+    // Fixed position only: move, click and move back in one injection, no sleeps
+    void setInstantMove(bool enabled);
+    // Presses a key (a Linux key code, see InputCodes.h) with the KeyModifier
+    // bits held around it instead of clicking, on the same schedule, limits and
+    // bursts; 0 goes back to mouse clicks. Position and button do not apply.
+    void setKeyPress(uint16_t key, uint8_t modifiers = 0);
+    // How deadlines missed during a stall are handled; CatchUp keeps the click count on time
+    void setMissPolicy(ClickEngine::MissPolicy policy) { m_missPolicy = policy; }
+    // On by default: when the OS input queue or the target cannot keep up, the
+    // rate backs off and recovers instead of the run stopping with an error
+    void setAdaptiveRate(bool enabled);
 
     // Public setter for dynamic position control
     void setUseDynamicPosition(bool enabled) { m_useDynamicPosition = enabled; }
@@ -28,40 +77,177 @@ public:
     bool start();
     void stop();
     bool isActive() const;
+    // Holds the running schedule without ending the run; resume() carries on with
+    // the same phase, the remaining clicks and the remaining duration
+    bool pause();
+    bool resume();
+    bool togglePause();
+    bool isPaused() const { return m_isRunning && !m_jobMode && m_engine.isPaused(); }
+
+    // Queues the current settings as an independent click job, only while
+    // stopped. With jobs queued, start() runs all of them together on one
+    // scheduler thread instead of the single engine; pause() and reconfigure()
+    // do not apply to them. Returns the job id, -1 if the settings are invalid.
+    int addJob();
+    void clearJobs();
+    int jobCount() const { return m_scheduler.jobCount(); }
+    bool isJobMode() const { return m_jobMode; }
+    // Applies the current settings to the running engine without a restart;
+    // the click phase carries over and the click limit stays a total for the run
+    bool reconfigure();
+
+    // Captures global mouse and keyboard input into macro() until
+    // stopRecording(); only while not clicking. dropTrailingClick removes the
+    // last click, for a recording stopped by clicking a button.
+    bool startRecording();
+    void stopRecording(bool dropTrailingClick = false);
+    // False where this platform has no macro recorder
+    bool canRecord() const { return m_recorder != nullptr; }
+    bool isRecording() const { return m_recorder && m_recorder->isRecording(); }
+    // Events captured so far; safe to poll while recording
+    qint64 recordedEvents() const { return static_cast<qint64>(m_macro.size()); }
+    // The macro startPlayback() plays: the last recording, or the file opened
+    // by loadMacro() until the next recording. Only read it while not recording.
+    const MacroTimeline& macro() const;
+    bool isMacroFromFile() const { return m_macroFile.isOpen(); }
+    QString macroFilePath() const { return QString::fromStdString(m_macroFile.path()); }
+    // Writes the last recording as a compact binary macro file
+    bool saveMacro(const QString& path);
+    // Maps a saved macro for playback; it is decoded as it plays, so even a
+    // huge file opens at once. Not while recording or playing.
+    bool loadMacro(const QString& path);
+    // Converts a CSV or NDJSON click schedule into the macro file target and
+    // opens it for playback; clicks off every monitor are left out
+    bool importTimeline(const QString& source, const QString& target);
+    const TimelineImportResult& lastImport() const { return m_lastImport; }
+
+    // Plays macro() back through the input backend on an engine thread; not
+    // while clicking or recording. Speed is clamped to 0.25x .. 10x, loops
+    // <= 0 repeat until stopPlayback(). Held keys are released on any stop.
+    void setPlaybackSpeed(double speed);
+    void setPlaybackLoops(int loops) { m_playbackLoops = loops; }
+    bool startPlayback();
+    void stopPlayback();
+    bool isPlaying() const { return m_isPlaying; }
+    double playbackSpeed() const { return m_playbackSpeed; }
+    int playbackLoops() const { return m_playbackLoops; }
+    // Live, safe to poll while playing
+    qint64 eventsPlayed() const { return m_player.eventsPlayed(); }
+    qint64 loopsPlayed() const { return m_player.loopsCompleted(); }
+
+    // Replaces the platform backend (e.g. with a test double); only while stopped
+    void setInputBackend(std::unique_ptr<InputBackend> backend);
+    InputBackend* inputBackend() const { return m_backend.get(); }
+    // Substitutes the engine's time source (e.g. a VirtualClock); nullptr restores real time
+    void setClock(EngineClock* clock);
 
     // Getters
     QPoint position() const { return m_position; }
-    int interval() const { return m_timer.interval(); }
-    int remainingClicks() const { return m_remainingClicks; }
+    int interval() const { return static_cast<int>(m_intervalUs / 1000); }
+    qint64 intervalMicroseconds() const { return m_intervalUs; }
+    bool isHighRateMode() const { return m_highRate; }
+    bool isBurstMode() const { return m_burst; }
+    // Clicks per injection the current settings run with; 1 without bursts
+    int burstSize() const { return engineSettings().burst; }
+    int remainingClicks() const;
+    // Live click count of the current (or last) run; cheap enough to poll from a timer
+    qint64 clicksPerformed() const;
     bool isDoubleClick() const { return m_doubleClick; }
     bool isRightClick() const { return m_rightClick; }
+    bool isInstantMove() const { return m_instantMove; }
+    bool isKeyPressMode() const { return m_pressKey != 0; }
+    ClickEngine::MissPolicy missPolicy() const { return m_missPolicy; }
+    bool isAdaptiveRate() const { return m_adaptive; }
 
     void setDuration(qint64 ms);
 
+    // Measured over the current (or last) run
+    double achievedRate() const { return runStats().clicksPerSecond(); }
+    double spinCpuUsage() const { return runStats().spinCpuFraction(); }
+
+    // GUI thread only. Drains the engine's telemetry ring; never waits on the engine thread.
+    Progress sampleProgress();
+
+    // Safe to read while running; engine-side histograms are updated live
+    const Latency& latency() const { return m_latency; }
+    // Notes when a hotkey arrived; the next start() or stop() measures from there
+    void markTrigger();
+    // Writes a summary and the raw buckets of every histogram; false if nothing was recorded
+    bool dumpLatency(const QString& path) const;
+
 signals:
     void started();
     void stopped();
+    void paused();
+    void resumed();
     void finished();
-    void clickPerformed(const QPoint& position);
+    void recordingStarted();
+    void recordingStopped();
+    void playbackStarted();
+    void playbackStopped();  // by stopPlayback(), including after it finished on its own
+    void playbackFinished(); // every loop was played
     void error(const QString& message);
 
 private slots:
-    void performClick();
+    // Runs on the GUI thread once the engine thread has ended on its own
+    void onEngineFinished(int reason, int runId);
+    void onPlaybackFinished(int reason, int runId);
 
 private:
-    // Windows-specific clicking method
-    bool performWindowsClick(int x, int y, bool rightClick, bool doubleClick);
+    ClickEngine::Clock::time_point takeTrigger();
+    bool startJobs(ClickEngine::Clock::time_point trigger);
+    ClickEngine::Stats runStats() const;
+    // Interval floor and position checks shared by start() and reconfigure();
+    // returns the user-facing problem, empty if the settings are usable
+    QString validateSettings();
+    ClickConfig clickConfig() const;
+    ClickEngine::Settings engineSettings() const;
+
+    static constexpr size_t MacroReserveEvents = size_t(1) << 18;
 
-    QTimer m_timer;
+    std::unique_ptr<InputBackend> m_backend;
+    const DisplayCache* m_display = nullptr; // owned by DisplayTopology
+    ClickEngine m_engine;
+    ClickJobScheduler m_scheduler;
+    bool m_jobMode = false; // the current (or last) run is the job scheduler's
+    qint64 m_intervalUs = 1000000;
+    bool m_highRate = false;
+    bool m_burst = false;
     QPoint m_position;
     int m_remainingClicks = -1;
     bool m_doubleClick = false;
     bool m_rightClick = false;
+    bool m_instantMove = false;
+    uint16_t m_pressKey = 0;
+    uint8_t m_pressModifiers = 0;
+    ClickEngine::MissPolicy m_missPolicy = ClickEngine::MissPolicy::CatchUp;
+    bool m_adaptive = true;
     bool m_isRunning = false;
+    int m_runId = 0;
     bool m_useDynamicPosition = true;
 
     qint64 m_duration = -1;
-    QElapsedTimer m_runtime;
+
+    Latency m_latency;
+    // Binary click trace, enabled by FLAME_TRACE=<path>; opened on the first start()
+    TraceWriter m_trace;
+    QString m_tracePath;
+    ClickEngine::Clock::time_point m_trigger;
+    ClickEngine::Clock::time_point m_startTrigger;
+    bool m_hasTrigger = false;
+
+    // Macro capture; the buffer's chunks are kept between recordings
+    std::unique_ptr<MacroRecorder> m_recorder;
+    MacroBuffer m_macro;
+    MappedMacroFile m_macroFile;
+    TimelineImportResult m_lastImport;
+    MacroPlayer m_player;
+    bool m_isPlaying = false;
+    double m_playbackSpeed = 1.0;
+    int m_playbackLoops = 1;
+
+    // Injections from the last second, for the live CPS figure
+    LiveClickRate m_liveRate;
 };
 
 #endif // AUTOCLICKER_H
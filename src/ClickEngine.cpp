@@ -0,0 +1,449 @@
+#include "ClickEngine.h"
+#include "PreciseWaiter.h"
+#include "RateController.h"
+#include "RingLogger.h"
+
+#include <algorithm>
+
+ClickEngine::~ClickEngine() {
+    stop();
+}
+
+ClickEngine::Settings ClickEngine::planBurst(Settings settings, std::chrono::nanoseconds minWakePeriod, int maxBurst) {
+    const int64_t perClick = settings.interval.count();
+    if (perClick <= 0 || perClick >= minWakePeriod.count()) {
+        settings.burst = 1;
+        return settings;
+    }
+    // Rounded up, so wake-ups are never closer than minWakePeriod
+    const int64_t clicks = (minWakePeriod.count() + perClick - 1) / perClick;
+    settings.burst = static_cast<int>(std::clamp<int64_t>(clicks, 1, std::max(1, maxBurst)));
+    settings.interval = settings.interval * settings.burst;
+    return settings;
+}
+
+bool ClickEngine::start(const Settings& settings) {
+    if (isRunning() || !m_click || settings.interval.count() <= 0 || settings.burst < 1) {
+        return false;
+    }
+
+    // A previous run that finished on its own still has to be joined
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    m_stopRequested.store(false, std::memory_order_relaxed);
+    m_pauseRequested.store(false, std::memory_order_relaxed);
+    m_pausedTicks.store(0, std::memory_order_relaxed);
+    m_pauseBeginTicks.store(0, std::memory_order_relaxed);
+    m_clicksPerformed.store(0, std::memory_order_relaxed);
+    m_remainingClicks.store(settings.clickLimit, std::memory_order_relaxed);
+    m_spinTimeNs.store(0, std::memory_order_relaxed);
+    m_missedDeadlines.store(0, std::memory_order_relaxed);
+    m_backoffs.store(0, std::memory_order_relaxed);
+    m_rateFactorPermille.store(1000, std::memory_order_relaxed);
+    m_startTicks.store(m_clock->now().time_since_epoch().count(), std::memory_order_relaxed);
+    m_endTicks.store(0, std::memory_order_relaxed);
+    m_firstClickTicks.store(0, std::memory_order_relaxed);
+    m_telemetry.reset();
+
+    // No engine thread exists here, so every old snapshot can go
+    m_snapshots.clear();
+    m_snapshots.push_back(std::make_unique<Snapshot>(Snapshot{settings, m_click}));
+    m_config.store(m_snapshots.back().get(), std::memory_order_relaxed);
+    m_configInUse.store(nullptr, std::memory_order_relaxed);
+    m_running.store(true, std::memory_order_release);
+
+    m_thread = std::thread(&ClickEngine::run, this);
+    return true;
+}
+
+bool ClickEngine::reconfigure(const Settings& settings, ClickFunction click) {
+    if (!isRunning() || !click || settings.interval.count() <= 0 || settings.burst < 1) {
+        return false;
+    }
+
+    m_snapshots.push_back(std::make_unique<Snapshot>(Snapshot{settings, std::move(click)}));
+    m_config.store(m_snapshots.back().get(), std::memory_order_seq_cst);
+    reclaimSnapshots();
+
+    // Wake a sleeping engine so e.g. a shorter interval applies right away.
+    // Taking the mutex orders the store before the waiter's predicate check.
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+    }
+    m_waitCondition.notify_all();
+    return true;
+}
+
+const ClickEngine::Snapshot* ClickEngine::acquireConfig() {
+    const Snapshot* held = m_configInUse.load(std::memory_order_relaxed);
+    const Snapshot* config = m_config.load(std::memory_order_acquire);
+    if (config == held) {
+        return config;
+    }
+
+    // Announce the new snapshot, then check it is still the published one;
+    // otherwise the owner may have retired it before seeing the announcement
+    for (;;) {
+        m_configInUse.store(config, std::memory_order_seq_cst);
+        const Snapshot* again = m_config.load(std::memory_order_seq_cst);
+        if (again == config) {
+            return config;
+        }
+        config = again;
+    }
+}
+
+void ClickEngine::reclaimSnapshots() {
+    const Snapshot* current = m_snapshots.back().get();
+    const Snapshot* inUse = m_configInUse.load(std::memory_order_seq_cst);
+    m_snapshots.erase(std::remove_if(m_snapshots.begin(), m_snapshots.end(),
+                                     [current, inUse](const std::unique_ptr<Snapshot>& snapshot) {
+                                         return snapshot.get() != current && snapshot.get() != inUse;
+                                     }),
+                      m_snapshots.end());
+}
+
+void ClickEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_stopRequested.store(true, std::memory_order_release);
+    }
+    m_waitCondition.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_running.store(false, std::memory_order_release);
+    m_configInUse.store(nullptr, std::memory_order_relaxed);
+    if (!m_snapshots.empty()) {
+        reclaimSnapshots();
+    }
+}
+
+bool ClickEngine::pause() {
+    if (!isRunning()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_pauseRequested.store(true, std::memory_order_release);
+    }
+    m_waitCondition.notify_all();
+    return true;
+}
+
+bool ClickEngine::resume() {
+    if (!isRunning() || !isPaused()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_pauseRequested.store(false, std::memory_order_release);
+    }
+    m_waitCondition.notify_all();
+    return true;
+}
+
+bool ClickEngine::waitForResume() {
+    std::unique_lock<std::mutex> lock(m_waitMutex);
+    m_waitCondition.wait(lock, [this]() {
+        return m_stopRequested.load(std::memory_order_acquire)
+            || !m_pauseRequested.load(std::memory_order_acquire);
+    });
+    return !m_stopRequested.load(std::memory_order_acquire);
+}
+
+ClickEngine::Stats ClickEngine::stats() const {
+    Stats stats;
+    stats.clicks = m_clicksPerformed.load(std::memory_order_relaxed);
+    stats.spinTime = std::chrono::nanoseconds(m_spinTimeNs.load(std::memory_order_relaxed));
+    stats.missedDeadlines = m_missedDeadlines.load(std::memory_order_relaxed);
+    stats.backoffs = m_backoffs.load(std::memory_order_relaxed);
+    stats.rateFactor = m_rateFactorPermille.load(std::memory_order_relaxed) / 1000.0;
+
+    const Clock::rep start = m_startTicks.load(std::memory_order_relaxed);
+    Clock::rep end = m_endTicks.load(std::memory_order_relaxed);
+    if (end == 0) {
+        // The clock stands still while the engine is paused
+        const Clock::rep pausedSince = m_pauseBeginTicks.load(std::memory_order_relaxed);
+        end = pausedSince != 0 ? pausedSince : m_clock->now().time_since_epoch().count();
+    }
+    stats.elapsed = Clock::duration(end - start - m_pausedTicks.load(std::memory_order_relaxed));
+    return stats;
+}
+
+std::optional<ClickEngine::Clock::time_point> ClickEngine::firstClickTime() const {
+    const Clock::rep ticks = m_firstClickTicks.load(std::memory_order_relaxed);
+    if (ticks == 0) {
+        return std::nullopt;
+    }
+    return Clock::time_point(Clock::duration(ticks));
+}
+
+std::optional<ClickEngine::Clock::time_point> ClickEngine::endTime() const {
+    const Clock::rep ticks = m_endTicks.load(std::memory_order_relaxed);
+    if (ticks == 0) {
+        return std::nullopt;
+    }
+    return Clock::time_point(Clock::duration(ticks));
+}
+
+ClickEngine::WaitResult ClickEngine::waitUntil(Clock::time_point deadline, bool highRate, const Snapshot* config) {
+    const auto interrupted = [this, config]() {
+        return m_stopRequested.load(std::memory_order_acquire)
+            || m_pauseRequested.load(std::memory_order_acquire)
+            || m_config.load(std::memory_order_acquire) != config;
+    };
+    const auto spun = PreciseWaiter::waitUntil(*m_clock, deadline, highRate, m_waitMutex, m_waitCondition,
+                                               m_stopRequested, interrupted);
+    m_spinTimeNs.fetch_add(spun.count(), std::memory_order_relaxed);
+
+    if (m_stopRequested.load(std::memory_order_acquire)) {
+        return WaitResult::Stopped;
+    }
+    if (m_pauseRequested.load(std::memory_order_acquire)) {
+        return WaitResult::Paused;
+    }
+    // A due click goes out first, so a stream of reconfigurations cannot starve it
+    if (m_clock->now() >= deadline) {
+        return WaitResult::Reached;
+    }
+    return m_config.load(std::memory_order_acquire) != config ? WaitResult::Reconfigured : WaitResult::Reached;
+}
+
+void ClickEngine::run() {
+    const EngineThreadTiming timing;
+
+    const Clock::time_point runStart = startTime();
+    // Time spent paused does not count against the duration budget
+    Clock::duration pausedTotal{0};
+    auto endTimeFor = [runStart, &pausedTotal](const Settings& settings) {
+        return settings.duration.count() > 0 ? runStart + pausedTotal + settings.duration : Clock::time_point::max();
+    };
+
+    // Once the engine moves on to a newer snapshot the old one may be freed,
+    // so the settings in force are kept as a local copy
+    const Snapshot* config = acquireConfig();
+    Settings settings = config->settings;
+    Clock::time_point endTime = endTimeFor(settings);
+
+    // Deadlines are anchor + n * period. The anchor only moves when the period
+    // changes, to the last deadline, so the phase carries over. The period is
+    // the configured interval unless the rate controller stretched it.
+    Clock::time_point anchor = runStart;
+    int64_t step = 0;
+    RateController controller;
+    controller.reset(settings.interval, settings.burst);
+    Clock::duration period = settings.interval;
+
+    StopReason reason = StopReason::Requested;
+    int64_t tick = 0;
+    TraceWriter* const trace = m_probes.trace;
+
+    if (trace) {
+        trace->append(TraceRecord::RunStart, runStart.time_since_epoch().count(),
+                      settings.interval.count(), settings.clickLimit);
+    }
+
+    for (;;) {
+        if (m_pauseRequested.load(std::memory_order_acquire)) {
+            const Clock::time_point pausedAt = m_clock->now();
+            m_pauseBeginTicks.store(pausedAt.time_since_epoch().count(), std::memory_order_relaxed);
+            FLAME_LOG(Debug, "Click engine paused after %lld click(s)",
+                      m_clicksPerformed.load(std::memory_order_relaxed));
+            const bool resumed = waitForResume();
+
+            // Shift the whole schedule: the next click is as far away as it was
+            const Clock::time_point resumedAt = m_clock->now();
+            const Clock::duration pausedFor = resumedAt - pausedAt;
+            anchor += pausedFor;
+            pausedTotal += pausedFor;
+            endTime = endTimeFor(settings);
+            m_pausedTicks.fetch_add(pausedFor.count(), std::memory_order_relaxed);
+            m_pauseBeginTicks.store(0, std::memory_order_relaxed);
+            if (trace) {
+                trace->append(TraceRecord::Pause, pausedAt.time_since_epoch().count(),
+                              resumedAt.time_since_epoch().count(), tick);
+            }
+            if (!resumed) {
+                break;
+            }
+            continue;
+        }
+
+        const Snapshot* latest = acquireConfig();
+        if (latest != config) {
+            // Never schedule in the past: a much shorter interval must not burst
+            const Clock::time_point lastDeadline = anchor + step * period;
+            anchor = std::max(lastDeadline, m_clock->now() - latest->settings.interval);
+            step = 0;
+
+            if (latest->settings.clickLimit != settings.clickLimit) {
+                const int64_t limit = latest->settings.clickLimit;
+                const int64_t performed = m_clicksPerformed.load(std::memory_order_relaxed);
+                m_remainingClicks.store(limit < 0 ? -1 : std::max<int64_t>(0, limit - performed),
+                                        std::memory_order_relaxed);
+            }
+            config = latest;
+            settings = config->settings;
+            endTime = endTimeFor(settings);
+            // A new configuration starts out at its requested rate
+            controller.reset(settings.interval, settings.burst);
+            period = settings.interval;
+            m_rateFactorPermille.store(1000, std::memory_order_relaxed);
+            FLAME_LOG(Debug, "Click engine reconfigured: interval %lld ns, limit %lld",
+                      static_cast<long long>(settings.interval.count()), settings.clickLimit);
+        }
+
+        if (m_remainingClicks.load(std::memory_order_relaxed) == 0) {
+            reason = StopReason::ClickLimit;
+            break;
+        }
+
+        // First click happens one interval after start, like the old QTimer did
+        const Clock::time_point deadline = anchor + (step + 1) * period;
+
+        // A click due exactly at the end of the budget still happens
+        if (deadline > endTime) {
+            const WaitResult result = waitUntil(endTime, settings.highRate, config);
+            if (result == WaitResult::Reconfigured || result == WaitResult::Paused) {
+                continue;
+            }
+            if (result == WaitResult::Reached) {
+                reason = StopReason::Duration;
+            }
+            break;
+        }
+
+        const WaitResult result = waitUntil(deadline, settings.highRate, config);
+        if (result == WaitResult::Stopped) {
+            break;
+        }
+        // The spin phase only watches for stop(), so a pause may still be pending
+        if (result == WaitResult::Reconfigured || result == WaitResult::Paused
+            || m_pauseRequested.load(std::memory_order_acquire)) {
+            continue;
+        }
+        ++step;
+        ++tick;
+
+        const Clock::time_point woke = m_clock->now();
+        if (m_probes.wakeLateness) {
+            m_probes.wakeLateness->record(woke - deadline);
+        }
+        if (trace) {
+            trace->append(TraceRecord::Wake, woke.time_since_epoch().count(),
+                          deadline.time_since_epoch().count(), tick);
+        }
+
+        // This click still goes out late; the policy decides what happens to the
+        // deadlines that passed meanwhile
+        const int64_t overdue = overdueDeadlines(deadline, woke, period);
+        if (overdue > 0) {
+            switch (settings.missPolicy) {
+            case MissPolicy::CatchUp:
+                // The following deadlines are clicked straight away, each one
+                // counted when its own turn comes
+                m_missedDeadlines.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case MissPolicy::Skip:
+                step += overdue;
+                m_missedDeadlines.fetch_add(overdue, std::memory_order_relaxed);
+                break;
+            case MissPolicy::Shift:
+                anchor = woke;
+                step = 0;
+                m_missedDeadlines.fetch_add(overdue, std::memory_order_relaxed);
+                break;
+            }
+            if (trace) {
+                trace->append(TraceRecord::Missed, woke.time_since_epoch().count(), overdue, tick);
+            }
+            FLAME_LOG(Debug, "Click %lld woke %lld deadline(s) late (policy %lld)", tick, overdue,
+                      static_cast<int>(settings.missPolicy));
+        }
+
+        // Last cancellation point: once stop() is requested nothing more is injected.
+        // A started click still completes, so stop() waits for at most one click.
+        if (m_stopRequested.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        // A limited run ends with a shorter burst, never with extra clicks
+        const int64_t remaining = m_remainingClicks.load(std::memory_order_relaxed);
+        const int maxBurst = settings.adaptive ? controller.burst() : settings.burst;
+        const int burst = remaining > 0 ? static_cast<int>(std::min<int64_t>(maxBurst, remaining)) : maxBurst;
+        std::chrono::nanoseconds settled{0};
+        const int accepted = config->click(burst, settled);
+        const Clock::time_point clicked = m_clock->now();
+
+        bool failed = accepted < 0 || (accepted < burst && !settings.adaptive);
+        if (!failed && settings.adaptive) {
+            const RateController::Verdict verdict = controller.record(burst, accepted, clicked - woke, settled);
+            if (verdict == RateController::Verdict::GiveUp) {
+                failed = true;
+            } else if (verdict == RateController::Verdict::Changed) {
+                // Rebase from the deadline just served; the next click comes a full
+                // new period after this one at the earliest, giving the queue time to drain
+                anchor = std::max(anchor + step * period, clicked);
+                step = 0;
+                period = controller.period();
+                m_rateFactorPermille.store(static_cast<int64_t>(controller.rateFactor() * 1000.0), std::memory_order_relaxed);
+                m_backoffs.store(controller.backoffs(), std::memory_order_relaxed);
+                if (trace) {
+                    trace->append(TraceRecord::Rate, clicked.time_since_epoch().count(), period.count(), controller.burst());
+                }
+                FLAME_LOG(Debug, "Click rate adapted: %lld click(s) every %lld ns (%lld%% of target), %lld accepted",
+                          controller.burst(), static_cast<long long>(period.count()),
+                          static_cast<long long>(controller.rateFactor() * 100.0), accepted);
+            }
+        }
+        if (failed) {
+            if (trace) {
+                trace->append(TraceRecord::Error, clicked.time_since_epoch().count(), 0, tick);
+            }
+            FLAME_LOG(Warning, "Click injection failed after %lld click(s)",
+                      m_clicksPerformed.load(std::memory_order_relaxed));
+            reason = StopReason::Error;
+            break;
+        }
+
+        if (m_probes.injection) {
+            m_probes.injection->record(clicked - woke);
+        }
+        if (trace) {
+            trace->append(TraceRecord::Inject, woke.time_since_epoch().count(),
+                          clicked.time_since_epoch().count(), tick);
+        }
+
+        // Only clicks the OS took count, so a click limit is still met in full
+        if (accepted == 0) {
+            continue;
+        }
+        m_telemetry.push(ClickSample{(clicked - runStart - pausedTotal).count(), accepted});
+        const int64_t clicks = m_clicksPerformed.fetch_add(accepted, std::memory_order_relaxed) + accepted;
+        if (clicks == accepted) {
+            m_firstClickTicks.store(clicked.time_since_epoch().count(), std::memory_order_relaxed);
+        }
+        if (remaining > 0) {
+            m_remainingClicks.store(remaining - accepted, std::memory_order_relaxed);
+        }
+        FLAME_LOG(Trace, "Click %lld performed, remaining %lld", clicks, remaining > 0 ? remaining - accepted : remaining);
+    }
+
+    const Clock::rep endTicks = m_clock->now().time_since_epoch().count();
+    if (trace) {
+        trace->append(TraceRecord::RunEnd, endTicks, static_cast<int64_t>(reason),
+                      m_clicksPerformed.load(std::memory_order_relaxed));
+    }
+    m_endTicks.store(endTicks, std::memory_order_relaxed);
+    m_running.store(false, std::memory_order_release);
+    FLAME_LOG(Debug, "Click engine stopped (reason %lld) after %lld click(s)",
+              static_cast<int>(reason), m_clicksPerformed.load(std::memory_order_relaxed));
+
+    if (reason != StopReason::Requested && m_finished) {
+        m_finished(reason);
+    }
+}
@@ -0,0 +1,208 @@
+#ifndef CLICKENGINE_H
+#define CLICKENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "EngineClock.h"
+#include "LatencyHistogram.h"
+#include "SpscRing.h"
+#include "TraceWriter.h"
+
+// Click scheduler running on its own thread, independent of the GUI event loop.
+// Deadlines are absolute (start + n * interval), so a late wake-up never shifts
+// the following clicks and the schedule does not drift.
+class ClickEngine {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class StopReason {
+        Requested,  // stop() was called
+        ClickLimit, // clickLimit clicks were performed
+        Duration,   // the duration budget ran out
+        Error       // the click function reported a failure
+    };
+
+    // What to do with deadlines that passed while the engine was held up
+    // (system stall, slow injection). A deadline counts as missed once the
+    // following one is also due by the time the engine wakes.
+    enum class MissPolicy {
+        CatchUp, // click every missed deadline back to back: keeps the total count
+        Skip,    // drop the missed deadlines: keeps the phase of the schedule
+        Shift    // restart the schedule from the late click: keeps the interval
+    };
+
+    struct Settings {
+        std::chrono::nanoseconds interval = std::chrono::milliseconds(1000); // between wake-ups
+        int burst = 1;                               // clicks per wake-up, sent in one injection
+        int64_t clickLimit = -1;                     // total for the run, -1 for infinite
+        std::chrono::nanoseconds duration{0};        // <= 0 for no limit
+        bool highRate = false;                       // sleep-then-spin waits for sub-ms intervals
+        MissPolicy missPolicy = MissPolicy::CatchUp;
+        // Partially accepted or blocking injections slow the schedule down
+        // (RateController) instead of ending the run with Error
+        bool adaptive = false;
+    };
+
+    // Snapshot of the current (or last) run, safe to read from any thread
+    struct Stats {
+        int64_t clicks = 0;
+        std::chrono::nanoseconds elapsed{0};         // excludes time spent paused
+        std::chrono::nanoseconds spinTime{0};
+        int64_t missedDeadlines = 0;                 // caught up, skipped or shifted past
+        int64_t backoffs = 0;                        // adaptive mode: times the rate was lowered
+        double rateFactor = 1.0;                     // adaptive mode: current share of the requested rate
+
+        double clicksPerSecond() const {
+            return elapsed.count() > 0 ? clicks * 1e9 / static_cast<double>(elapsed.count()) : 0.0;
+        }
+        // Share of one core burned busy-waiting in high-rate mode
+        double spinCpuFraction() const {
+            return elapsed.count() > 0 ? spinTime.count() / static_cast<double>(elapsed.count()) : 0.0;
+        }
+    };
+
+    // One injection: its completion time in run time ticks (since start,
+    // paused time left out, like Stats::elapsed) and the clicks it carried
+    struct ClickSample {
+        Clock::rep time = 0;
+        int64_t clicks = 0;
+    };
+    // Filled by the engine thread, one sample per injection, and drained by
+    // exactly one consumer; full means the consumer fell behind.
+    using TelemetryRing = SpscRing<ClickSample, 8192>;
+
+    // Optional per-tick timing, recorded on the engine thread. Null entries are skipped.
+    struct Probes {
+        LatencyHistogram* wakeLateness = nullptr; // wake-up past the click deadline
+        LatencyHistogram* injection = nullptr;    // time spent in the click function
+        TraceWriter* trace = nullptr;             // deadlines, wake-ups, injections and errors
+    };
+
+    // Performs `clicks` clicks (1 .. Settings::burst) on the engine thread, as one
+    // injection where possible. Returns how many of them the OS took in full,
+    // or -1 if clicking cannot go on at all (e.g. the position left the screen).
+    // `settled` gets the time the function waited on purpose (fixed position
+    // mode lets the target see the move), which the adaptive rate does not
+    // count as pushback.
+    using ClickFunction = std::function<int(int clicks, std::chrono::nanoseconds& settled)>;
+    // Invoked on the engine thread when the loop ends on its own (never for Requested).
+    using FinishedCallback = std::function<void(StopReason)>;
+
+    ClickEngine() = default;
+    ~ClickEngine();
+
+    ClickEngine(const ClickEngine&) = delete;
+    ClickEngine& operator=(const ClickEngine&) = delete;
+
+    void setClickFunction(ClickFunction fn) { m_click = std::move(fn); }
+    void setFinishedCallback(FinishedCallback cb) { m_finished = std::move(cb); }
+    // nullptr restores the steady clock. Only while stopped; the clock must outlive the run.
+    void setClock(EngineClock* clock) { m_clock = clock ? clock : SteadyEngineClock::instance(); }
+    // Only while stopped; the histograms must outlive the run
+    void setProbes(const Probes& probes) { m_probes = probes; }
+    Clock::time_point now() const { return m_clock->now(); }
+
+    // Must be called from the owning thread, never from the callbacks.
+    bool start(const Settings& settings);
+    // Swaps the settings and click function of a running engine without stopping
+    // it. The engine thread switches over before its next click; the schedule
+    // keeps its phase and clicks already made count towards the new clickLimit.
+    bool reconfigure(const Settings& settings, ClickFunction click);
+    // Sets the cancellation flag and joins the engine thread. Once it returns no
+    // click is in progress and none will follow; it waits for at most the click
+    // that had already started.
+    void stop();
+    // Freezes the schedule before the next click; the thread stays alive and
+    // blocked. resume() shifts every later deadline and the duration budget by
+    // the time spent paused, so the phase and the remaining limits carry over.
+    bool pause();
+    bool resume();
+
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+    bool isPaused() const { return m_pauseRequested.load(std::memory_order_acquire); }
+    int64_t clicksPerformed() const { return m_clicksPerformed.load(std::memory_order_relaxed); }
+    int64_t remainingClicks() const { return m_remainingClicks.load(std::memory_order_relaxed); }
+    int64_t missedDeadlines() const { return m_missedDeadlines.load(std::memory_order_relaxed); }
+    Stats stats() const;
+    TelemetryRing& telemetry() { return m_telemetry; }
+    // Time of the first click of the run, nullopt until it happened
+    std::optional<Clock::time_point> firstClickTime() const;
+    // When the run loop exited, i.e. after its last click; nullopt while running
+    std::optional<Clock::time_point> endTime() const;
+    Clock::time_point startTime() const { return Clock::time_point(Clock::duration(m_startTicks.load(std::memory_order_relaxed))); }
+
+    // Turns a per-click interval too short to wake up for into bursts: the
+    // returned settings click `burst` times every `interval`, at least
+    // minWakePeriod apart and at most maxBurst clicks each, at the same average rate
+    static Settings planBurst(Settings settings, std::chrono::nanoseconds minWakePeriod, int maxBurst);
+
+    // Deadlines after `deadline` that were already due at `woke`, i.e. missed
+    static int64_t overdueDeadlines(Clock::time_point deadline, Clock::time_point woke, Clock::duration interval) {
+        return woke > deadline && interval.count() > 0 ? (woke - deadline) / interval : 0;
+    }
+
+private:
+    // Immutable run configuration. The owning thread publishes a new one and
+    // the engine thread picks it up between clicks, RCU style.
+    struct Snapshot {
+        Settings settings;
+        ClickFunction click;
+    };
+
+    enum class WaitResult {
+        Reached,
+        Stopped,
+        Paused,
+        Reconfigured
+    };
+
+    void run();
+    const Snapshot* acquireConfig();
+    void reclaimSnapshots();
+    WaitResult waitUntil(Clock::time_point deadline, bool highRate, const Snapshot* config);
+    // Blocks while paused; false if stop() ended the pause
+    bool waitForResume();
+
+    ClickFunction m_click;
+    FinishedCallback m_finished;
+    EngineClock* m_clock = SteadyEngineClock::instance();
+    Probes m_probes;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stopRequested{false};
+    std::atomic<bool> m_pauseRequested{false};
+    std::atomic<int64_t> m_clicksPerformed{0};
+    std::atomic<int64_t> m_remainingClicks{-1};
+    std::atomic<int64_t> m_spinTimeNs{0};
+    std::atomic<int64_t> m_missedDeadlines{0};
+    std::atomic<int64_t> m_backoffs{0};
+    std::atomic<int64_t> m_rateFactorPermille{1000}; // adaptive mode: share of the requested rate
+    std::atomic<Clock::rep> m_startTicks{0};
+    std::atomic<Clock::rep> m_endTicks{0};
+    std::atomic<Clock::rep> m_firstClickTicks{0};
+    std::atomic<Clock::rep> m_pausedTicks{0};     // total time paused this run
+    std::atomic<Clock::rep> m_pauseBeginTicks{0}; // 0 unless the engine is paused now
+    TelemetryRing m_telemetry;
+
+    std::atomic<const Snapshot*> m_config{nullptr};
+    // Hazard pointer: the snapshot the engine thread is using, never freed under it
+    std::atomic<const Snapshot*> m_configInUse{nullptr};
+    // Owning thread only; the last entry is the published one
+    std::vector<std::unique_ptr<Snapshot>> m_snapshots;
+
+    // Only used to make stop(), pause(), resume() and reconfigure() interrupt a pending wait immediately
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitCondition;
+};
+
+#endif // CLICKENGINE_H
@@ -0,0 +1,345 @@
+#include "ClickJobScheduler.h"
+#include "DisplayCache.h"
+#include "PreciseWaiter.h"
+#include "RingLogger.h"
+
+#include <algorithm>
+
+namespace {
+void appendClicks(InputBatch& batch, const ClickConfig& click, int count) {
+    for (int i = 0; i < count; ++i) {
+        if (click.isKeyPress()) {
+            appendKeyPress(batch, click);
+            continue;
+        }
+        batch.buttonDown(click.button);
+        batch.buttonUp(click.button);
+        if (click.doubleClick) {
+            batch.buttonDown(click.button);
+            batch.buttonUp(click.button);
+        }
+    }
+}
+} // namespace
+
+ClickJobScheduler::ClickJobScheduler(std::chrono::nanoseconds resolution)
+    : m_resolution(std::max(resolution, std::chrono::nanoseconds(1))) {
+}
+
+ClickJobScheduler::~ClickJobScheduler() {
+    stop();
+}
+
+void ClickJobScheduler::setBackend(InputBackend* backend, const DisplayCache* display) {
+    m_backend = backend;
+    m_display = display;
+}
+
+int ClickJobScheduler::addJob(const ClickJob& job) {
+    if (isRunning() || job.interval.count() <= 0 || job.click.burst < 1) {
+        return -1;
+    }
+    m_jobs.push_back(job);
+    return jobCount() - 1;
+}
+
+void ClickJobScheduler::clearJobs() {
+    if (!isRunning()) {
+        m_jobs.clear();
+    }
+}
+
+bool ClickJobScheduler::start() {
+    if (isRunning() || m_jobs.empty() || !m_backend) {
+        return false;
+    }
+
+    // A previous run that finished on its own still has to be joined
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    const int count = jobCount();
+    m_clicks.reset(new std::atomic<int64_t>[count]);
+    m_remaining.reset(new std::atomic<int64_t>[count]);
+    m_anyHighRate = false;
+    for (int id = 0; id < count; ++id) {
+        m_clicks[id].store(0, std::memory_order_relaxed);
+        m_remaining[id].store(m_jobs[id].clickLimit, std::memory_order_relaxed);
+        m_anyHighRate = m_anyHighRate || m_jobs[id].highRate;
+    }
+
+    // Everything the engine thread touches per tick is sized here
+    m_wheel.reserve(count);
+    m_state.assign(count, JobState());
+    m_due.clear();
+    m_due.reserve(count);
+    // Sized for the most a cut-off batch can leave held: both buttons and
+    // every key job's key with up to four modifiers
+    int releasable = 2;
+    for (const ClickJob& job : m_jobs) {
+        releasable += job.click.isKeyPress() ? 5 : 0;
+    }
+    m_release.clear();
+    m_release.reserve(releasable);
+    m_held.clear();
+    m_held.reserve(releasable);
+
+    m_stopRequested.store(false, std::memory_order_relaxed);
+    m_totalClicks.store(0, std::memory_order_relaxed);
+    m_batches.store(0, std::memory_order_relaxed);
+    m_missed.store(0, std::memory_order_relaxed);
+    m_spinTimeNs.store(0, std::memory_order_relaxed);
+    m_startTicks.store(m_clock->now().time_since_epoch().count(), std::memory_order_relaxed);
+    m_endTicks.store(0, std::memory_order_relaxed);
+    m_running.store(true, std::memory_order_release);
+
+    m_thread = std::thread(&ClickJobScheduler::run, this);
+    return true;
+}
+
+void ClickJobScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_stopRequested.store(true, std::memory_order_release);
+    }
+    m_waitCondition.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_running.store(false, std::memory_order_release);
+}
+
+int64_t ClickJobScheduler::clicksPerformed(int id) const {
+    if (!m_clicks || id < 0 || id >= jobCount()) {
+        return 0;
+    }
+    return m_clicks[id].load(std::memory_order_relaxed);
+}
+
+int64_t ClickJobScheduler::remainingClicks(int id) const {
+    if (id < 0 || id >= jobCount()) {
+        return 0;
+    }
+    if (!m_remaining) {
+        return m_jobs[id].clickLimit;
+    }
+    return m_remaining[id].load(std::memory_order_relaxed);
+}
+
+ClickEngine::Stats ClickJobScheduler::stats() const {
+    ClickEngine::Stats stats;
+    stats.clicks = clicksPerformed();
+    stats.spinTime = std::chrono::nanoseconds(m_spinTimeNs.load(std::memory_order_relaxed));
+    stats.missedDeadlines = missedDeadlines();
+
+    const Clock::rep start = m_startTicks.load(std::memory_order_relaxed);
+    Clock::rep end = m_endTicks.load(std::memory_order_relaxed);
+    if (end == 0) {
+        end = m_clock->now().time_since_epoch().count();
+    }
+    stats.elapsed = Clock::duration(end - start);
+    return stats;
+}
+
+uint64_t ClickJobScheduler::tickFor(Clock::time_point time) const {
+    // Rounded up, so a job never fires before its deadline
+    const auto offset = std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_origin).count();
+    if (offset <= 0) {
+        return 0;
+    }
+    return static_cast<uint64_t>((offset + m_resolution.count() - 1) / m_resolution.count());
+}
+
+ClickJobScheduler::Clock::time_point ClickJobScheduler::timeOf(uint64_t tick) const {
+    return m_origin + std::chrono::duration_cast<Clock::duration>(m_resolution * static_cast<int64_t>(tick));
+}
+
+bool ClickJobScheduler::scheduleNext(int id) {
+    const ClickJob& job = m_jobs[id];
+    JobState& state = m_state[id];
+
+    if (m_remaining[id].load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    // A click due exactly at the end of the budget still happens
+    const Clock::time_point deadline = state.anchor + state.nextClick * job.interval;
+    if (deadline > state.end) {
+        return false;
+    }
+    m_wheel.schedule(id, tickFor(deadline));
+    return true;
+}
+
+void ClickJobScheduler::handleMissed(int id, Clock::time_point woke) {
+    const ClickJob& job = m_jobs[id];
+    JobState& state = m_state[id];
+
+    // Deadlines are rounded up to the wheel tick, so a click up to one tick
+    // late is on time
+    const Clock::time_point deadline = state.anchor + state.nextClick * job.interval;
+    const int64_t overdue = ClickEngine::overdueDeadlines(deadline + m_resolution, woke, job.interval);
+    if (overdue <= 0) {
+        return;
+    }
+
+    switch (job.missPolicy) {
+    case MissPolicy::CatchUp:
+        // The wheel hands the overdue deadlines back on the next advance
+        m_missed.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case MissPolicy::Skip:
+        state.nextClick += overdue;
+        m_missed.fetch_add(overdue, std::memory_order_relaxed);
+        break;
+    case MissPolicy::Shift:
+        state.anchor = woke;
+        state.nextClick = 0;
+        m_missed.fetch_add(overdue, std::memory_order_relaxed);
+        break;
+    }
+}
+
+int ClickJobScheduler::burstOf(int id) const {
+    // The last burst of a limited job only makes up the remainder
+    const int64_t remaining = m_remaining[id].load(std::memory_order_relaxed);
+    const int burst = m_jobs[id].click.burst;
+    return remaining > 0 ? static_cast<int>(std::min<int64_t>(burst, remaining)) : burst;
+}
+
+bool ClickJobScheduler::waitUntil(Clock::time_point deadline, bool highRate) {
+    const auto stopped = [this]() { return m_stopRequested.load(std::memory_order_acquire); };
+    const auto spun = PreciseWaiter::waitUntil(*m_clock, deadline, highRate, m_waitMutex, m_waitCondition,
+                                               m_stopRequested, stopped);
+    m_spinTimeNs.fetch_add(spun.count(), std::memory_order_relaxed);
+    return !m_stopRequested.load(std::memory_order_acquire);
+}
+
+bool ClickJobScheduler::inject() {
+    m_batch.clear();
+
+    // Cursor-position and key jobs go first, before any fixed job moves the cursor away
+    for (int id : m_due) {
+        if (!m_jobs[id].click.movesCursor()) {
+            appendClicks(m_batch, m_jobs[id].click, burstOf(id));
+        }
+    }
+
+    bool moved = false;
+    for (int id : m_due) {
+        const ClickConfig& click = m_jobs[id].click;
+        if (!click.movesCursor()) {
+            continue;
+        }
+        // The layout can change under a running scheduler
+        if (m_display && !m_display->contains(click.x, click.y)) {
+            FLAME_LOG(Warning, "Click job %lld position left the virtual screen", static_cast<long long>(id));
+            return false;
+        }
+        m_batch.moveTo(click.x, click.y);
+        appendClicks(m_batch, click, burstOf(id));
+        moved = true;
+    }
+
+    // One move back at the end of the whole batch; a backend that cannot read
+    // the cursor simply leaves it on the last target
+    int originalX = 0;
+    int originalY = 0;
+    if (moved && m_backend->canReadCursor() && m_backend->cursorPosition(originalX, originalY)) {
+        m_batch.moveTo(originalX, originalY);
+    }
+
+    const int sent = m_backend->submit(m_batch);
+    m_batches.fetch_add(1, std::memory_order_relaxed);
+    if (sent == m_batch.size()) {
+        return true;
+    }
+
+    // The OS took only part of the batch; release exactly what that part left
+    // held, last pressed first, so a chord comes apart in reverse
+    m_held.clear();
+    m_held.track(m_batch, sent);
+    if (!m_held.isEmpty()) {
+        m_release.clear();
+        m_held.releaseInto(m_release);
+        m_backend->submit(m_release);
+    }
+    return false;
+}
+
+void ClickJobScheduler::run() {
+    const EngineThreadTiming timing;
+
+    m_origin = Clock::time_point(Clock::duration(m_startTicks.load(std::memory_order_relaxed)));
+    m_wheel.clear();
+    for (int id = 0; id < jobCount(); ++id) {
+        m_state[id].anchor = m_origin;
+        if (m_jobs[id].duration.count() > 0) {
+            m_state[id].end = m_origin + m_jobs[id].duration;
+        }
+        scheduleNext(id);
+    }
+
+    // With every job done on its own, the run ends for the reason of the last one
+    StopReason reason = StopReason::Requested;
+    StopReason lastJobReason = StopReason::ClickLimit;
+
+    for (;;) {
+        if (m_wheel.empty()) {
+            reason = lastJobReason;
+            break;
+        }
+
+        if (!waitUntil(timeOf(m_wheel.nextExpiry()), m_anyHighRate)) {
+            break;
+        }
+
+        // Everything due by now, including jobs that share the tick, is one batch
+        const Clock::time_point woke = m_clock->now();
+        m_due.clear();
+        m_wheel.advance(tickFor(woke), [this](int id) { m_due.push_back(id); });
+        if (m_due.empty()) {
+            continue;
+        }
+
+        // Last cancellation point before the injection
+        if (m_stopRequested.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        if (!inject()) {
+            FLAME_LOG(Warning, "Click job batch failed after %lld click(s)",
+                      m_totalClicks.load(std::memory_order_relaxed));
+            reason = StopReason::Error;
+            break;
+        }
+
+        int64_t clicks = 0;
+        for (int id : m_due) {
+            const int burst = burstOf(id);
+            m_clicks[id].fetch_add(burst, std::memory_order_relaxed);
+            const int64_t remaining = m_remaining[id].load(std::memory_order_relaxed);
+            if (remaining > 0) {
+                m_remaining[id].store(remaining - burst, std::memory_order_relaxed);
+            }
+            clicks += burst;
+            handleMissed(id, woke);
+            ++m_state[id].nextClick;
+            if (!scheduleNext(id)) {
+                lastJobReason = remaining == burst ? StopReason::ClickLimit : StopReason::Duration;
+            }
+        }
+        m_totalClicks.fetch_add(clicks, std::memory_order_relaxed);
+    }
+
+    m_endTicks.store(m_clock->now().time_since_epoch().count(), std::memory_order_relaxed);
+    m_running.store(false, std::memory_order_release);
+    FLAME_LOG(Debug, "Click job scheduler stopped (reason %lld) after %lld click(s) in %lld batch(es)",
+              static_cast<int>(reason), m_totalClicks.load(std::memory_order_relaxed),
+              m_batches.load(std::memory_order_relaxed));
+
+    if (reason != StopReason::Requested && m_finished) {
+        m_finished(reason);
+    }
+}
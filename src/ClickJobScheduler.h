@@ -0,0 +1,130 @@
+#ifndef CLICKJOBSCHEDULER_H
+#define CLICKJOBSCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ClickEngine.h"
+#include "ClickProgram.h"
+#include "EngineClock.h"
+#include "InputBackend.h"
+#include "TimingWheel.h"
+
+class DisplayCache;
+
+// One independent click stream of a ClickJobScheduler
+struct ClickJob {
+    ClickConfig click;                     // Fixed positions are always clicked as FixedInstant
+    std::chrono::nanoseconds interval = std::chrono::milliseconds(1000); // between bursts of click.burst clicks
+    int64_t clickLimit = -1;               // -1 for infinite
+    std::chrono::nanoseconds duration{0};  // <= 0 for no limit
+    bool highRate = false;                 // sleep-then-spin waits for sub-ms intervals
+    ClickEngine::MissPolicy missPolicy = ClickEngine::MissPolicy::CatchUp;
+};
+
+// Runs any number of click jobs on a single engine thread. Each job keeps its
+// own absolute deadlines (start + n * interval), held in a timing wheel so the
+// next deadline of many jobs is found in O(1). Jobs due on the same wheel tick
+// go out together as one injection batch: one OS call, cursor moves and key
+// presses included.
+class ClickJobScheduler {
+public:
+    using Clock = ClickEngine::Clock;
+    using StopReason = ClickEngine::StopReason;
+    using FinishedCallback = ClickEngine::FinishedCallback;
+    using MissPolicy = ClickEngine::MissPolicy;
+
+    // Deadlines are rounded up to the resolution; jobs within one tick are merged
+    explicit ClickJobScheduler(std::chrono::nanoseconds resolution = std::chrono::microseconds(50));
+    ~ClickJobScheduler();
+
+    ClickJobScheduler(const ClickJobScheduler&) = delete;
+    ClickJobScheduler& operator=(const ClickJobScheduler&) = delete;
+
+    // Setup, only while stopped. The backend and display cache must outlive the run.
+    void setBackend(InputBackend* backend, const DisplayCache* display);
+    void setClock(EngineClock* clock) { m_clock = clock ? clock : SteadyEngineClock::instance(); }
+    void setFinishedCallback(FinishedCallback cb) { m_finished = std::move(cb); }
+    // Returns the job's id, its index in the order added; -1 if running or invalid
+    int addJob(const ClickJob& job);
+    void clearJobs();
+    int jobCount() const { return static_cast<int>(m_jobs.size()); }
+    const ClickJob& job(int id) const { return m_jobs[id]; }
+
+    // Must be called from the owning thread, never from the finished callback
+    bool start();
+    // Joins the engine thread; no click is in progress once it returns
+    void stop();
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    // Live figures, safe from any thread while running
+    int64_t clicksPerformed() const { return m_totalClicks.load(std::memory_order_relaxed); }
+    int64_t clicksPerformed(int id) const;
+    int64_t remainingClicks(int id) const;
+    // One per injection; fewer than clicksPerformed() when deadlines coincided
+    int64_t batchesSubmitted() const { return m_batches.load(std::memory_order_relaxed); }
+    int64_t missedDeadlines() const { return m_missed.load(std::memory_order_relaxed); }
+    ClickEngine::Stats stats() const;
+
+private:
+    // Engine thread bookkeeping for one job
+    struct JobState {
+        Clock::time_point anchor;                      // deadline = anchor + nextClick * interval
+        int64_t nextClick = 1;
+        Clock::time_point end = Clock::time_point::max();
+    };
+
+    void run();
+    bool waitUntil(Clock::time_point deadline, bool highRate);
+    bool inject();
+    // Clicks the job sends on this wake-up: its burst, capped by what is left
+    int burstOf(int id) const;
+    // Puts the job's next deadline on the wheel; false if the job is done
+    bool scheduleNext(int id);
+    // Applies the job's miss policy after a click that woke at `woke`
+    void handleMissed(int id, Clock::time_point woke);
+    uint64_t tickFor(Clock::time_point time) const;
+    Clock::time_point timeOf(uint64_t tick) const;
+
+    std::chrono::nanoseconds m_resolution;
+    InputBackend* m_backend = nullptr;
+    const DisplayCache* m_display = nullptr;
+    EngineClock* m_clock = SteadyEngineClock::instance();
+    FinishedCallback m_finished;
+    std::vector<ClickJob> m_jobs;
+    bool m_anyHighRate = false;
+
+    // Engine thread only while running
+    TimingWheel m_wheel;
+    std::vector<JobState> m_state;
+    std::vector<int> m_due;
+    InputBatch m_batch;
+    InputBatch m_release;
+    HeldInputs m_held;
+    Clock::time_point m_origin;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stopRequested{false};
+    // Sized in start(); one entry per job
+    std::unique_ptr<std::atomic<int64_t>[]> m_clicks;
+    std::unique_ptr<std::atomic<int64_t>[]> m_remaining;
+    std::atomic<int64_t> m_totalClicks{0};
+    std::atomic<int64_t> m_batches{0};
+    std::atomic<int64_t> m_missed{0};
+    std::atomic<int64_t> m_spinTimeNs{0};
+    std::atomic<Clock::rep> m_startTicks{0};
+    std::atomic<Clock::rep> m_endTicks{0};
+
+    // Only used to make stop() interrupt a pending wait immediately
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitCondition;
+};
+
+#endif // CLICKJOBSCHEDULER_H
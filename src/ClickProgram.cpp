@@ -0,0 +1,268 @@
+#include "ClickProgram.h"
+
+#include "DisplayCache.h"
+#include "InputCodes.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+struct Modifier {
+    uint8_t bit;
+    uint16_t code;
+};
+
+// Chord modifiers in press order; the left-hand keys stand for either side
+constexpr Modifier Modifiers[] = {
+    {KeyModifier::Ctrl, InputCode::KeyLeftCtrl},
+    {KeyModifier::Shift, InputCode::KeyLeftShift},
+    {KeyModifier::Alt, InputCode::KeyLeftAlt},
+    {KeyModifier::Meta, InputCode::KeyLeftMeta},
+};
+
+void appendModifierUps(InputBatch& batch, uint8_t modifiers) {
+    for (auto it = std::rbegin(Modifiers); it != std::rend(Modifiers); ++it) {
+        if (modifiers & it->bit) batch.keyUp(it->code);
+    }
+}
+
+// What one click sends, between any cursor moves
+template <MouseButton Button, bool Double>
+struct ButtonPress {
+    static void append(InputBatch& batch, const ClickConfig&) {
+        batch.buttonDown(Button);
+        batch.buttonUp(Button);
+        if constexpr (Double) {
+            batch.buttonDown(Button);
+            batch.buttonUp(Button);
+        }
+    }
+};
+
+struct KeyPress {
+    static void append(InputBatch& batch, const ClickConfig& config) { appendKeyPress(batch, config); }
+};
+
+// Backend-native batch plus what is needed to submit it safely
+struct Prepared {
+    // std::function needs a copyable target
+    std::shared_ptr<PreparedBatch> batch;
+    // What it was built from, to tell what a cut-off submit left pressed
+    InputBatch source;
+    // How many clicks are complete after the first n events went out
+    std::vector<int> clicksAfter;
+    int restoreIndex = 0;
+};
+
+bool isRelease(InputEvent::Type type) {
+    return type == InputEvent::Type::ButtonUp || type == InputEvent::Type::KeyUp;
+}
+
+// One instantiation per configuration; nothing is decided per click that
+// was already known at start.
+template <typename Press, PositionMode Mode>
+class ClickRoutine {
+public:
+    ClickRoutine(InputBackend& backend, const ClickConfig& config, const DisplayCache* display)
+        : m_backend(&backend), m_display(display), m_x(config.x), m_y(config.y), m_burst(std::max(1, config.burst)) {
+        m_restoreCursor = Mode != PositionMode::Dynamic && backend.canReadCursor();
+        InputBatch click;
+        Press::append(click, config);
+        for (const InputEvent& event : click.events()) {
+            m_releasesPerClick += isRelease(event.type) ? 1 : 0;
+        }
+        m_full = prepare(backend, config, m_burst);
+        // 1, 2, 4 ... clicks: any shorter burst is at most log2(burst) + 1 injections
+        for (int clicks = 1; clicks < m_burst; clicks *= 2) {
+            m_parts.push_back(prepare(backend, config, clicks));
+        }
+        // A cut can leave at most the key and its modifiers held
+        m_held.reserve(m_releasesPerClick);
+        m_release.reserve(m_releasesPerClick);
+    }
+
+    int operator()(int clicks, std::chrono::nanoseconds& settled) {
+        if constexpr (Mode == PositionMode::Dynamic) {
+            return submitClicks(clicks);
+        } else {
+            // The layout can change under a running engine
+            if (m_display && !m_display->contains(m_x, m_y)) {
+                return -1;
+            }
+
+            int originalX = m_x;
+            int originalY = m_y;
+
+            if constexpr (Mode == PositionMode::FixedInstant) {
+                // A backend that cannot read the cursor simply leaves it on the target
+                if (!(m_restoreCursor && m_backend->cursorPosition(originalX, originalY))) {
+                    originalX = m_x;
+                    originalY = m_y;
+                }
+                m_restoreX = originalX;
+                m_restoreY = originalY;
+                const int accepted = submitClicks(clicks);
+                // A cut-off batch never reached its restoring move
+                if (accepted < clicks && m_restoreCursor) {
+                    m_backend->setCursorPosition(originalX, originalY);
+                }
+                return accepted;
+            } else {
+                if (m_restoreCursor && !m_backend->cursorPosition(originalX, originalY)) {
+                    return -1;
+                }
+                if (!m_backend->setCursorPosition(m_x, m_y)) {
+                    return -1;
+                }
+
+                // Let the target window see the move before the press
+                settled += settle();
+                const int accepted = submitClicks(clicks);
+
+                if (m_restoreCursor) {
+                    if (accepted == clicks) {
+                        settled += settle();
+                    }
+                    m_backend->setCursorPosition(originalX, originalY);
+                }
+                return accepted;
+            }
+        }
+    }
+
+private:
+    // One deliberate pause, as long as it actually took
+    static std::chrono::nanoseconds settle() {
+        const auto begin = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return std::chrono::steady_clock::now() - begin;
+    }
+
+    Prepared prepare(InputBackend& backend, const ClickConfig& config, int clicks) const {
+        Prepared prepared;
+        InputBatch batch;
+        if constexpr (Mode == PositionMode::FixedInstant) {
+            batch.moveTo(m_x, m_y);
+        }
+        for (int i = 0; i < clicks; ++i) {
+            Press::append(batch, config);
+        }
+        if constexpr (Mode == PositionMode::FixedInstant) {
+            // Restore target is patched in on each tick
+            prepared.restoreIndex = batch.size();
+            batch.moveTo(m_x, m_y);
+        }
+        prepared.batch = std::shared_ptr<PreparedBatch>(backend.prepare(batch));
+
+        int ups = 0;
+        prepared.clicksAfter.push_back(0);
+        for (const InputEvent& event : batch.events()) {
+            ups += isRelease(event.type) ? 1 : 0;
+            prepared.clicksAfter.push_back(ups / m_releasesPerClick);
+        }
+        prepared.source = batch;
+        return prepared;
+    }
+
+    // Number of clicks the OS took in full
+    int submitClicks(int clicks) {
+        if (clicks == m_burst) {
+            return submit(m_full);
+        }
+        int accepted = 0;
+        for (int part = static_cast<int>(m_parts.size()) - 1; part >= 0; --part) {
+            const int size = 1 << part;
+            if ((clicks & size) == 0) {
+                continue;
+            }
+            const int sent = submit(m_parts[part]);
+            accepted += sent;
+            if (sent < size) {
+                break;
+            }
+        }
+        return accepted;
+    }
+
+    int submit(Prepared& prepared) {
+        if constexpr (Mode == PositionMode::FixedInstant) {
+            prepared.batch->setMoveTarget(prepared.restoreIndex, m_restoreX, m_restoreY);
+        }
+        const int sent = m_backend->submitPrepared(*prepared.batch);
+        if (sent == prepared.batch->size()) {
+            return prepared.clicksAfter.back();
+        }
+        // The OS took only part of the batch; never leave a button or key pressed
+        if (sent <= 0 || sent >= static_cast<int>(prepared.clicksAfter.size())) {
+            return 0;
+        }
+        m_held.clear();
+        m_held.track(prepared.source, sent);
+        if (!m_held.isEmpty()) {
+            m_release.clear();
+            m_held.releaseInto(m_release);
+            m_backend->submit(m_release);
+        }
+        return prepared.clicksAfter[sent];
+    }
+
+    InputBackend* m_backend;
+    const DisplayCache* m_display;
+    int m_x;
+    int m_y;
+    int m_burst;
+    int m_releasesPerClick = 0;
+    bool m_restoreCursor = false;
+    int m_restoreX = 0;
+    int m_restoreY = 0;
+    Prepared m_full;
+    std::vector<Prepared> m_parts; // m_parts[i] carries 2^i clicks, all below m_burst
+    HeldInputs m_held;
+    InputBatch m_release;
+};
+
+template <MouseButton Button, bool Double>
+ClickEngine::ClickFunction compileFor(InputBackend& backend, const ClickConfig& config, const DisplayCache* display) {
+    using Press = ButtonPress<Button, Double>;
+    switch (config.mode) {
+    case PositionMode::Fixed:
+        return ClickRoutine<Press, PositionMode::Fixed>(backend, config, display);
+    case PositionMode::FixedInstant:
+        return ClickRoutine<Press, PositionMode::FixedInstant>(backend, config, display);
+    case PositionMode::Dynamic:
+        break;
+    }
+    return ClickRoutine<Press, PositionMode::Dynamic>(backend, config, display);
+}
+
+template <MouseButton Button>
+ClickEngine::ClickFunction compileForButton(InputBackend& backend, const ClickConfig& config, const DisplayCache* display) {
+    return config.doubleClick ? compileFor<Button, true>(backend, config, display)
+                              : compileFor<Button, false>(backend, config, display);
+}
+} // namespace
+
+void appendKeyPress(InputBatch& batch, const ClickConfig& config) {
+    for (const Modifier& modifier : Modifiers) {
+        if (config.modifiers & modifier.bit) batch.keyDown(modifier.code);
+    }
+    batch.keyDown(config.key);
+    batch.keyUp(config.key);
+    appendModifierUps(batch, config.modifiers);
+}
+
+ClickEngine::ClickFunction compileClickProgram(InputBackend& backend, const ClickConfig& config,
+                                               const DisplayCache* display) {
+    // Keys go to the focused window; the cursor stays where it is
+    if (config.isKeyPress()) {
+        return ClickRoutine<KeyPress, PositionMode::Dynamic>(backend, config, display);
+    }
+    if (config.button == MouseButton::Right) {
+        return compileForButton<MouseButton::Right>(backend, config, display);
+    }
+    return compileForButton<MouseButton::Left>(backend, config, display);
+}
@@ -0,0 +1,58 @@
+#ifndef CLICKPROGRAM_H
+#define CLICKPROGRAM_H
+
+#include "ClickEngine.h"
+#include "InputBackend.h"
+
+class DisplayCache;
+
+enum class PositionMode : uint8_t {
+    Dynamic,     // click wherever the cursor is
+    Fixed,       // move, settle, click, move back
+    FixedInstant // move, click and move back in one injection
+};
+
+// Modifiers of an auto-pressed key chord, held in this order around the key
+namespace KeyModifier {
+constexpr uint8_t Ctrl = 1 << 0;
+constexpr uint8_t Shift = 1 << 1;
+constexpr uint8_t Alt = 1 << 2;
+constexpr uint8_t Meta = 1 << 3; // Windows key
+} // namespace KeyModifier
+
+// Click settings that stay constant for a whole run
+struct ClickConfig {
+    MouseButton button = MouseButton::Left;
+    bool doubleClick = false;
+    PositionMode mode = PositionMode::Dynamic;
+    int x = 0;
+    int y = 0;
+    int burst = 1; // clicks per injection, see ClickEngine::Settings::burst
+    // Nonzero: every click is a press of this key (a Linux key code, see
+    // InputCodes.h) with the modifiers held around it. Keys go to the focused
+    // window, so button, doubleClick and the position do not apply.
+    uint16_t key = 0;
+    uint8_t modifiers = 0; // KeyModifier bits
+
+    bool isKeyPress() const { return key != 0; }
+    bool movesCursor() const { return key == 0 && mode != PositionMode::Dynamic; }
+};
+
+// One press of the config's key chord: modifiers down, key down, key up,
+// modifiers up in reverse order
+void appendKeyPress(InputBatch& batch, const ClickConfig& config);
+
+// Turns a configuration into the engine's per-click routine. The event buffers
+// are prepared here, once, and the returned function is specialized for the
+// button / single-double / position combination (or the key chord), so a
+// tick only submits.
+// A full burst goes out as one prepared batch; a shorter one (the end of a
+// limited run, or a burst cut back by the adaptive rate) as a few prepared
+// power-of-two batches.
+// When the OS takes only part of a batch, the buttons and keys that part left
+// held are released and the routine reports the clicks that went through in full.
+// The backend (and display cache, if given) must outlive the returned function.
+ClickEngine::ClickFunction compileClickProgram(InputBackend& backend, const ClickConfig& config,
+                                               const DisplayCache* display);
+
+#endif // CLICKPROGRAM_H
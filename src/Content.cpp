@@ -1,5 +1,6 @@
 #include "Content.h"
 #include "hotkeysettingswindow.h"
+#include "DisplayTopology.h"
 
 #include <QHBoxLayout>
 #include <QVBoxLayout>
@@ -13,16 +14,35 @@
 #include <QScreen>
 #include <QRegularExpression>
 #include <QPalette>
+#include <QStringList>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFileDialog>
+#include <QFileInfo>
 #include <QIntValidator> // Use QIntValidator
 #include <windows.h>
 
+#include "InputCodes.h"
+
 // Includes for classes forward-declared in header
 #include <QLineEdit>
 #include <QPushButton>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QLabel>
 
 namespace {
+// FLAME_LATENCY_DUMP overrides where the histograms go on exit
+QString latencyDumpPath() {
+    const QString custom = qEnvironmentVariable("FLAME_LATENCY_DUMP");
+    if (!custom.isEmpty()) {
+        return custom;
+    }
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    QDir().mkpath(dir);
+    return dir + "/latency.txt";
+}
+
 // Helper function to get key names
 QString getKeyName(int keyCode) {
     switch (keyCode) {
@@ -72,12 +92,25 @@ QString hotkeyString(const Hotkey& hotkey) {
     parts << getKeyName(hotkey.keyCode);
     return parts.join(" + ");
 }
+
+bool sameHotkey(const Hotkey& a, const Hotkey& b) {
+    return a.ctrl == b.ctrl && a.shift == b.shift && a.alt == b.alt && a.win == b.win && a.keyCode == b.keyCode;
+}
+
+// Modifier bits of a chord picked in the hotkey dialog
+uint8_t keyModifiers(const Hotkey& hotkey) {
+    return static_cast<uint8_t>((hotkey.ctrl ? KeyModifier::Ctrl : 0) | (hotkey.shift ? KeyModifier::Shift : 0)
+                              | (hotkey.alt ? KeyModifier::Alt : 0) | (hotkey.win ? KeyModifier::Meta : 0));
+}
 } // namespace
 
 
 MainContent::MainContent(QWidget* parent)
     : QWidget(parent)
     , m_currentHotkey({false, false, false, false, VK_F6}) // Default: F6
+    , m_pauseHotkey({false, false, false, false, VK_F7})   // Default: F7
+    , m_recordHotkey({false, false, false, false, VK_F8})  // Default: F8
+    , m_pressKey({false, false, false, false, VK_SPACE})    // Default: Space
     , m_isActive(false)
     , m_hotkeyRegistered(false)
     , m_targetPos(-1, -1)
@@ -87,22 +120,31 @@ MainContent::MainContent(QWidget* parent)
     setupValidators();
     setupConnections();
 
-    if (press) {
-        press->setText("Press " + hotkeyString(m_currentHotkey) + " to start/stop clicking");
-    }
+    updateHotkeyHint();
+    updateJobsLabel();
+    updateMacroLabel();
 
-    registerWindowsHotkey(m_currentHotkey);
+    registerWindowsHotkey(HOTKEY_ID, m_currentHotkey);
+    registerWindowsHotkey(PAUSE_HOTKEY_ID, m_pauseHotkey);
+    // Without a recorder the record hotkey only stops playback, so it is
+    // registered while a macro plays
+    if (m_autoclicker.canRecord()) {
+        registerWindowsHotkey(RECORD_HOTKEY_ID, m_recordHotkey);
+    }
     qDebug() << "MainContent initialized successfully";
 }
 
 MainContent::~MainContent() {
     qDebug() << "MainContent destructor called";
-    unregisterWindowsHotkey();
+    unregisterWindowsHotkey(HOTKEY_ID);
+    unregisterWindowsHotkey(PAUSE_HOTKEY_ID);
+    unregisterWindowsHotkey(RECORD_HOTKEY_ID);
 
     if (m_autoclicker.isActive()) {
         m_autoclicker.stop();
         qDebug() << "Autoclicker stopped in destructor";
     }
+    m_autoclicker.dumpLatency(latencyDumpPath());
     qDebug() << "MainContent destroyed safely";
 }
 
@@ -119,19 +161,56 @@ void MainContent::setupUi() {
     durationSecs = new QLineEdit(this);
     clickBut = new QPushButton("Start Clicking", this);
     hotkeyBut = new QPushButton("Change Hotkey", this);
+    pauseHotkeyBut = new QPushButton("Pause Hotkey", this);
     posSet = new QPushButton("Set Position", this);
     posPick = new QPushButton("Pick Position", this);
     posClear = new QPushButton("Clear/Dynamic", this); // <--- NEW BUTTON
+    addJobBut = new QPushButton("Add Job", this);
+    clearJobsBut = new QPushButton("Clear Jobs", this);
+    recordBut = new QPushButton("Record Macro", this);
+    playBut = new QPushButton("Play Macro", this);
+    saveMacroBut = new QPushButton("Save", this);
+    openMacroBut = new QPushButton("Open", this);
+    importBut = new QPushButton("Import", this);
+    loopsInp = new QLineEdit("1", this);
+    speedBox = new QComboBox(this);
+    for (double speed : {0.25, 0.5, 1.0, 2.0, 4.0, 10.0}) {
+        speedBox->addItem(QString("%1x").arg(speed), speed);
+    }
+    speedBox->setCurrentIndex(2); // 1x
     doubleClickCheckbox = new QCheckBox(this);
     doubleClickLabel = new QLabel("Double Click", this);
     rightClickCheckbox = new QCheckBox(this);
     rightClickLabel = new QLabel("Right Click", this);
+    highRateCheckbox = new QCheckBox(this);
+    highRateLabel = new QLabel("High Rate (µs)", this);
+    instantMoveCheckbox = new QCheckBox(this);
+    instantMoveLabel = new QLabel("Instant Move", this);
+    burstCheckbox = new QCheckBox(this);
+    burstLabel = new QLabel("Burst", this);
+    pressKeyCheckbox = new QCheckBox(this);
+    pressKeyLabel = new QLabel("Press Key", this);
+    pressKeyCheckbox->setToolTip("Press the key or key combination on the right instead of clicking");
+    pressKeyBut = new QPushButton(hotkeyString(m_pressKey), this);
+    adaptiveCheckbox = new QCheckBox(this);
+    adaptiveLabel = new QLabel("Adaptive Rate", this);
+    // Backing off under input pressure beats stopping; on unless turned off
+    adaptiveCheckbox->setChecked(true);
+    adaptiveCheckbox->setToolTip("Slow down when Windows or the target cannot keep up, then recover, instead of stopping");
+    missPolicyLab = new QLabel("When clicks fall behind:", this);
+    missPolicyBox = new QComboBox(this);
+    missPolicyBox->addItem("Catch up (keep the click count)", static_cast<int>(ClickEngine::MissPolicy::CatchUp));
+    missPolicyBox->addItem("Skip (keep the rhythm)", static_cast<int>(ClickEngine::MissPolicy::Skip));
+    missPolicyBox->addItem("Shift (keep the interval)", static_cast<int>(ClickEngine::MissPolicy::Shift));
     interval = new QLabel("Interval | Blank for none:", this);
     clicksLab = new QLabel("Number of Clicks | Blank for infinite (until stopped):", this);
     durationLab = new QLabel("Duration | Blank for until stopped:", this);
     status = new QLabel("Ready to use", this);
+    progress = new QLabel(this);
     press = new QLabel(this);
     posLab = new QLabel("Position | Blank for current pos:", this);
+    jobsLab = new QLabel(this);
+    macroLab = new QLabel(this);
 
     // Set placeholders
     setWidgetPlaceholder(hours, "Hours");
@@ -143,18 +222,36 @@ void MainContent::setupUi() {
     setWidgetPlaceholder(durationHours, "Hours");
     setWidgetPlaceholder(durationMins, "Minutes");
     setWidgetPlaceholder(durationSecs, "Seconds");
+    setWidgetPlaceholder(loopsInp, "Loops, 0 = endless");
+    loopsInp->setToolTip("Times to play the macro; 0 repeats until stopped");
 
     // Initialize ms text to 5 by default (User Request)
     ms->setText("5");
 
     // Set cursors
     setWidgetCursor(rightClickCheckbox, Qt::PointingHandCursor);
+    setWidgetCursor(highRateCheckbox, Qt::PointingHandCursor);
+    setWidgetCursor(instantMoveCheckbox, Qt::PointingHandCursor);
+    setWidgetCursor(burstCheckbox, Qt::PointingHandCursor);
+    setWidgetCursor(pressKeyCheckbox, Qt::PointingHandCursor);
+    setWidgetCursor(pressKeyBut, Qt::PointingHandCursor);
+    setWidgetCursor(adaptiveCheckbox, Qt::PointingHandCursor);
+    setWidgetCursor(missPolicyBox, Qt::PointingHandCursor);
     setWidgetCursor(doubleClickCheckbox, Qt::PointingHandCursor);
     setWidgetCursor(posSet, Qt::PointingHandCursor);
     setWidgetCursor(posPick, Qt::PointingHandCursor);
     setWidgetCursor(posClear, Qt::PointingHandCursor); // <--- NEW CURSOR
+    setWidgetCursor(addJobBut, Qt::PointingHandCursor);
+    setWidgetCursor(clearJobsBut, Qt::PointingHandCursor);
+    setWidgetCursor(recordBut, Qt::PointingHandCursor);
+    setWidgetCursor(playBut, Qt::PointingHandCursor);
+    setWidgetCursor(saveMacroBut, Qt::PointingHandCursor);
+    setWidgetCursor(openMacroBut, Qt::PointingHandCursor);
+    setWidgetCursor(importBut, Qt::PointingHandCursor);
+    setWidgetCursor(speedBox, Qt::PointingHandCursor);
     setWidgetCursor(clickBut, Qt::PointingHandCursor);
     setWidgetCursor(hotkeyBut, Qt::PointingHandCursor);
+    setWidgetCursor(pauseHotkeyBut, Qt::PointingHandCursor);
 
     // Create layouts
     QHBoxLayout* inputLayout = new QHBoxLayout;
@@ -181,10 +278,44 @@ void MainContent::setupUi() {
     rightClickLayout->addWidget(rightClickLabel);
     rightClickLayout->addStretch();
 
+    QHBoxLayout* highRateLayout = new QHBoxLayout;
+    highRateLayout->addWidget(highRateCheckbox);
+    highRateLayout->addWidget(highRateLabel);
+    highRateLayout->addStretch();
+
+    QHBoxLayout* instantMoveLayout = new QHBoxLayout;
+    instantMoveLayout->addWidget(instantMoveCheckbox);
+    instantMoveLayout->addWidget(instantMoveLabel);
+    instantMoveLayout->addStretch();
+
+    QHBoxLayout* burstLayout = new QHBoxLayout;
+    burstLayout->addWidget(burstCheckbox);
+    burstLayout->addWidget(burstLabel);
+    burstLayout->addStretch();
+
+    QHBoxLayout* adaptiveLayout = new QHBoxLayout;
+    adaptiveLayout->addWidget(adaptiveCheckbox);
+    adaptiveLayout->addWidget(adaptiveLabel);
+    adaptiveLayout->addStretch();
+
     checkboxLayout->addLayout(doubleClickLayout);
     checkboxLayout->addLayout(rightClickLayout);
+    checkboxLayout->addLayout(highRateLayout);
+    checkboxLayout->addLayout(instantMoveLayout);
+    checkboxLayout->addLayout(burstLayout);
+    checkboxLayout->addLayout(adaptiveLayout);
     checkboxLayout->setSpacing(20);
 
+    // Key press mode sends the chosen chord on the click schedule
+    QHBoxLayout* missPolicyLayout = new QHBoxLayout;
+    missPolicyLayout->addWidget(pressKeyCheckbox);
+    missPolicyLayout->addWidget(pressKeyLabel);
+    missPolicyLayout->addWidget(pressKeyBut);
+    missPolicyLayout->addSpacing(20);
+    missPolicyLayout->addWidget(missPolicyLab);
+    missPolicyLayout->addWidget(missPolicyBox, 1);
+    missPolicyLayout->setSpacing(10);
+
     QHBoxLayout* posButsLayout = new QHBoxLayout;
     posButsLayout->addWidget(posSet);
     posButsLayout->addWidget(posPick);
@@ -196,6 +327,25 @@ void MainContent::setupUi() {
     posInpLayout->addLayout(posButsLayout);
     posInpLayout->setSpacing(10);
 
+    // Queued jobs run side by side on one scheduler instead of the form alone
+    QHBoxLayout* jobsLayout = new QHBoxLayout;
+    jobsLayout->addWidget(jobsLab, 1);
+    jobsLayout->addWidget(addJobBut);
+    jobsLayout->addWidget(clearJobsBut);
+    jobsLayout->setSpacing(10);
+
+    QHBoxLayout* macroLayout = new QHBoxLayout;
+    macroLayout->addWidget(macroLab, 1);
+    macroLayout->addWidget(loopsInp);
+    macroLayout->addWidget(speedBox);
+    macroLayout->addWidget(playBut);
+    macroLayout->addWidget(recordBut);
+    recordBut->setVisible(m_autoclicker.canRecord());
+    macroLayout->addWidget(openMacroBut);
+    macroLayout->addWidget(importBut);
+    macroLayout->addWidget(saveMacroBut);
+    macroLayout->setSpacing(10);
+
     QHBoxLayout* bottomButLayout = new QHBoxLayout;
     bottomButLayout->addWidget(clickBut);
     bottomButLayout->setAlignment(Qt::AlignCenter);
@@ -204,9 +354,14 @@ void MainContent::setupUi() {
     statusLayout->addWidget(status);
     statusLayout->setAlignment(Qt::AlignCenter);
 
+    QHBoxLayout* progressLayout = new QHBoxLayout;
+    progressLayout->addWidget(progress);
+    progressLayout->setAlignment(Qt::AlignCenter);
+
     QHBoxLayout* bottomTextLayout = new QHBoxLayout;
     bottomTextLayout->addWidget(press, 1);
     bottomTextLayout->addWidget(hotkeyBut);
+    bottomTextLayout->addWidget(pauseHotkeyBut);
     bottomTextLayout->setAlignment(Qt::AlignCenter);
     bottomTextLayout->setSpacing(10);
 
@@ -221,11 +376,15 @@ void MainContent::setupUi() {
     mainLayout->addWidget(clicksLab);
     mainLayout->addWidget(clicks);
     mainLayout->addLayout(checkboxLayout);
+    mainLayout->addLayout(missPolicyLayout);
     mainLayout->addWidget(posLab);
     mainLayout->addLayout(posInpLayout);
+    mainLayout->addLayout(jobsLayout);
+    mainLayout->addLayout(macroLayout);
     mainLayout->addStretch(1);
     mainLayout->addLayout(bottomButLayout);
     mainLayout->addLayout(statusLayout);
+    mainLayout->addLayout(progressLayout);
     mainLayout->addLayout(bottomTextLayout);
 
     setLayout(mainLayout);
@@ -294,21 +453,49 @@ void MainContent::setupStyles() {
     applyWidgetStyle(durationHours, inputStyle);
     applyWidgetStyle(durationMins, inputStyle);
     applyWidgetStyle(durationSecs, inputStyle);
+    applyWidgetStyle(loopsInp, inputStyle);
     applyWidgetStyle(doubleClickCheckbox, checkboxStyle);
     applyWidgetStyle(rightClickCheckbox, checkboxStyle);
+    applyWidgetStyle(highRateCheckbox, checkboxStyle);
+    applyWidgetStyle(instantMoveCheckbox, checkboxStyle);
+    applyWidgetStyle(burstCheckbox, checkboxStyle);
+    applyWidgetStyle(pressKeyCheckbox, checkboxStyle);
+    applyWidgetStyle(adaptiveCheckbox, checkboxStyle);
+    QString comboStyle = inputStyle;
+    comboStyle.replace("QLineEdit", "QComboBox");
+    applyWidgetStyle(missPolicyBox, comboStyle);
+    applyWidgetStyle(speedBox, comboStyle);
+    applyWidgetStyle(missPolicyLab, "color: #bbb; font-size: 12px;");
     applyWidgetStyle(posSet, secondaryButtonStyle);
     applyWidgetStyle(posPick, secondaryButtonStyle);
     applyWidgetStyle(posClear, secondaryButtonStyle);
+    applyWidgetStyle(addJobBut, secondaryButtonStyle);
+    applyWidgetStyle(clearJobsBut, secondaryButtonStyle);
+    applyWidgetStyle(recordBut, secondaryButtonStyle);
+    applyWidgetStyle(playBut, secondaryButtonStyle);
+    applyWidgetStyle(saveMacroBut, secondaryButtonStyle);
+    applyWidgetStyle(openMacroBut, secondaryButtonStyle);
+    applyWidgetStyle(importBut, secondaryButtonStyle);
+    applyWidgetStyle(pressKeyBut, secondaryButtonStyle);
     applyWidgetStyle(clickBut, m_startButtonStyle);
     applyWidgetStyle(hotkeyBut, secondaryButtonStyle);
+    applyWidgetStyle(pauseHotkeyBut, secondaryButtonStyle);
     applyWidgetStyle(interval, sectionLabelStyle);
     applyWidgetStyle(clicksLab, sectionLabelStyle);
     applyWidgetStyle(durationLab, sectionLabelStyle);
     applyWidgetStyle(posLab, sectionLabelStyle);
     applyWidgetStyle(doubleClickLabel, "color: #bbb; font-size: 12px;");
     applyWidgetStyle(rightClickLabel, "color: #bbb; font-size: 12px;");
+    applyWidgetStyle(highRateLabel, "color: #bbb; font-size: 12px;");
+    applyWidgetStyle(instantMoveLabel, "color: #bbb; font-size: 12px;");
+    applyWidgetStyle(burstLabel, "color: #bbb; font-size: 12px;");
+    applyWidgetStyle(pressKeyLabel, "color: #bbb; font-size: 12px;");
+    applyWidgetStyle(adaptiveLabel, "color: #bbb; font-size: 12px;");
     applyWidgetStyle(status, statusLabelStyle);
     applyWidgetStyle(press, statusLabelStyle);
+    applyWidgetStyle(progress, statusLabelStyle);
+    applyWidgetStyle(jobsLab, "color: #bbb; font-size: 12px;");
+    applyWidgetStyle(macroLab, "color: #bbb; font-size: 12px;");
 }
 
 void MainContent::setupValidators() {
@@ -318,33 +505,81 @@ void MainContent::setupValidators() {
     if (secs) secs->setValidator(new QIntValidator(0, 59, this));
     if (ms) ms->setValidator(new QIntValidator(0, 999, this));
     if (clicks) clicks->setValidator(new QIntValidator(0, 1000000, this));
+    if (loopsInp) loopsInp->setValidator(new QIntValidator(0, 1000000, this));
     if (durationHours) durationHours->setValidator(new QIntValidator(0, 24, this));
     if (durationMins) durationMins->setValidator(new QIntValidator(0, 59, this));
     if (durationSecs) durationSecs->setValidator(new QIntValidator(0, 59, this));
 }
 
 void MainContent::setupConnections() {
+    // Live progress is pulled from the engine at a fixed rate, never pushed per click
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setInterval(100);
+    connect(m_progressTimer, &QTimer::timeout, this, &MainContent::refreshProgress);
+
     connect(&m_autoclicker, &AutoClicker::started, this, [this]() {
         updateStatus("Autoclicking started");
+        setProgressTracking(true);
     });
     connect(&m_autoclicker, &AutoClicker::stopped, this, [this]() {
         updateStatus("Autoclicking stopped");
+        setProgressTracking(false);
         m_isActive = false;
         if (clickBut) {
             clickBut->setText("Start Clicking");
             applyWidgetStyle(clickBut, m_startButtonStyle);
         }
     });
+    connect(&m_autoclicker, &AutoClicker::paused, this, [this]() {
+        setWindowTitle("Paused - FlameAutoclicker");
+        updateStatus("Autoclicking paused, press " + hotkeyString(m_pauseHotkey) + " to resume");
+    });
+    connect(&m_autoclicker, &AutoClicker::resumed, this, [this]() {
+        setWindowTitle("Clicking - FlameAutoclicker");
+        updateStatus("Autoclicking resumed");
+    });
     connect(&m_autoclicker, &AutoClicker::finished, this, [this]() {
-        updateStatus("Autoclicking completed");
+        updateStatus("Autoclicking completed" + rateSummary());
+        setProgressTracking(false);
         m_isActive = false;
         if (clickBut) {
             clickBut->setText("Start Clicking");
             applyWidgetStyle(clickBut, m_startButtonStyle);
         }
     });
+    connect(&m_autoclicker, &AutoClicker::recordingStarted, this, [this]() {
+        updateStatus("Recording macro, press " + hotkeyString(m_recordHotkey) + " to stop");
+        if (recordBut) recordBut->setText("Stop Recording");
+        setProgressTracking(true);
+    });
+    connect(&m_autoclicker, &AutoClicker::recordingStopped, this, [this]() {
+        updateStatus("Macro recorded");
+        if (recordBut) recordBut->setText("Record Macro");
+        setProgressTracking(false);
+        updateMacroLabel();
+    });
+    connect(&m_autoclicker, &AutoClicker::playbackStarted, this, [this]() {
+        if (!m_autoclicker.canRecord()) {
+            registerWindowsHotkey(RECORD_HOTKEY_ID, m_recordHotkey);
+        }
+        updateStatus("Playing macro, press " + hotkeyString(m_recordHotkey) + " to stop");
+        if (playBut) playBut->setText("Stop Playing");
+        setProgressTracking(true);
+    });
+    connect(&m_autoclicker, &AutoClicker::playbackStopped, this, [this]() {
+        if (!m_autoclicker.canRecord()) {
+            unregisterWindowsHotkey(RECORD_HOTKEY_ID);
+        }
+        updateStatus("Macro playback stopped");
+        if (playBut) playBut->setText("Play Macro");
+        setProgressTracking(false);
+    });
+    connect(&m_autoclicker, &AutoClicker::playbackFinished, this, [this]() {
+        updateStatus(QString("Macro played %1 time(s)").arg(m_autoclicker.loopsPlayed()));
+    });
     connect(&m_autoclicker, &AutoClicker::error, this, [this](const QString& error) {
         updateStatus("Error: " + error);
+        setProgressTracking(false);
         m_isActive = false;
         if (clickBut) {
             clickBut->setText("Start Clicking");
@@ -355,18 +590,49 @@ void MainContent::setupConnections() {
     // Connect button signals
     if (clickBut) connect(clickBut, &QPushButton::clicked, this, &MainContent::toggleAutoclicker);
     if (hotkeyBut) connect(hotkeyBut, &QPushButton::clicked, this, &MainContent::updateHotkey);
+    if (pauseHotkeyBut) connect(pauseHotkeyBut, &QPushButton::clicked, this, &MainContent::updatePauseHotkey);
+    if (pressKeyBut) connect(pressKeyBut, &QPushButton::clicked, this, &MainContent::updatePressKey);
     if (posSet) connect(posSet, &QPushButton::clicked, this, &MainContent::setPositionFromInput);
     if (posPick) connect(posPick, &QPushButton::clicked, this, &MainContent::pickPositionFromCursor);
     if (posClear) connect(posClear, &QPushButton::clicked, this, &MainContent::clearPosition); // <--- NEW CONNECTION
+    if (addJobBut) connect(addJobBut, &QPushButton::clicked, this, &MainContent::addJob);
+    if (clearJobsBut) connect(clearJobsBut, &QPushButton::clicked, this, &MainContent::clearJobs);
+    if (recordBut) connect(recordBut, &QPushButton::clicked, this, [this]() { toggleRecording(true); });
+    if (playBut) connect(playBut, &QPushButton::clicked, this, &MainContent::togglePlayback);
+    if (saveMacroBut) connect(saveMacroBut, &QPushButton::clicked, this, &MainContent::saveMacro);
+    if (openMacroBut) connect(openMacroBut, &QPushButton::clicked, this, &MainContent::openMacro);
+    if (importBut) connect(importBut, &QPushButton::clicked, this, &MainContent::importTimeline);
+    if (highRateCheckbox) connect(highRateCheckbox, &QCheckBox::toggled, this, &MainContent::onHighRateToggled);
+    if (burstCheckbox) connect(burstCheckbox, &QCheckBox::toggled, this, &MainContent::onBurstToggled);
+
+    // Edits made while clicking go straight to the running engine
+    for (QLineEdit* field : {hours, mins, secs, ms, clicks, durationHours, durationMins, durationSecs}) {
+        if (field) connect(field, &QLineEdit::editingFinished, this, &MainContent::applyLiveSettings);
+    }
+    for (QCheckBox* option : {doubleClickCheckbox, rightClickCheckbox, highRateCheckbox, instantMoveCheckbox, burstCheckbox,
+                              adaptiveCheckbox, pressKeyCheckbox}) {
+        if (option) connect(option, &QCheckBox::toggled, this, &MainContent::applyLiveSettings);
+    }
+    if (missPolicyBox) connect(missPolicyBox, &QComboBox::currentIndexChanged, this, &MainContent::applyLiveSettings);
 }
 
 bool MainContent::nativeEvent(const QByteArray &eventType, void *message, qintptr *result) {
     if (eventType == "windows_generic_MSG") {
         MSG* msg = static_cast<MSG*>(message);
         if (msg->message == WM_HOTKEY && msg->wParam == HOTKEY_ID) {
+            // Start/stop latency is measured from here
+            m_autoclicker.markTrigger();
             toggleAutoclicker();
             return true;
         }
+        if (msg->message == WM_HOTKEY && msg->wParam == PAUSE_HOTKEY_ID) {
+            togglePause();
+            return true;
+        }
+        if (msg->message == WM_HOTKEY && msg->wParam == RECORD_HOTKEY_ID) {
+            toggleRecording();
+            return true;
+        }
     }
     return QWidget::nativeEvent(eventType, message, result);
 }
@@ -381,20 +647,205 @@ void MainContent::toggleAutoclicker() {
     }
 }
 
+void MainContent::togglePause() {
+    if (!m_isActive) {
+        updateStatus("Info: Nothing to pause, autoclicker is not running");
+        return;
+    }
+    // Remaining clicks, remaining duration and the click phase survive the pause
+    if (!m_autoclicker.togglePause() && m_autoclicker.isJobMode()) {
+        updateStatus("Info: Queued jobs cannot be paused");
+    }
+}
+
+void MainContent::toggleRecording(bool fromClick) {
+    // The macro may be moving the mouse, so the hotkey is the way out of playback
+    if (m_autoclicker.isPlaying()) {
+        m_autoclicker.stopPlayback();
+        return;
+    }
+    if (m_autoclicker.isRecording()) {
+        m_autoclicker.stopRecording(fromClick);
+        return;
+    }
+    if (m_isActive) {
+        updateStatus("Warning: Cannot record while clicking. Stop first.");
+        return;
+    }
+    m_autoclicker.startRecording(); // AutoClicker::error reports a failure
+}
+
+void MainContent::togglePlayback() {
+    if (m_autoclicker.isPlaying()) {
+        m_autoclicker.stopPlayback();
+        return;
+    }
+    if (m_isActive) {
+        updateStatus("Warning: Cannot play the macro while clicking. Stop first.");
+        return;
+    }
+    if (speedBox) m_autoclicker.setPlaybackSpeed(speedBox->currentData().toDouble());
+    if (loopsInp) m_autoclicker.setPlaybackLoops(loopsInp->text().isEmpty() ? 1 : loopsInp->text().toInt());
+    m_autoclicker.startPlayback(); // AutoClicker::error reports a failure
+}
+
+void MainContent::saveMacro() {
+    if (m_autoclicker.isRecording()) {
+        updateStatus("Warning: Stop recording before saving the macro");
+        return;
+    }
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    const QString path = QFileDialog::getSaveFileName(this, "Save Macro", dir + "/macro.flmacro",
+                                                      "Flame macros (*.flmacro)");
+    if (path.isEmpty()) {
+        return;
+    }
+    if (m_autoclicker.saveMacro(path)) {
+        updateStatus("Macro saved to " + QFileInfo(path).fileName());
+    }
+}
+
+void MainContent::openMacro() {
+    if (m_autoclicker.isRecording() || m_autoclicker.isPlaying()) {
+        updateStatus("Warning: Stop recording or playing before opening a macro");
+        return;
+    }
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    const QString path = QFileDialog::getOpenFileName(this, "Open Macro", dir, "Flame macros (*.flmacro)");
+    if (path.isEmpty()) {
+        return;
+    }
+    if (m_autoclicker.loadMacro(path)) {
+        updateMacroLabel();
+        updateStatus("Macro opened, Play Macro replays it");
+    }
+}
+
+void MainContent::importTimeline() {
+    if (m_autoclicker.isRecording() || m_autoclicker.isPlaying()) {
+        updateStatus("Warning: Stop recording or playing before importing");
+        return;
+    }
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    const QString source = QFileDialog::getOpenFileName(this, "Import Click Schedule", dir,
+                                                        "Click schedules (*.csv *.ndjson *.jsonl)");
+    if (source.isEmpty()) {
+        return;
+    }
+    // The macro file goes next to the schedule
+    const QFileInfo info(source);
+    const QString target = info.absolutePath() + "/" + info.completeBaseName() + ".flmacro";
+    if (m_autoclicker.importTimeline(source, target)) {
+        const TimelineImportResult& result = m_autoclicker.lastImport();
+        updateMacroLabel();
+        updateStatus(QString("Imported %1 clicks (%2 off-screen) at %3 rows/s")
+                         .arg(result.clicks)
+                         .arg(result.offScreen)
+                         .arg(result.rowsPerSecond(), 0, 'f', 0));
+    }
+}
+
+void MainContent::addJob() {
+    if (m_isActive) {
+        updateStatus("Warning: Cannot add a job while running. Stop first.");
+        return;
+    }
+
+    applySettings();
+    const int id = m_autoclicker.addJob();
+    if (id < 0) {
+        return; // AutoClicker::error already reported why
+    }
+    updateJobsLabel();
+    const bool keys = m_autoclicker.isKeyPressMode();
+    updateStatus(QString("Job %1 added: %2 every %3 ms%4")
+                     .arg(id + 1)
+                     .arg(keys ? hotkeyString(m_pressKey) + " press"
+                          : QString(m_autoclicker.isRightClick() ? "right click" : "left click"))
+                     .arg(m_autoclicker.intervalMicroseconds() / 1000.0, 0, 'f', m_autoclicker.isHighRateMode() ? 1 : 0)
+                     .arg(keys ? QString()
+                          : m_autoclicker.useDynamicPosition() ? QString(" at the cursor")
+                          : QString(" at %1, %2").arg(m_autoclicker.position().x()).arg(m_autoclicker.position().y())));
+}
+
+void MainContent::clearJobs() {
+    if (m_isActive) {
+        updateStatus("Warning: Cannot clear jobs while running. Stop first.");
+        return;
+    }
+    m_autoclicker.clearJobs();
+    updateJobsLabel();
+    updateStatus("Jobs cleared, Start runs the settings above");
+}
+
+void MainContent::updateJobsLabel() {
+    if (!jobsLab) return;
+
+    const int count = m_autoclicker.jobCount();
+    if (count == 0) {
+        jobsLab->setText("No queued jobs: Start runs the settings above");
+    } else {
+        jobsLab->setText(QString("%1 queued job(s): Start runs them together").arg(count));
+    }
+    if (clearJobsBut) clearJobsBut->setEnabled(count > 0);
+}
+
+void MainContent::updateMacroLabel() {
+    if (!macroLab) return;
+
+    const MacroTimeline& macro = m_autoclicker.macro();
+    if (macro.empty() && !m_autoclicker.isMacroFromFile()) {
+        macroLab->setText("No macro recorded");
+    } else {
+        const QString source = m_autoclicker.isMacroFromFile()
+            ? QFileInfo(m_autoclicker.macroFilePath()).fileName()
+            : QString("Macro");
+        macroLab->setText(QString("%1: %2 events over %3 s")
+                              .arg(source)
+                              .arg(macro.size())
+                              .arg(macro.durationUs() / 1e6, 0, 'f', 1));
+    }
+    // Only a recording is saved; an opened file already is one
+    if (saveMacroBut) saveMacroBut->setEnabled(!m_autoclicker.isMacroFromFile() && !macro.empty());
+}
+
 bool MainContent::startAutoclicker() {
     setWindowTitle("Clicking - FlameAutoclicker");
 
-    qint64 intervalMs = calculateTotalMs();
-    const int clickCount = validateClicksInput();
-    const qint64 durationMs = calculateDurationMs();
+    applySettings();
 
     // The minimum interval check is handled in calculateTotalMs() and AutoClicker::start()
 
-    if (clickCount <= 0 && durationMs <= 0) {
+    if (validateClicksInput() <= 0 && calculateDurationMs() <= 0) {
         updateStatus("Info: Clicking will continue until stopped");
     }
 
-    m_autoclicker.setInterval(intervalMs);
+    if (m_autoclicker.start()) {
+        m_isActive = true;
+        updateStatus("Autoclicking started successfully");
+        if (clickBut) {
+            clickBut->setText("Stop Clicking");
+            applyWidgetStyle(clickBut, m_stopButtonStyle);
+        }
+        return true;
+    } else {
+        updateStatus("Error: Failed to start autoclicker");
+        return false;
+    }
+}
+
+void MainContent::applySettings() {
+    const bool highRate = highRateCheckbox && highRateCheckbox->isChecked();
+    const int clickCount = validateClicksInput();
+    const qint64 durationMs = calculateDurationMs();
+
+    m_autoclicker.setHighRateMode(highRate);
+    m_autoclicker.setBurstMode(highRate && burstCheckbox && burstCheckbox->isChecked());
+    if (highRate) {
+        m_autoclicker.setIntervalMicroseconds(calculateTotalUs());
+    } else {
+        m_autoclicker.setInterval(calculateTotalMs());
+    }
     m_autoclicker.setClickCount(clickCount);
     m_autoclicker.setDuration(durationMs);
     m_autoclicker.setPosition(m_targetPos); // Passes (-1, -1) for dynamic mode
@@ -405,27 +856,46 @@ bool MainContent::startAutoclicker() {
     if (rightClickCheckbox) {
         m_autoclicker.setRightClick(rightClickCheckbox->isChecked());
     }
+    if (instantMoveCheckbox) {
+        m_autoclicker.setInstantMove(instantMoveCheckbox->isChecked());
+    }
+    if (pressKeyCheckbox && pressKeyCheckbox->isChecked()) {
+        m_autoclicker.setKeyPress(codeFromVirtualKey(m_pressKey.keyCode), keyModifiers(m_pressKey));
+    } else {
+        m_autoclicker.setKeyPress(0);
+    }
+    if (adaptiveCheckbox) {
+        m_autoclicker.setAdaptiveRate(adaptiveCheckbox->isChecked());
+    }
+    if (missPolicyBox) {
+        m_autoclicker.setMissPolicy(static_cast<ClickEngine::MissPolicy>(missPolicyBox->currentData().toInt()));
+    }
 
     // m_autoclicker.setUseDynamicPosition is set in setPositionFromInput/clearPosition
+}
 
-    if (m_autoclicker.start()) {
-        m_isActive = true;
-        updateStatus("Autoclicking started successfully");
-        if (clickBut) {
-            clickBut->setText("Stop Clicking");
-            applyWidgetStyle(clickBut, m_stopButtonStyle);
-        }
-        return true;
+void MainContent::applyLiveSettings() {
+    if (!m_isActive) {
+        return;
+    }
+    if (m_autoclicker.isJobMode()) {
+        updateStatus("Info: Queued jobs keep their settings until stopped");
+        return;
+    }
+
+    // No stop/restart: the engine swaps to the new settings at its next wake-up
+    applySettings();
+    if (m_autoclicker.reconfigure()) {
+        updateStatus("Settings applied while clicking");
     } else {
-        updateStatus("Error: Failed to start autoclicker");
-        return false;
+        updateStatus("Warning: Settings rejected, still clicking with the previous ones");
     }
 }
 
 void MainContent::stopAutoclicker() {
     m_autoclicker.stop();
     m_isActive = false;
-    updateStatus("Autoclicking stopped");
+    updateStatus("Autoclicking stopped" + rateSummary());
     setWindowTitle("FlameAutoclicker");
     if (clickBut) {
         clickBut->setText("Start Clicking");
@@ -483,15 +953,11 @@ void MainContent::setPositionFromInput() {
 
     // Turn dynamic mode OFF when a fixed position is set
     m_autoclicker.setUseDynamicPosition(false);
+    applyLiveSettings();
 }
 
 // NEW FUNCTION: Clears position and sets to dynamic mode
 void MainContent::clearPosition() {
-    if (m_autoclicker.isActive()) {
-        updateStatus("Warning: Cannot change position while running. Stop first.");
-        return;
-    }
-
     // Clear the visual input
     if (posInp) {
         posInp->clear();
@@ -503,6 +969,7 @@ void MainContent::clearPosition() {
     m_autoclicker.setUseDynamicPosition(true);
 
     updateStatus("Click position cleared. Using **Current Cursor Position** (Dynamic).");
+    applyLiveSettings();
 }
 
 void MainContent::pickPositionFromCursor() {
@@ -533,6 +1000,7 @@ void MainContent::pickPositionFromCursor() {
 
             updateStatus(QString("Position picked: %1, %2").arg(cursorPos.x()).arg(cursorPos.y()));
             qDebug() << "Position picked:" << m_targetPos;
+            applyLiveSettings();
         } else {
             updateStatus("Error: Invalid cursor position detected");
         }
@@ -560,17 +1028,67 @@ void MainContent::updateHotkey() {
 }
 
 void MainContent::onHotkeySaved(const Hotkey &hotkey) {
-    unregisterWindowsHotkey();
+    unregisterWindowsHotkey(HOTKEY_ID);
     m_currentHotkey = hotkey;
-    registerWindowsHotkey(hotkey);
+    registerWindowsHotkey(HOTKEY_ID, hotkey);
+
+    updateHotkeyHint();
+    updateStatus("Hotkey changed successfully");
+}
+
+void MainContent::updatePauseHotkey() {
+    HotkeySettingsWindow *settingsWindow = new HotkeySettingsWindow(this, HotkeyAction::PauseResume);
+    settingsWindow->setAttribute(Qt::WA_DeleteOnClose);
+    connect(settingsWindow, &HotkeySettingsWindow::hotkeySaved,
+            this, &MainContent::onPauseHotkeySaved);
+
+    settingsWindow->show();
+    settingsWindow->raise();
+    settingsWindow->activateWindow();
+}
+
+void MainContent::onPauseHotkeySaved(const Hotkey &hotkey) {
+    unregisterWindowsHotkey(PAUSE_HOTKEY_ID);
+    m_pauseHotkey = hotkey;
+    registerWindowsHotkey(PAUSE_HOTKEY_ID, hotkey);
+
+    updateHotkeyHint();
+    updateStatus("Pause hotkey changed successfully");
+}
+
+void MainContent::updatePressKey() {
+    HotkeySettingsWindow *settingsWindow = new HotkeySettingsWindow(this, HotkeyAction::AutoPress);
+    settingsWindow->setAttribute(Qt::WA_DeleteOnClose);
+    connect(settingsWindow, &HotkeySettingsWindow::hotkeySaved,
+            this, &MainContent::onPressKeySaved);
+
+    settingsWindow->show();
+    settingsWindow->raise();
+    settingsWindow->activateWindow();
+}
+
+void MainContent::onPressKeySaved(const Hotkey &hotkey) {
+    // An injected press of a registered hotkey would trigger it
+    if (sameHotkey(hotkey, m_currentHotkey) || sameHotkey(hotkey, m_pauseHotkey) || sameHotkey(hotkey, m_recordHotkey)) {
+        updateStatus("Warning: " + hotkeyString(hotkey) + " is a hotkey, pick another key to press");
+        return;
+    }
+    m_pressKey = hotkey;
+    if (pressKeyBut) pressKeyBut->setText(hotkeyString(hotkey));
+    updateStatus("Key to press set to " + hotkeyString(hotkey));
+    applyLiveSettings();
+}
 
+void MainContent::updateHotkeyHint() {
     if (press) {
-        press->setText("Press " + hotkeyString(m_currentHotkey) + " to start/stop clicking");
+        press->setText("Press " + hotkeyString(m_currentHotkey) + " to start/stop, "
+                       + hotkeyString(m_pauseHotkey) + " to pause/resume, "
+                       + hotkeyString(m_recordHotkey)
+                       + (m_autoclicker.canRecord() ? " to record or stop playback" : " to stop playback"));
     }
-    updateStatus("Hotkey changed successfully");
 }
 
-void MainContent::registerWindowsHotkey(const Hotkey &hotkey) {
+void MainContent::registerWindowsHotkey(int id, const Hotkey &hotkey) {
     HWND hwnd = reinterpret_cast<HWND>(this->winId());
 
     UINT modifiers = 0;
@@ -579,21 +1097,21 @@ void MainContent::registerWindowsHotkey(const Hotkey &hotkey) {
     if (hotkey.alt) modifiers |= MOD_ALT;
     if (hotkey.win) modifiers |= MOD_WIN;
 
-    if (RegisterHotKey(hwnd, HOTKEY_ID, modifiers, hotkey.keyCode)) {
-        m_hotkeyRegistered = true;
-        qDebug() << "Hotkey registered successfully";
+    if (RegisterHotKey(hwnd, id, modifiers, hotkey.keyCode)) {
+        hotkeyRegistered(id) = true;
+        qDebug() << "Hotkey" << id << "registered successfully";
     } else {
         qWarning() << "Failed to register hotkey. Error:" << GetLastError();
         updateStatus("Warning: Could not register hotkey (may be in use)");
     }
 }
 
-void MainContent::unregisterWindowsHotkey() {
-    if (m_hotkeyRegistered) {
+void MainContent::unregisterWindowsHotkey(int id) {
+    if (hotkeyRegistered(id)) {
         HWND hwnd = reinterpret_cast<HWND>(this->winId());
-        if (UnregisterHotKey(hwnd, HOTKEY_ID)) {
-            m_hotkeyRegistered = false;
-            qDebug() << "Hotkey unregistered successfully";
+        if (UnregisterHotKey(hwnd, id)) {
+            hotkeyRegistered(id) = false;
+            qDebug() << "Hotkey" << id << "unregistered successfully";
         } else {
             qWarning() << "Failed to unregister hotkey. Error:" << GetLastError();
         }
@@ -622,6 +1140,117 @@ qint64 MainContent::calculateTotalMs() const {
     return totalMs;
 }
 
+// High-rate mode: the last field holds microseconds instead of milliseconds
+qint64 MainContent::calculateTotalUs() const {
+    qint64 totalUs = 0;
+    if (hours) totalUs += hours->text().toLongLong() * 3600 * 1000 * 1000;
+    if (mins) totalUs += mins->text().toLongLong() * 60 * 1000 * 1000;
+    if (secs) totalUs += secs->text().toLongLong() * 1000 * 1000;
+    if (ms) totalUs += ms->text().toLongLong();
+    return totalUs; // AutoClicker::setIntervalMicroseconds applies the floor
+}
+
+QString MainContent::rateSummary() const {
+    if (!m_autoclicker.isHighRateMode()) {
+        return QString();
+    }
+    return QString(" (%1 CPS, spin CPU %2%)")
+        .arg(m_autoclicker.achievedRate(), 0, 'f', 0)
+        .arg(m_autoclicker.spinCpuUsage() * 100.0, 0, 'f', 1);
+}
+
+void MainContent::setProgressTracking(bool enabled) {
+    if (!m_progressTimer) return;
+
+    if (enabled) {
+        m_progressTimer->start();
+    } else {
+        m_progressTimer->stop();
+    }
+    // One last sample so the label shows the final figures
+    refreshProgress();
+}
+
+void MainContent::refreshProgress() {
+    if (!progress) return;
+
+    if (m_autoclicker.isRecording()) {
+        progress->setText(QString("Recording: %1 events").arg(m_autoclicker.recordedEvents()));
+        return;
+    }
+    if (m_autoclicker.isPlaying()) {
+        progress->setText(QString("Playing: %1 events | %2 loop(s) done")
+                              .arg(m_autoclicker.eventsPlayed())
+                              .arg(m_autoclicker.loopsPlayed()));
+        return;
+    }
+
+    const AutoClicker::Progress live = m_autoclicker.sampleProgress();
+
+    QStringList parts;
+    parts << QString("%1 CPS").arg(live.clicksPerSecond, 0, 'f', live.clicksPerSecond < 10.0 ? 1 : 0);
+    parts << QString("%1 clicks").arg(live.clicks);
+    if (live.remainingClicks >= 0) {
+        parts << QString("%1 left").arg(live.remainingClicks);
+    }
+    if (live.rateFactor < 0.995) {
+        parts << QString("slowed to %1%").arg(qRound(live.rateFactor * 100.0));
+    }
+    if (live.missedDeadlines > 0) {
+        parts << QString("%1 late").arg(live.missedDeadlines);
+    }
+    if (live.remainingMs >= 0) {
+        const qint64 seconds = (live.remainingMs + 999) / 1000;
+        parts << QString("%1:%2:%3 left")
+                     .arg(seconds / 3600)
+                     .arg(seconds / 60 % 60, 2, 10, QChar('0'))
+                     .arg(seconds % 60, 2, 10, QChar('0'));
+    }
+    progress->setText(parts.join(" | "));
+
+    const AutoClicker::Latency& latency = m_autoclicker.latency();
+    progress->setToolTip(QString("Wake lateness: %1\nInjection: %2\nStart to first click: %3\nStop to last click: %4")
+                             .arg(QString::fromStdString(latency.wakeLateness.summary()),
+                                  QString::fromStdString(latency.injection.summary()),
+                                  QString::fromStdString(latency.startToFirst.summary()),
+                                  QString::fromStdString(latency.stopToLast.summary())));
+}
+
+void MainContent::onHighRateToggled(bool enabled) {
+    if (!ms) return;
+
+    // Bursts only exist for microsecond intervals
+    if (!enabled && burstCheckbox && burstCheckbox->isChecked()) {
+        burstCheckbox->setChecked(false);
+    }
+
+    // Reuse the milliseconds field for microseconds so the layout stays the same
+    if (enabled) {
+        ms->setValidator(new QIntValidator(0, 999999, this));
+        setWidgetPlaceholder(ms, "Microseconds");
+        ms->setText(QString::number(ms->text().toLongLong() * 1000));
+        updateStatus("High-rate mode: interval in microseconds (min 100us)");
+    } else {
+        ms->setValidator(new QIntValidator(0, 999, this));
+        setWidgetPlaceholder(ms, "Milliseconds");
+        ms->setText(QString::number(qMin<qint64>(ms->text().toLongLong() / 1000, 999)));
+        updateStatus("High-rate mode disabled");
+    }
+}
+
+void MainContent::onBurstToggled(bool enabled) {
+    if (!enabled) {
+        updateStatus("Burst mode disabled");
+        return;
+    }
+
+    // Bursts are a high-rate feature: the interval field switches to microseconds
+    if (highRateCheckbox && !highRateCheckbox->isChecked()) {
+        highRateCheckbox->setChecked(true);
+    }
+    updateStatus("Burst mode: intervals below 1 ms are sent in 1 ms batches (min 1us)");
+}
+
 qint64 MainContent::calculateDurationMs() const {
     qint64 totalMs = 0;
     if (durationHours) totalMs += durationHours->text().toLongLong() * 3600 * 1000;
@@ -679,11 +1308,7 @@ void MainContent::setWidgetCursor(QWidget* widget, Qt::CursorShape cursor) {
     }
 }
 
-// MODIFIED: Use virtualGeometry to check against all monitors (multi-monitor support)
+// Same cached virtual desktop the click engine validates against (multi-monitor support)
 bool MainContent::isPositionValid(const QPoint& pos) const {
-    QScreen* screen = QApplication::primaryScreen();
-    if (!screen) return false;
-
-    // Use virtualGeometry() which spans all connected screens
-    return QApplication::primaryScreen()->virtualGeometry().contains(pos);
+    return DisplayTopology::instance()->contains(pos);
 }
@@ -10,7 +10,9 @@
 class QLineEdit;
 class QPushButton;
 class QCheckBox;
+class QComboBox;
 class QLabel;
+class QTimer;
 
 class MainContent : public QWidget {
     Q_OBJECT
@@ -29,8 +31,26 @@ private slots:
     void setPositionFromInput();
     void pickPositionFromCursor();
     void clearPosition();
+    void onHighRateToggled(bool enabled);
+    void onBurstToggled(bool enabled);
     void updateHotkey();
     void onHotkeySaved(const Hotkey &hotkey);
+    void updatePauseHotkey();
+    void onPauseHotkeySaved(const Hotkey &hotkey);
+    void updatePressKey();
+    void onPressKeySaved(const Hotkey &hotkey);
+    void togglePause();
+    void addJob();
+    void clearJobs();
+    // fromClick: stopped by the Record button, whose click is not part of the macro
+    void toggleRecording(bool fromClick = false);
+    void togglePlayback();
+    void saveMacro();
+    void openMacro();
+    void importTimeline();
+    void refreshProgress();
+    // Pushes the current form to a running autoclicker; no-op while stopped
+    void applyLiveSettings();
 
 private:
     // Helper functions
@@ -40,14 +60,26 @@ private:
     void setupValidators();
 
     qint64 calculateTotalMs() const;
+    qint64 calculateTotalUs() const;
+    QString rateSummary() const;
     qint64 calculateDurationMs() const;
     int validateClicksInput() const;
     void updateStatus(const QString& message);
     void updateStatus(const QString& message, const QColor& color);
+    void setProgressTracking(bool enabled);
+    // Copies the form into m_autoclicker
+    void applySettings();
     bool startAutoclicker();
     void stopAutoclicker();
-    void registerWindowsHotkey(const Hotkey &hotkey);
-    void unregisterWindowsHotkey();
+    void registerWindowsHotkey(int id, const Hotkey &hotkey);
+    void unregisterWindowsHotkey(int id);
+    bool& hotkeyRegistered(int id) {
+        return id == PAUSE_HOTKEY_ID ? m_pauseHotkeyRegistered
+             : id == RECORD_HOTKEY_ID ? m_recordHotkeyRegistered : m_hotkeyRegistered;
+    }
+    void updateHotkeyHint();
+    void updateJobsLabel();
+    void updateMacroLabel();
     bool isPositionValid(const QPoint& pos) const;
 
     // Widget helpers
@@ -65,37 +97,71 @@ private:
     QLineEdit* durationHours = nullptr;
     QLineEdit* durationMins = nullptr;
     QLineEdit* durationSecs = nullptr;
+    QLineEdit* loopsInp = nullptr;
 
     QPushButton* clickBut = nullptr;
     QPushButton* hotkeyBut = nullptr;
+    QPushButton* pauseHotkeyBut = nullptr;
     QPushButton* posSet = nullptr;
     QPushButton* posPick = nullptr;
     QPushButton* posClear = nullptr;
+    QPushButton* addJobBut = nullptr;
+    QPushButton* clearJobsBut = nullptr;
+    QPushButton* recordBut = nullptr;
+    QPushButton* playBut = nullptr;
+    QPushButton* saveMacroBut = nullptr;
+    QPushButton* openMacroBut = nullptr;
+    QPushButton* importBut = nullptr;
+    QPushButton* pressKeyBut = nullptr;
 
     QCheckBox* doubleClickCheckbox = nullptr;
     QLabel* doubleClickLabel = nullptr;
     QCheckBox* rightClickCheckbox = nullptr;
     QLabel* rightClickLabel = nullptr;
+    QCheckBox* highRateCheckbox = nullptr;
+    QLabel* highRateLabel = nullptr;
+    QCheckBox* instantMoveCheckbox = nullptr;
+    QLabel* instantMoveLabel = nullptr;
+    QCheckBox* burstCheckbox = nullptr;
+    QLabel* burstLabel = nullptr;
+    QCheckBox* pressKeyCheckbox = nullptr;
+    QLabel* pressKeyLabel = nullptr;
+    QCheckBox* adaptiveCheckbox = nullptr;
+    QLabel* adaptiveLabel = nullptr;
+    QComboBox* missPolicyBox = nullptr;
+    QComboBox* speedBox = nullptr;
+    QLabel* missPolicyLab = nullptr;
 
     QLabel* status = nullptr;
+    QLabel* progress = nullptr;
     QLabel* interval = nullptr;
     QLabel* clicksLab = nullptr;
     QLabel* press = nullptr;
     QLabel* posLab = nullptr;
     QLabel* durationLab = nullptr;
+    QLabel* jobsLab = nullptr;
+    QLabel* macroLab = nullptr;
 
     // Business logic
     AutoClicker m_autoclicker;
+    QTimer* m_progressTimer = nullptr;
     QPoint m_targetPos;
     Hotkey m_currentHotkey;
+    Hotkey m_pauseHotkey;
+    Hotkey m_recordHotkey;
+    Hotkey m_pressKey; // chord sent by key press mode
     bool m_isActive = false;
     bool m_hotkeyRegistered = false;
+    bool m_pauseHotkeyRegistered = false;
+    bool m_recordHotkeyRegistered = false;
 
     // Style strings for the main button
     QString m_startButtonStyle;
     QString m_stopButtonStyle;
 
     static constexpr int HOTKEY_ID = 1;
+    static constexpr int PAUSE_HOTKEY_ID = 2;
+    static constexpr int RECORD_HOTKEY_ID = 3;
 };
 
 #endif // CONTENT_H
@@ -0,0 +1,77 @@
+#ifndef DISPLAYCACHE_H
+#define DISPLAYCACHE_H
+
+#include "InputBackend.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+struct MonitorInfo {
+    ScreenRect rect;        // native pixels, the space input injection works in
+    double dpiScale = 1.0;  // native pixels per logical pixel
+    bool primary = false;
+};
+
+// Cached display layout, written by DisplayTopology on the GUI thread when
+// screens change and read from any thread. The virtual desktop bounds sit
+// behind a sequence lock, so the click hot path reads them with a few plain
+// loads and never takes a lock or asks the OS.
+class DisplayCache {
+public:
+    void publish(const ScreenRect& desktop, const std::vector<MonitorInfo>& monitors) {
+        {
+            std::lock_guard<std::mutex> lock(m_monitorMutex);
+            m_monitors = monitors;
+        }
+
+        // Single writer: odd sequence marks an update in progress
+        const uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_x.store(desktop.x, std::memory_order_relaxed);
+        m_y.store(desktop.y, std::memory_order_relaxed);
+        m_width.store(desktop.width, std::memory_order_relaxed);
+        m_height.store(desktop.height, std::memory_order_relaxed);
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    ScreenRect virtualDesktop() const {
+        ScreenRect rect;
+        uint32_t before, after;
+        do {
+            before = m_sequence.load(std::memory_order_acquire);
+            rect.x = m_x.load(std::memory_order_relaxed);
+            rect.y = m_y.load(std::memory_order_relaxed);
+            rect.width = m_width.load(std::memory_order_relaxed);
+            rect.height = m_height.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_sequence.load(std::memory_order_relaxed);
+        } while (before != after || (before & 1u));
+        return rect;
+    }
+
+    bool contains(int x, int y) const { return virtualDesktop().contains(x, y); }
+    bool isValid() const { return m_sequence.load(std::memory_order_acquire) != 0; }
+
+    // Changes every time a new layout is published
+    uint32_t generation() const { return m_sequence.load(std::memory_order_acquire) / 2; }
+
+    std::vector<MonitorInfo> monitors() const {
+        std::lock_guard<std::mutex> lock(m_monitorMutex);
+        return m_monitors;
+    }
+
+private:
+    std::atomic<uint32_t> m_sequence{0};
+    std::atomic<int> m_x{0};
+    std::atomic<int> m_y{0};
+    std::atomic<int> m_width{0};
+    std::atomic<int> m_height{0};
+
+    mutable std::mutex m_monitorMutex;
+    std::vector<MonitorInfo> m_monitors;
+};
+
+#endif // DISPLAYCACHE_H
@@ -0,0 +1,68 @@
+#include "DisplayTopology.h"
+
+#include <QDebug>
+#include <QGuiApplication>
+#include <QScreen>
+
+#include <algorithm>
+#include <cmath>
+
+DisplayTopology* DisplayTopology::instance() {
+    static DisplayTopology* topology = new DisplayTopology(QGuiApplication::instance());
+    return topology;
+}
+
+DisplayTopology::DisplayTopology(QObject* parent) : QObject(parent) {
+    connect(qApp, &QGuiApplication::screenAdded, this, [this](QScreen* screen) {
+        watchScreen(screen);
+        refresh();
+    });
+    connect(qApp, &QGuiApplication::screenRemoved, this, &DisplayTopology::refresh);
+    connect(qApp, &QGuiApplication::primaryScreenChanged, this, &DisplayTopology::refresh);
+
+    for (QScreen* screen : QGuiApplication::screens()) {
+        watchScreen(screen);
+    }
+    refresh();
+}
+
+void DisplayTopology::watchScreen(QScreen* screen) {
+    connect(screen, &QScreen::geometryChanged, this, &DisplayTopology::refresh);
+    connect(screen, &QScreen::logicalDotsPerInchChanged, this, &DisplayTopology::refresh);
+}
+
+void DisplayTopology::refresh() {
+    std::vector<MonitorInfo> monitors;
+    const QScreen* primary = QGuiApplication::primaryScreen();
+
+    int left = 0, top = 0, right = 0, bottom = 0;
+    bool first = true;
+
+    for (QScreen* screen : QGuiApplication::screens()) {
+        // Qt keeps a screen's native origin and scales its size by the DPI factor
+        const QRect logical = screen->geometry();
+        const double scale = screen->devicePixelRatio();
+
+        MonitorInfo monitor;
+        monitor.rect = {logical.x(), logical.y(),
+                        static_cast<int>(std::lround(logical.width() * scale)),
+                        static_cast<int>(std::lround(logical.height() * scale))};
+        monitor.dpiScale = scale;
+        monitor.primary = (screen == primary);
+        monitors.push_back(monitor);
+
+        const ScreenRect& r = monitor.rect;
+        left = first ? r.x : std::min(left, r.x);
+        top = first ? r.y : std::min(top, r.y);
+        right = first ? r.x + r.width : std::max(right, r.x + r.width);
+        bottom = first ? r.y + r.height : std::max(bottom, r.y + r.height);
+        first = false;
+    }
+
+    const ScreenRect desktop{left, top, right - left, bottom - top};
+    m_cache.publish(desktop, monitors);
+
+    qDebug() << "Display topology:" << monitors.size() << "monitor(s), virtual desktop"
+             << desktop.x << desktop.y << desktop.width << "x" << desktop.height;
+    emit changed();
+}
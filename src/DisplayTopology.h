@@ -0,0 +1,36 @@
+#ifndef DISPLAYTOPOLOGY_H
+#define DISPLAYTOPOLOGY_H
+
+#include <QObject>
+#include <QPoint>
+
+#include "DisplayCache.h"
+
+class QScreen;
+
+// Keeps the shared DisplayCache in sync with Qt's screen list. Refreshes only
+// on screen add/remove and geometry or DPI changes, never on demand.
+class DisplayTopology : public QObject {
+    Q_OBJECT
+
+public:
+    // Created on first use; lives until the application quits
+    static DisplayTopology* instance();
+
+    const DisplayCache& cache() const { return m_cache; }
+
+    bool contains(const QPoint& pos) const { return m_cache.contains(pos.x(), pos.y()); }
+
+signals:
+    void changed();
+
+private:
+    explicit DisplayTopology(QObject* parent = nullptr);
+
+    void watchScreen(QScreen* screen);
+    void refresh();
+
+    DisplayCache m_cache;
+};
+
+#endif // DISPLAYTOPOLOGY_H
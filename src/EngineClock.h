@@ -0,0 +1,59 @@
+#ifndef ENGINECLOCK_H
+#define ENGINECLOCK_H
+
+#include <atomic>
+#include <chrono>
+
+// Time source of the click engine. The steady clock is the default;
+// simulations substitute VirtualClock, whose waits complete instantly.
+class EngineClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~EngineClock() = default;
+
+    virtual Clock::time_point now() const = 0;
+
+    // Called before the engine sleeps until deadline. Returning true means the
+    // clock itself has reached the deadline and no real wait is needed.
+    virtual bool advanceTo(Clock::time_point deadline) = 0;
+};
+
+class SteadyEngineClock : public EngineClock {
+public:
+    Clock::time_point now() const override { return Clock::now(); }
+    bool advanceTo(Clock::time_point) override { return false; }
+
+    // Shared default instance; stateless, so safe for every engine
+    static SteadyEngineClock* instance() {
+        static SteadyEngineClock clock;
+        return &clock;
+    }
+};
+
+// Deterministic clock: time only moves when the engine waits or advance() is called.
+// A 24 hour run at 5 ms therefore takes as long as the clicks themselves.
+class VirtualClock : public EngineClock {
+public:
+    explicit VirtualClock(Clock::time_point start = Clock::time_point(std::chrono::hours(1)))
+        : m_now(start.time_since_epoch().count()) {}
+
+    Clock::time_point now() const override {
+        return Clock::time_point(Clock::duration(m_now.load(std::memory_order_acquire)));
+    }
+
+    bool advanceTo(Clock::time_point deadline) override {
+        const Clock::rep target = deadline.time_since_epoch().count();
+        Clock::rep current = m_now.load(std::memory_order_relaxed);
+        while (current < target && !m_now.compare_exchange_weak(current, target, std::memory_order_acq_rel)) {
+        }
+        return true;
+    }
+
+    void advance(Clock::duration step) { m_now.fetch_add(step.count(), std::memory_order_acq_rel); }
+
+private:
+    std::atomic<Clock::rep> m_now;
+};
+
+#endif // ENGINECLOCK_H
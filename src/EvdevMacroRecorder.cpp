@@ -0,0 +1,315 @@
+#include "EvdevMacroRecorder.h"
+#include "RingLogger.h"
+#include "UInputBackend.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+constexpr size_t ReadBlock = 64; // input_events per read()
+
+template <size_t Bytes>
+bool testBit(const uint8_t (&bits)[Bytes], int bit) {
+    return (bits[bit / 8] >> (bit % 8)) & 1;
+}
+
+int64_t monotonicNowUs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+bool isMouseButton(int code) {
+    return code >= BTN_MOUSE && code < BTN_JOYSTICK;
+}
+
+bool isKey(int code) {
+    // Skips joystick, gamepad and digitizer tool codes between the two ranges
+    return code < BTN_MISC || (code >= KEY_OK && code < BTN_DPAD_UP);
+}
+
+int32_t scaleAxis(int value, const input_absinfo& info, int origin, int extent) {
+    const int64_t range = std::max(1, info.maximum - info.minimum);
+    const int64_t offset = std::clamp(value, info.minimum, info.maximum) - info.minimum;
+    return static_cast<int32_t>(origin + offset * (extent - 1) / range);
+}
+} // namespace
+
+EvdevMacroRecorder::~EvdevMacroRecorder() {
+    stop();
+}
+
+bool EvdevMacroRecorder::openDevices() {
+    DIR* dir = opendir("/dev/input");
+    if (!dir) {
+        m_lastError = std::string("Cannot list /dev/input: ") + std::strerror(errno);
+        return false;
+    }
+
+    int denied = 0;
+    while (dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, "event", 5) != 0) {
+            continue;
+        }
+        const std::string path = std::string("/dev/input/") + entry->d_name;
+        const int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            denied += errno == EACCES;
+            continue;
+        }
+
+        // Our own injections would be recorded twice
+        char name[256] = {};
+        ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name);
+        if (std::strcmp(name, UInputBackend::DeviceName) == 0) {
+            ::close(fd);
+            continue;
+        }
+
+        uint8_t keyBits[KEY_MAX / 8 + 1] = {};
+        uint8_t relBits[REL_MAX / 8 + 1] = {};
+        uint8_t absBits[ABS_MAX / 8 + 1] = {};
+        uint8_t propBits[INPUT_PROP_MAX / 8 + 1] = {};
+        ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits);
+        ioctl(fd, EVIOCGBIT(EV_REL, sizeof(relBits)), relBits);
+        ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(absBits)), absBits);
+        ioctl(fd, EVIOCGPROP(sizeof(propBits)), propBits);
+
+        Device device;
+        device.fd = fd;
+        const bool relative = testBit(relBits, REL_X) && testBit(relBits, REL_Y);
+        // Touchpads report absolute finger positions, not screen positions
+        device.absolute = testBit(absBits, ABS_X) && testBit(absBits, ABS_Y) && !testBit(propBits, INPUT_PROP_POINTER);
+        const bool buttons = testBit(keyBits, BTN_LEFT);
+        const bool keys = testBit(keyBits, KEY_ESC) || testBit(keyBits, KEY_A) || testBit(keyBits, KEY_ENTER);
+        if (device.absolute) {
+            device.absolute = ioctl(fd, EVIOCGABS(ABS_X), &device.absX) == 0
+                           && ioctl(fd, EVIOCGABS(ABS_Y), &device.absY) == 0;
+        }
+        if (!relative && !device.absolute && !buttons && !keys) {
+            ::close(fd);
+            continue;
+        }
+
+        int clock = CLOCK_MONOTONIC;
+        device.kernelTime = ioctl(fd, EVIOCSCLOCKID, &clock) == 0;
+        m_devices.push_back(device);
+    }
+    closedir(dir);
+
+    if (m_devices.empty()) {
+        m_lastError = denied > 0 ? "No permission to read /dev/input (add the user to the \"input\" group)"
+                                 : "No mouse or keyboard found in /dev/input";
+        return false;
+    }
+    return true;
+}
+
+void EvdevMacroRecorder::closeDevices() {
+    for (const Device& device : m_devices) {
+        ::close(device.fd);
+    }
+    m_devices.clear();
+    if (m_wakeFd >= 0) {
+        ::close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+}
+
+bool EvdevMacroRecorder::start(MacroBuffer& buffer) {
+    if (isRecording()) {
+        m_lastError = "Already recording";
+        return false;
+    }
+    if (!openDevices()) {
+        closeDevices();
+        return false;
+    }
+    return startReading(buffer);
+}
+
+bool EvdevMacroRecorder::startOn(MacroBuffer& buffer, int fd) {
+    if (isRecording()) {
+        m_lastError = "Already recording";
+        ::close(fd);
+        return false;
+    }
+    Device device;
+    device.fd = fd;
+    m_devices.push_back(device);
+    return startReading(buffer);
+}
+
+bool EvdevMacroRecorder::startReading(MacroBuffer& buffer) {
+    m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_wakeFd < 0) {
+        m_lastError = std::string("Cannot create eventfd: ") + std::strerror(errno);
+        closeDevices();
+        return false;
+    }
+
+    m_buffer = &buffer;
+    m_buffer->clear();
+    m_held.reset();
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_startUs = monotonicNowUs();
+    m_thread = std::thread(&EvdevMacroRecorder::run, this);
+    return true;
+}
+
+void EvdevMacroRecorder::stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    const uint64_t wake = 1;
+    if (::write(m_wakeFd, &wake, sizeof(wake)) != sizeof(wake)) {
+        FLAME_LOG(Warning, "Macro recorder wake-up failed (errno %lld)", static_cast<long long>(errno));
+    }
+    m_thread.join();
+    closeDevices();
+
+    dropUnreleasedPresses(*m_buffer, m_held);
+    m_buffer = nullptr;
+}
+
+int64_t EvdevMacroRecorder::timeOf(const Device& device, const input_event& event) const {
+    const int64_t time = device.kernelTime
+        ? static_cast<int64_t>(event.input_event_sec) * 1000000 + event.input_event_usec
+        : monotonicNowUs();
+    // Anything queued before start() counts as the first instant
+    return std::max<int64_t>(0, time - m_startUs);
+}
+
+void EvdevMacroRecorder::run() {
+    std::vector<pollfd> fds;
+    fds.reserve(m_devices.size() + 1);
+    fds.push_back({m_wakeFd, POLLIN, 0});
+    for (const Device& device : m_devices) {
+        fds.push_back({device.fd, POLLIN, 0});
+    }
+
+    input_event events[ReadBlock];
+    for (;;) {
+        if (poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            FLAME_LOG(Warning, "Macro recorder poll failed (errno %lld)", static_cast<long long>(errno));
+            break;
+        }
+        if (fds[0].revents != 0) {
+            break;
+        }
+
+        for (size_t i = 1; i < fds.size(); ++i) {
+            if (fds[i].revents & POLLIN) {
+                Device& device = m_devices[i - 1];
+                for (;;) {
+                    const ssize_t bytes = ::read(device.fd, events, sizeof(events));
+                    if (bytes <= 0) {
+                        break;
+                    }
+                    const size_t count = static_cast<size_t>(bytes) / sizeof(input_event);
+                    for (size_t e = 0; e < count; ++e) {
+                        handle(device, events[e]);
+                    }
+                    if (count < ReadBlock) {
+                        break;
+                    }
+                }
+            }
+            // Unplugged; poll() skips negative descriptors
+            if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                fds[i].fd = -1;
+            }
+        }
+    }
+}
+
+void EvdevMacroRecorder::handle(Device& device, const input_event& event) {
+    switch (event.type) {
+    case EV_SYN:
+        if (event.code == SYN_DROPPED) {
+            // The kernel queue overflowed; discard until the next full frame
+            device.dropping = true;
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        } else if (event.code == SYN_REPORT) {
+            if (device.dropping) {
+                device.dropping = false;
+                device.dx = device.dy = device.wheelX = device.wheelY = 0;
+                device.moved = false;
+            } else {
+                flushMotion(device, timeOf(device, event));
+            }
+        }
+        break;
+    case EV_REL:
+        if (event.code == REL_X) {
+            device.dx += event.value;
+        } else if (event.code == REL_Y) {
+            device.dy += event.value;
+        } else if (event.code == REL_WHEEL) {
+            device.wheelY += event.value;
+        } else if (event.code == REL_HWHEEL) {
+            device.wheelX += event.value;
+        }
+        break;
+    case EV_ABS:
+        if (device.absolute && event.code == ABS_X) {
+            device.x = scaleAxis(event.value, device.absX, m_screen.x, m_screen.width);
+            device.moved = true;
+        } else if (device.absolute && event.code == ABS_Y) {
+            device.y = scaleAxis(event.value, device.absY, m_screen.y, m_screen.height);
+            device.moved = true;
+        }
+        break;
+    case EV_KEY: {
+        const int code = event.code;
+        const bool button = isMouseButton(code);
+        // Auto-repeat (value 2) is the OS's business, not part of the macro
+        if (device.dropping || event.value == 2 || (!button && !isKey(code))) {
+            break;
+        }
+        const bool pressed = event.value == 1;
+        // A release of something pressed before recording started (e.g. the start hotkey)
+        if (!pressed && !m_held.test(code)) {
+            break;
+        }
+        // Motion earlier in the frame happened first
+        const int64_t timeUs = timeOf(device, event);
+        flushMotion(device, timeUs);
+        m_held.set(code, pressed);
+        using Type = MacroEvent::Type;
+        const Type type = button ? (pressed ? Type::ButtonDown : Type::ButtonUp) : (pressed ? Type::KeyDown : Type::KeyUp);
+        m_buffer->append(timeUs, type, static_cast<uint16_t>(code), 0, 0);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void EvdevMacroRecorder::flushMotion(Device& device, int64_t timeUs) {
+    if (device.moved) {
+        m_buffer->append(timeUs, MacroEvent::Type::MoveAbsolute, 0, device.x, device.y);
+        device.moved = false;
+    }
+    if (device.dx != 0 || device.dy != 0) {
+        m_buffer->append(timeUs, MacroEvent::Type::Move, 0, device.dx, device.dy);
+        device.dx = device.dy = 0;
+    }
+    if (device.wheelX != 0 || device.wheelY != 0) {
+        m_buffer->append(timeUs, MacroEvent::Type::Wheel, 0, device.wheelX, device.wheelY);
+        device.wheelX = device.wheelY = 0;
+    }
+}
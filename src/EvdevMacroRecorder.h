@@ -0,0 +1,69 @@
+#ifndef EVDEVMACRORECORDER_H
+#define EVDEVMACRORECORDER_H
+
+#include "MacroRecorder.h"
+
+#include <linux/input.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Records from every readable /dev/input/event* mouse, keyboard, touch screen
+// and tablet; needs read access to the devices (usually the "input" group).
+// Events are read in blocks straight from the kernel, stamped with its
+// CLOCK_MONOTONIC time, and motion is merged per SYN_REPORT frame, so one
+// append per frame and none per axis. The autoclicker's own uinput device is
+// skipped, and so is touchpad motion, which only becomes pointer motion in
+// userspace (libinput); touchpad buttons are still recorded.
+class EvdevMacroRecorder : public MacroRecorder {
+public:
+    EvdevMacroRecorder() = default;
+    ~EvdevMacroRecorder() override;
+
+    const char* name() const override { return "evdev"; }
+    bool start(MacroBuffer& buffer) override;
+    // Records from one already open, non-blocking stream of input_events
+    // instead of /dev/input, e.g. a pipe; the recorder closes fd on stop()
+    bool startOn(MacroBuffer& buffer, int fd);
+    void stop() override;
+    bool isRecording() const override { return m_thread.joinable(); }
+
+    // Frames the kernel dropped because its queue overflowed (SYN_DROPPED)
+    int64_t droppedFrames() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Device {
+        int fd = -1;
+        bool absolute = false; // ABS_X/ABS_Y map onto the screen
+        bool dropping = false; // inside a SYN_DROPPED gap
+        bool kernelTime = true; // event times are CLOCK_MONOTONIC
+        input_absinfo absX{};
+        input_absinfo absY{};
+        // Motion of the current frame, flushed on SYN_REPORT or a key
+        int32_t dx = 0;
+        int32_t dy = 0;
+        int32_t wheelX = 0;
+        int32_t wheelY = 0;
+        int32_t x = 0;
+        int32_t y = 0;
+        bool moved = false;
+    };
+
+    bool openDevices();
+    void closeDevices();
+    bool startReading(MacroBuffer& buffer);
+    void run();
+    void handle(Device& device, const input_event& event);
+    void flushMotion(Device& device, int64_t timeUs);
+    int64_t timeOf(const Device& device, const input_event& event) const;
+
+    std::vector<Device> m_devices;
+    int m_wakeFd = -1; // eventfd that interrupts poll() on stop()
+    MacroBuffer* m_buffer = nullptr;
+    int64_t m_startUs = 0;
+    HeldCodes m_held; // pressed during the recording
+    std::thread m_thread;
+    std::atomic<int64_t> m_dropped{0};
+};
+
+#endif // EVDEVMACRORECORDER_H
@@ -0,0 +1,106 @@
+#include "InputBackend.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include "Win32InputBackend.h"
+#elif defined(__linux__)
+#include "UInputBackend.h"
+#ifdef FLAME_HAVE_XTEST
+#include "XTestInputBackend.h"
+#endif
+#endif
+
+namespace {
+// Fallback for backends without a native wire format
+class GenericPreparedBatch : public PreparedBatch {
+public:
+    explicit GenericPreparedBatch(const InputBatch& batch) : m_batch(batch) { m_size = batch.size(); }
+
+    void setMoveTarget(int index, int x, int y) override { m_batch.setMoveTarget(index, x, y); }
+    const InputBatch& batch() const { return m_batch; }
+
+private:
+    InputBatch m_batch;
+};
+} // namespace
+
+std::unique_ptr<PreparedBatch> InputBackend::prepare(const InputBatch& batch) {
+    return std::make_unique<GenericPreparedBatch>(batch);
+}
+
+int InputBackend::submitPrepared(PreparedBatch& batch) {
+    return submit(static_cast<GenericPreparedBatch&>(batch).batch());
+}
+
+void HeldInputs::track(const InputBatch& batch, int sent) {
+    using Type = InputEvent::Type;
+    const int count = std::min(sent, batch.size());
+    for (int i = 0; i < count; ++i) {
+        const InputEvent& event = batch.events()[i];
+        const bool button = event.type == Type::ButtonDown || event.type == Type::ButtonUp;
+        const bool key = event.type == Type::KeyDown || event.type == Type::KeyUp;
+        if (!button && !key) {
+            continue;
+        }
+        const auto held = std::find_if(m_presses.begin(), m_presses.end(), [&](const InputEvent& press) {
+            return button ? press.type == Type::ButtonDown && press.button == event.button
+                          : press.type == Type::KeyDown && press.key == event.key;
+        });
+        // A second press of something held keeps its place in the order
+        if (event.type == Type::ButtonDown || event.type == Type::KeyDown) {
+            if (held == m_presses.end()) {
+                m_presses.push_back(event);
+            }
+        } else if (held != m_presses.end()) {
+            m_presses.erase(held);
+        }
+    }
+}
+
+void HeldInputs::releaseInto(InputBatch& batch) {
+    for (auto press = m_presses.rbegin(); press != m_presses.rend(); ++press) {
+        if (press->type == InputEvent::Type::ButtonDown) {
+            batch.buttonUp(press->button);
+        } else {
+            batch.keyUp(press->key);
+        }
+    }
+    m_presses.clear();
+}
+
+#if defined(__linux__) && defined(FLAME_HAVE_XTEST)
+namespace {
+bool wantsXTest() {
+    const char* choice = std::getenv("FLAME_INPUT_BACKEND");
+    if (choice && *choice) {
+        return std::strcmp(choice, "xtest") == 0;
+    }
+    const char* display = std::getenv("DISPLAY");
+    return display && *display;
+}
+} // namespace
+#endif
+
+std::unique_ptr<InputBackend> createDefaultInputBackend(const ScreenRect& desktop) {
+#ifdef _WIN32
+    (void)desktop;
+    return std::make_unique<Win32InputBackend>();
+#elif defined(__linux__)
+#ifdef FLAME_HAVE_XTEST
+    if (wantsXTest()) {
+        return std::make_unique<XTestInputBackend>();
+    }
+#endif
+    auto backend = std::make_unique<UInputBackend>();
+    if (desktop.width > 0 && desktop.height > 0) {
+        backend->setScreenGeometry(desktop);
+    }
+    return backend;
+#else
+    (void)desktop;
+    return nullptr;
+#endif
+}
@@ -0,0 +1,162 @@
+#ifndef INPUTBACKEND_H
+#define INPUTBACKEND_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class DisplayCache;
+
+enum class MouseButton : uint8_t {
+    Left,
+    Right,
+    Middle,
+    Back,
+    Forward
+};
+
+// One synthetic input action. Coordinates are virtual desktop pixels.
+struct InputEvent {
+    enum class Type : uint8_t {
+        MoveAbsolute,
+        ButtonDown,
+        ButtonUp,
+        MoveRelative, // x, y: motion in mouse counts, subject to pointer acceleration
+        Wheel,        // y: vertical detents (up is positive), or x: horizontal ones when y is 0
+        KeyDown,
+        KeyUp
+    };
+
+    Type type = Type::ButtonDown;
+    MouseButton button = MouseButton::Left;
+    uint16_t key = 0; // KeyDown/KeyUp: Linux input event code, see InputCodes.h
+    int32_t x = 0;
+    int32_t y = 0;
+};
+
+// Bounding rectangle of all monitors, in virtual desktop pixels
+struct ScreenRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    bool contains(int px, int py) const {
+        return px >= x && py >= y && px < x + width && py < y + height;
+    }
+};
+
+// Ordered list of events that a backend injects in one go.
+// Storage is reused between clicks, so filling it does not allocate once warm.
+class InputBatch {
+public:
+    InputBatch() { m_events.reserve(8); }
+
+    void clear() { m_events.clear(); }
+    void moveTo(int x, int y) { m_events.push_back({InputEvent::Type::MoveAbsolute, MouseButton::Left, 0, x, y}); }
+    void moveBy(int dx, int dy) { m_events.push_back({InputEvent::Type::MoveRelative, MouseButton::Left, 0, dx, dy}); }
+    void buttonDown(MouseButton button) { m_events.push_back({InputEvent::Type::ButtonDown, button, 0, 0, 0}); }
+    void buttonUp(MouseButton button) { m_events.push_back({InputEvent::Type::ButtonUp, button, 0, 0, 0}); }
+    void wheel(int dx, int dy) { m_events.push_back({InputEvent::Type::Wheel, MouseButton::Left, 0, dx, dy}); }
+    void keyDown(uint16_t key) { m_events.push_back({InputEvent::Type::KeyDown, MouseButton::Left, key, 0, 0}); }
+    void keyUp(uint16_t key) { m_events.push_back({InputEvent::Type::KeyUp, MouseButton::Left, key, 0, 0}); }
+    // Room for this many events before add calls allocate again
+    void reserve(int events) { m_events.reserve(events); }
+    // The last event, which must exist; lets callers merge into it
+    InputEvent& back() { return m_events.back(); }
+    void setMoveTarget(int index, int x, int y) {
+        m_events[index].x = x;
+        m_events[index].y = y;
+    }
+
+    bool isEmpty() const { return m_events.empty(); }
+    int size() const { return static_cast<int>(m_events.size()); }
+    const std::vector<InputEvent>& events() const { return m_events; }
+
+private:
+    std::vector<InputEvent> m_events;
+};
+
+// Buttons and keys that went down and have not come up again, in press order.
+// Fed with what a backend actually took, so whatever a cut-off injection left
+// pressed can be let go again, last pressed first. Storage is reused like
+// InputBatch's.
+class HeldInputs {
+public:
+    HeldInputs() { m_presses.reserve(8); }
+
+    void clear() { m_presses.clear(); }
+    void reserve(int presses) { m_presses.reserve(presses); }
+    bool isEmpty() const { return m_presses.empty(); }
+    // Follows the first `sent` events of the batch
+    void track(const InputBatch& batch, int sent);
+    // Appends the release of everything held, in reverse press order, and forgets it
+    void releaseInto(InputBatch& batch);
+
+private:
+    std::vector<InputEvent> m_presses;
+};
+
+// Backend-native form of an InputBatch, built once when the engine starts and
+// then submitted as-is on every tick.
+class PreparedBatch {
+public:
+    virtual ~PreparedBatch() = default;
+
+    int size() const { return m_size; }
+
+    // Rewrites the coordinates of the MoveAbsolute event at index in place
+    virtual void setMoveTarget(int index, int x, int y) = 0;
+
+protected:
+    int m_size = 0;
+};
+
+// Platform input injection used by the click engine. All methods except open()
+// and prepare() are called from the engine thread only.
+class InputBackend {
+public:
+    virtual ~InputBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    // Acquires the OS resources; on failure returns false and sets lastError()
+    virtual bool open() = 0;
+
+    virtual bool virtualScreen(ScreenRect& rect) const = 0;
+
+    // Shared display layout; lets backends skip OS queries on every batch
+    void setDisplayCache(const DisplayCache* cache) { m_displayCache = cache; }
+
+    // Immediate cursor access; cursorPosition() only works if canReadCursor()
+    virtual bool canReadCursor() const { return true; }
+    virtual bool cursorPosition(int& x, int& y) = 0;
+    virtual bool setCursorPosition(int x, int y) = 0;
+
+    // Injects the whole batch with as few OS calls as the platform allows.
+    // Returns the number of events the OS accepted.
+    virtual int submit(const InputBatch& batch) = 0;
+
+    // Converts a batch to the backend's wire format once; submitPrepared() then
+    // skips all per-event translation. The defaults simply keep the InputBatch.
+    virtual std::unique_ptr<PreparedBatch> prepare(const InputBatch& batch);
+    virtual int submitPrepared(PreparedBatch& batch);
+
+    const std::string& lastError() const { return m_lastError; }
+
+    // Optional backend-specific cost summary for the log, empty if none
+    virtual std::string diagnostics() const { return std::string(); }
+
+protected:
+    std::string m_lastError;
+    const DisplayCache* m_displayCache = nullptr;
+};
+
+// Native backend for the current platform. The desktop rectangle is only
+// needed by backends that cannot query it themselves (uinput).
+// On Linux, FLAME_INPUT_BACKEND=uinput|xtest overrides the choice; otherwise
+// XTest is used when an X display is available and uinput as the fallback.
+std::unique_ptr<InputBackend> createDefaultInputBackend(const ScreenRect& desktop);
+
+#endif // INPUTBACKEND_H
@@ -0,0 +1,105 @@
+#include "InputCodes.h"
+
+namespace {
+struct KeyPair {
+    uint16_t code;
+    uint8_t virtualKey;
+};
+
+// Linux key code -> Windows virtual key, in key code order
+constexpr KeyPair KeyTable[] = {
+    {1, 0x1B},                                            // Esc
+    {2, '1'}, {3, '2'}, {4, '3'}, {5, '4'}, {6, '5'},
+    {7, '6'}, {8, '7'}, {9, '8'}, {10, '9'}, {11, '0'},
+    {12, 0xBD}, {13, 0xBB}, {14, 0x08}, {15, 0x09},       // - = Backspace Tab
+    {16, 'Q'}, {17, 'W'}, {18, 'E'}, {19, 'R'}, {20, 'T'},
+    {21, 'Y'}, {22, 'U'}, {23, 'I'}, {24, 'O'}, {25, 'P'},
+    {26, 0xDB}, {27, 0xDD}, {28, 0x0D}, {29, 0xA2},       // [ ] Enter LeftCtrl
+    {30, 'A'}, {31, 'S'}, {32, 'D'}, {33, 'F'}, {34, 'G'},
+    {35, 'H'}, {36, 'J'}, {37, 'K'}, {38, 'L'},
+    {39, 0xBA}, {40, 0xDE}, {41, 0xC0}, {42, 0xA0}, {43, 0xDC}, // ; ' ` LeftShift Backslash
+    {44, 'Z'}, {45, 'X'}, {46, 'C'}, {47, 'V'}, {48, 'B'},
+    {49, 'N'}, {50, 'M'},
+    {51, 0xBC}, {52, 0xBE}, {53, 0xBF}, {54, 0xA1},       // , . / RightShift
+    {55, 0x6A}, {56, 0xA4}, {57, 0x20}, {58, 0x14},       // Keypad* LeftAlt Space CapsLock
+    {59, 0x70}, {60, 0x71}, {61, 0x72}, {62, 0x73}, {63, 0x74}, // F1-F10
+    {64, 0x75}, {65, 0x76}, {66, 0x77}, {67, 0x78}, {68, 0x79},
+    {69, 0x90}, {70, 0x91},                               // NumLock ScrollLock
+    {71, 0x67}, {72, 0x68}, {73, 0x69}, {74, 0x6D},       // Keypad 7 8 9 -
+    {75, 0x64}, {76, 0x65}, {77, 0x66}, {78, 0x6B},       // Keypad 4 5 6 +
+    {79, 0x61}, {80, 0x62}, {81, 0x63}, {82, 0x60}, {83, 0x6E}, // Keypad 1 2 3 0 .
+    {86, 0xE2}, {87, 0x7A}, {88, 0x7B},                   // 102nd F11 F12
+    {96, 0x0D}, {97, 0xA3}, {98, 0x6F}, {99, 0x2C}, {100, 0xA5}, // KeypadEnter RightCtrl Keypad/ PrintScreen RightAlt
+    {102, 0x24}, {103, 0x26}, {104, 0x21}, {105, 0x25},   // Home Up PageUp Left
+    {106, 0x27}, {107, 0x23}, {108, 0x28}, {109, 0x22},   // Right End Down PageDown
+    {110, 0x2D}, {111, 0x2E},                             // Insert Delete
+    {113, 0xAD}, {114, 0xAE}, {115, 0xAF}, {119, 0x13},   // Mute VolumeDown VolumeUp Pause
+    {125, 0x5B}, {126, 0x5C}, {127, 0x5D},                // LeftMeta RightMeta Menu
+    {163, 0xB0}, {164, 0xB3}, {165, 0xB1}, {166, 0xB2},   // Next PlayPause Previous Stop
+    {183, 0x7C}, {184, 0x7D}, {185, 0x7E}, {186, 0x7F},   // F13-F24
+    {187, 0x80}, {188, 0x81}, {189, 0x82}, {190, 0x83},
+    {191, 0x84}, {192, 0x85}, {193, 0x86}, {194, 0x87},
+};
+} // namespace
+
+bool mouseButtonFromCode(uint16_t code, MouseButton& button) {
+    switch (code) {
+    case InputCode::BtnLeft: button = MouseButton::Left; return true;
+    case InputCode::BtnRight: button = MouseButton::Right; return true;
+    case InputCode::BtnMiddle: button = MouseButton::Middle; return true;
+    case InputCode::BtnSide: button = MouseButton::Back; return true;
+    case InputCode::BtnExtra: button = MouseButton::Forward; return true;
+    default: return false;
+    }
+}
+
+uint16_t codeFromMouseButton(MouseButton button) {
+    switch (button) {
+    case MouseButton::Right: return InputCode::BtnRight;
+    case MouseButton::Middle: return InputCode::BtnMiddle;
+    case MouseButton::Back: return InputCode::BtnSide;
+    case MouseButton::Forward: return InputCode::BtnExtra;
+    default: return InputCode::BtnLeft;
+    }
+}
+
+int virtualKeyFromCode(uint16_t code) {
+    for (const KeyPair& pair : KeyTable) {
+        if (pair.code == code) {
+            return pair.virtualKey;
+        }
+    }
+    return 0;
+}
+
+uint16_t codeFromVirtualKey(int virtualKey) {
+    switch (virtualKey) {
+    case 0x10: return 42; // Shift
+    case 0x11: return 29; // Ctrl
+    case 0x12: return 56; // Alt
+    default: break;
+    }
+    // First match, so Enter wins over Keypad Enter
+    for (const KeyPair& pair : KeyTable) {
+        if (pair.virtualKey == virtualKey) {
+            return pair.code;
+        }
+    }
+    return 0;
+}
+
+bool isExtendedVirtualKey(int virtualKey) {
+    switch (virtualKey) {
+    case 0x21: case 0x22: case 0x23: case 0x24:           // PageUp PageDown End Home
+    case 0x25: case 0x26: case 0x27: case 0x28:           // arrows
+    case 0x2C: case 0x2D: case 0x2E:                      // PrintScreen Insert Delete
+    case 0x5B: case 0x5C: case 0x5D:                      // Windows keys, Menu
+    case 0x6F: case 0x90:                                 // Keypad/ NumLock
+    case 0xA3: case 0xA5:                                 // RightCtrl RightAlt
+    case 0xAD: case 0xAE: case 0xAF:                      // volume
+    case 0xB0: case 0xB1: case 0xB2: case 0xB3:           // media
+        return true;
+    default:
+        return false;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef INPUTCODES_H
+#define INPUTCODES_H
+
+#include <cstdint>
+
+#include "InputBackend.h"
+
+// Keys and buttons are named by their Linux input event codes
+// (linux/input-event-codes.h) on every platform: that is what the evdev
+// recorder captures, what macros store and what InputEvent::key carries.
+// Backends for other systems translate with the helpers below.
+namespace InputCode {
+constexpr uint16_t KeyEscape = 1;
+constexpr uint16_t KeyEnter = 28;
+constexpr uint16_t KeyLeftCtrl = 29;
+constexpr uint16_t KeyLeftShift = 42;
+constexpr uint16_t KeyLeftAlt = 56;
+constexpr uint16_t KeySpace = 57;
+constexpr uint16_t KeyLeftMeta = 125;
+constexpr uint16_t BtnLeft = 0x110;
+constexpr uint16_t BtnRight = 0x111;
+constexpr uint16_t BtnMiddle = 0x112;
+constexpr uint16_t BtnSide = 0x113;  // "back"
+constexpr uint16_t BtnExtra = 0x114; // "forward"
+constexpr uint16_t Count = 0x300;    // KEY_CNT
+} // namespace InputCode
+
+// Mouse button of a BTN_* code; false for anything that is not a mouse button
+bool mouseButtonFromCode(uint16_t code, MouseButton& button);
+uint16_t codeFromMouseButton(MouseButton button);
+
+// Windows virtual-key code of a key code, 0 if it has none
+int virtualKeyFromCode(uint16_t code);
+// Key code of a Windows virtual-key code, 0 if it has none. The generic
+// Shift, Ctrl and Alt keys map to their left-hand variants.
+uint16_t codeFromVirtualKey(int virtualKey);
+// Virtual keys that SendInput must flag KEYEVENTF_EXTENDEDKEY
+bool isExtendedVirtualKey(int virtualKey);
+
+#endif // INPUTCODES_H
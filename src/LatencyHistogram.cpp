@@ -0,0 +1,137 @@
+#include "LatencyHistogram.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+int highestBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+double toMicroseconds(std::chrono::nanoseconds value) {
+    return value.count() / 1000.0;
+}
+} // namespace
+
+int LatencyHistogram::indexFor(uint64_t value) {
+    // Values below 2 * SubBuckets get one exact bucket each
+    if (value < 2 * SubBuckets) {
+        return static_cast<int>(value);
+    }
+    const int magnitude = highestBit(value);
+    const int sub = static_cast<int>(value >> (magnitude - 4)) - SubBuckets;
+    return 2 * SubBuckets + (magnitude - 5) * SubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::lowerBound(int index) {
+    if (index < 2 * SubBuckets) {
+        return static_cast<uint64_t>(index);
+    }
+    const int magnitude = 5 + (index - 2 * SubBuckets) / SubBuckets;
+    const uint64_t sub = SubBuckets + (index - 2 * SubBuckets) % SubBuckets;
+    return sub << (magnitude - 4);
+}
+
+uint64_t LatencyHistogram::upperBound(int index) {
+    if (index < 2 * SubBuckets) {
+        return static_cast<uint64_t>(index);
+    }
+    const int magnitude = 5 + (index - 2 * SubBuckets) / SubBuckets;
+    return lowerBound(index) + (uint64_t(1) << (magnitude - 4)) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds value) {
+    const uint64_t ns = value.count() > 0 ? static_cast<uint64_t>(value.count()) : 0;
+
+    m_buckets[indexFor(ns)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(ns, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t current = m_min.load(std::memory_order_relaxed);
+    while (ns < current && !m_min.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+    }
+    current = m_max.load(std::memory_order_relaxed);
+    while (ns > current && !m_max.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(UINT64_MAX, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds LatencyHistogram::min() const {
+    const uint64_t value = m_min.load(std::memory_order_relaxed);
+    return std::chrono::nanoseconds(value == UINT64_MAX ? 0 : static_cast<int64_t>(value));
+}
+
+std::chrono::nanoseconds LatencyHistogram::mean() const {
+    const int64_t n = count();
+    return std::chrono::nanoseconds(n > 0 ? static_cast<int64_t>(m_sum.load(std::memory_order_relaxed) / n) : 0);
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double p) const {
+    const int64_t n = count();
+    if (n == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    // Rank of the sample we are after, 1-based
+    int64_t rank = static_cast<int64_t>(p * n + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+
+    int64_t seen = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        seen += static_cast<int64_t>(m_buckets[i].load(std::memory_order_relaxed));
+        if (seen >= rank) {
+            const uint64_t mid = lowerBound(i) + (upperBound(i) - lowerBound(i)) / 2;
+            // Never report beyond the largest value actually seen
+            return std::min(std::chrono::nanoseconds(static_cast<int64_t>(mid)), max());
+        }
+    }
+    return max();
+}
+
+std::string LatencyHistogram::summary() const {
+    char text[160];
+    std::snprintf(text, sizeof(text), "n=%lld p50=%.1fus p99=%.1fus p99.9=%.1fus max=%.1fus",
+                  static_cast<long long>(count()),
+                  toMicroseconds(percentile(0.50)),
+                  toMicroseconds(percentile(0.99)),
+                  toMicroseconds(percentile(0.999)),
+                  toMicroseconds(max()));
+    return text;
+}
+
+std::string LatencyHistogram::buckets() const {
+    std::string text;
+    char line[80];
+    for (int i = 0; i < BucketCount; ++i) {
+        const uint64_t n = m_buckets[i].load(std::memory_order_relaxed);
+        if (n == 0) {
+            continue;
+        }
+        std::snprintf(line, sizeof(line), "%llu %llu %llu\n",
+                      static_cast<unsigned long long>(lowerBound(i)),
+                      static_cast<unsigned long long>(upperBound(i)),
+                      static_cast<unsigned long long>(n));
+        text += line;
+    }
+    return text;
+}
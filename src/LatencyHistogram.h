@@ -0,0 +1,46 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Fixed-size latency histogram with logarithmic buckets, HdrHistogram style:
+// every power of two is split into 16 linear sub-buckets, so any recorded
+// value is reported within about 6% from 1 ns up to centuries. record() is a
+// few relaxed atomic adds and never allocates; readers may sample at any time.
+class LatencyHistogram {
+public:
+    void record(std::chrono::nanoseconds value);
+    void reset();
+
+    int64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    std::chrono::nanoseconds min() const;
+    std::chrono::nanoseconds max() const { return std::chrono::nanoseconds(m_max.load(std::memory_order_relaxed)); }
+    std::chrono::nanoseconds mean() const;
+    // p in [0, 1]; returns the midpoint of the bucket holding that rank
+    std::chrono::nanoseconds percentile(double p) const;
+
+    // "n=... p50=... p99=... p99.9=... max=..." in microseconds
+    std::string summary() const;
+    // One "lower_ns upper_ns count" line per non-empty bucket
+    std::string buckets() const;
+
+private:
+    static constexpr int SubBuckets = 16;
+    static constexpr int BucketCount = 2 * SubBuckets + (64 - 5) * SubBuckets;
+
+    static int indexFor(uint64_t value);
+    static uint64_t lowerBound(int index);
+    static uint64_t upperBound(int index);
+
+    std::array<std::atomic<uint64_t>, BucketCount> m_buckets{};
+    std::atomic<int64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_min{UINT64_MAX};
+    std::atomic<uint64_t> m_max{0};
+};
+
+#endif // LATENCYHISTOGRAM_H
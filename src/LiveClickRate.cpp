@@ -0,0 +1,24 @@
+#include "LiveClickRate.h"
+
+#include <algorithm>
+
+void LiveClickRate::clear() {
+    m_samples.clear();
+    m_clicks = 0;
+}
+
+void LiveClickRate::add(const ClickEngine::ClickSample& sample) {
+    m_samples.push_back(sample);
+    m_clicks += sample.clicks;
+}
+
+double LiveClickRate::update(ClickEngine::Clock::duration elapsed) {
+    const ClickEngine::Clock::rep windowStart = (elapsed - m_window).count();
+    while (!m_samples.empty() && m_samples.front().time <= windowStart) {
+        m_clicks -= m_samples.front().clicks;
+        m_samples.pop_front();
+    }
+
+    const double seconds = std::chrono::duration<double>(std::min(elapsed, m_window)).count();
+    return seconds > 0.0 ? m_clicks / seconds : 0.0;
+}
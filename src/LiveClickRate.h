@@ -0,0 +1,27 @@
+#ifndef LIVECLICKRATE_H
+#define LIVECLICKRATE_H
+
+#include "ClickEngine.h"
+
+#include <deque>
+
+// Clicks per second over the last second of run time, fed from the engine's
+// telemetry. Samples and the window end are both in run time, so a pause
+// neither empties the window nor counts the clicks after it twice.
+class LiveClickRate {
+public:
+    explicit LiveClickRate(ClickEngine::Clock::duration window = std::chrono::seconds(1)) : m_window(window) {}
+
+    void clear();
+    void add(const ClickEngine::ClickSample& sample);
+    // Drops samples older than the window ending at elapsed; shorter than a
+    // window into the run, the rate is over what has elapsed so far
+    double update(ClickEngine::Clock::duration elapsed);
+
+private:
+    ClickEngine::Clock::duration m_window;
+    std::deque<ClickEngine::ClickSample> m_samples;
+    int64_t m_clicks = 0;
+};
+
+#endif // LIVECLICKRATE_H
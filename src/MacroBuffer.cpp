@@ -0,0 +1,44 @@
+#include "MacroBuffer.h"
+
+#include <algorithm>
+
+void MacroBuffer::reserve(size_t events) {
+    const size_t chunks = (events + ChunkSize - 1) >> ChunkShift;
+    m_chunks.reserve(chunks);
+    while (m_chunks.size() < chunks) {
+        grow();
+    }
+}
+
+void MacroBuffer::truncate(size_t size) {
+    if (size < m_size.load(std::memory_order_relaxed)) {
+        m_size.store(size, std::memory_order_release);
+    }
+}
+
+void MacroBuffer::grow() {
+    // Value-initialised, so every page is touched here rather than on first write
+    m_chunks.push_back(std::make_unique<Chunk>());
+}
+
+MacroEvent MacroBuffer::at(size_t index) const {
+    const Chunk& chunk = *m_chunks[index >> ChunkShift];
+    const size_t slot = index & (ChunkSize - 1);
+    MacroEvent event;
+    event.timeUs = chunk.timeUs[slot];
+    event.type = static_cast<MacroEvent::Type>(chunk.type[slot]);
+    event.code = chunk.code[slot];
+    event.x = chunk.x[slot];
+    event.y = chunk.y[slot];
+    return event;
+}
+
+int64_t MacroBuffer::durationUs() const {
+    const size_t count = size();
+    return count == 0 ? 0 : at(count - 1).timeUs;
+}
+
+size_t MacroBuffer::chunkLength(size_t index) const {
+    const size_t count = size();
+    return std::min(ChunkSize, count - std::min(count, index * ChunkSize));
+}
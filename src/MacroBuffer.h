@@ -0,0 +1,114 @@
+#ifndef MACROBUFFER_H
+#define MACROBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// One recorded input action. Button and key codes are Linux input event codes
+// (BTN_LEFT, KEY_A, ...), the native vocabulary of the evdev recorder.
+struct MacroEvent {
+    enum class Type : uint8_t {
+        Move,         // x, y: relative motion in device counts
+        MoveAbsolute, // x, y: virtual desktop pixels
+        ButtonDown,
+        ButtonUp,
+        Wheel,        // x: horizontal, y: vertical detents
+        KeyDown,
+        KeyUp
+    };
+
+    int64_t timeUs = 0; // monotonic, since the recording started
+    Type type = Type::Move;
+    uint16_t code = 0;
+    int32_t x = 0;
+    int32_t y = 0;
+};
+
+// Read access to a macro wherever it is stored, for the player. Reads are
+// mostly sequential, and an implementation may keep state between them, so
+// there is one reader at a time.
+class MacroTimeline {
+public:
+    virtual ~MacroTimeline() = default;
+
+    virtual size_t size() const = 0;
+    // Time of the last event, 0 when empty
+    virtual int64_t durationUs() const = 0;
+    // False if the event cannot be read, e.g. from a damaged file
+    virtual bool read(size_t index, MacroEvent& event) = 0;
+    bool empty() const { return size() == 0; }
+};
+
+// Growable structure-of-arrays store for recorded input. Events live in
+// fixed-size chunks, one array per field, so growing never moves what is
+// already recorded: a full chunk is followed by a fresh one, and reserve()
+// allocates those up front so a capture thread does not allocate at all
+// until the reservation runs out.
+//
+// Single writer. size() may be read from any thread while recording; the
+// events themselves only once the writer has stopped.
+class MacroBuffer : public MacroTimeline {
+public:
+    static constexpr int ChunkShift = 12;
+    static constexpr size_t ChunkSize = size_t(1) << ChunkShift;
+
+    struct Chunk {
+        int64_t timeUs[ChunkSize];
+        uint8_t type[ChunkSize];
+        uint16_t code[ChunkSize];
+        int32_t x[ChunkSize];
+        int32_t y[ChunkSize];
+    };
+
+    MacroBuffer() = default;
+    MacroBuffer(const MacroBuffer&) = delete;
+    MacroBuffer& operator=(const MacroBuffer&) = delete;
+
+    // Room for at least `events` events without further allocation
+    void reserve(size_t events);
+    // Forgets the events but keeps the chunks for the next recording
+    void clear() { m_size.store(0, std::memory_order_release); }
+    // Drops everything from `size` on
+    void truncate(size_t size);
+
+    void append(int64_t timeUs, MacroEvent::Type type, uint16_t code, int32_t x, int32_t y) {
+        const size_t index = m_size.load(std::memory_order_relaxed);
+        const size_t slot = index & (ChunkSize - 1);
+        if (slot == 0 && (index >> ChunkShift) == m_chunks.size()) {
+            grow();
+        }
+        Chunk& chunk = *m_chunks[index >> ChunkShift];
+        chunk.timeUs[slot] = timeUs;
+        chunk.type[slot] = static_cast<uint8_t>(type);
+        chunk.code[slot] = code;
+        chunk.x[slot] = x;
+        chunk.y[slot] = y;
+        m_size.store(index + 1, std::memory_order_release);
+    }
+    void append(const MacroEvent& event) { append(event.timeUs, event.type, event.code, event.x, event.y); }
+
+    size_t size() const override { return m_size.load(std::memory_order_acquire); }
+    size_t capacity() const { return m_chunks.size() * ChunkSize; }
+    MacroEvent at(size_t index) const;
+    int64_t durationUs() const override;
+    bool read(size_t index, MacroEvent& event) override {
+        event = at(index);
+        return true;
+    }
+
+    // Column access for bulk readers: chunk i holds events i * ChunkSize onwards
+    size_t chunkCount() const { return (size() + ChunkSize - 1) >> ChunkShift; }
+    const Chunk& chunk(size_t index) const { return *m_chunks[index]; }
+    size_t chunkLength(size_t index) const;
+
+private:
+    void grow();
+
+    std::vector<std::unique_ptr<Chunk>> m_chunks;
+    std::atomic<size_t> m_size{0};
+};
+
+#endif // MACROBUFFER_H
@@ -0,0 +1,173 @@
+#include "MacroFile.h"
+
+#include <cerrno>
+#include <cstring>
+
+namespace {
+// Keeps the zigzagged delta clear of the 3 type bits
+constexpr int64_t MaxTimeDelta = int64_t(1) << 59;
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+uint8_t* putVarint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+} // namespace
+
+MacroFileWriter::~MacroFileWriter() {
+    if (m_file) {
+        fail("Macro file not finished");
+    }
+}
+
+void MacroFileWriter::fail(const std::string& what) {
+    m_lastError = what;
+    if (m_file) {
+        std::fclose(m_file);
+        std::remove(m_path.c_str());
+        m_file = nullptr;
+    }
+}
+
+bool MacroFileWriter::open(const std::string& path) {
+    if (m_file) {
+        fail("Macro file not finished");
+    }
+    m_file = std::fopen(path.c_str(), "wb");
+    if (!m_file) {
+        m_lastError = "Cannot create " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    m_path = path;
+    m_lastError.clear();
+    m_eventCount = 0;
+    m_lastTimeUs = 0;
+    m_index.clear();
+    m_block.resize(MacroBlockEvents * MacroMaxEventBytes);
+    m_blockBytes = 0;
+    m_blockLength = 0;
+
+    // Rewritten by finish() once the counts are known
+    const MacroFileHeader header = {};
+    m_offset = sizeof(header);
+    if (std::fwrite(&header, sizeof(header), 1, m_file) != 1) {
+        fail("Cannot write " + path + ": " + std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool MacroFileWriter::append(const MacroEvent& event) {
+    if (!m_file) {
+        return false;
+    }
+    if (m_blockLength == 0) {
+        m_index.push_back({m_offset, event.timeUs, 0, 0});
+        m_time = event.timeUs;
+        m_absX = 0;
+        m_absY = 0;
+    }
+
+    const int64_t delta = event.timeUs - m_time;
+    if (delta >= MaxTimeDelta || delta <= -MaxTimeDelta) {
+        fail("Macro timestamps out of range");
+        return false;
+    }
+    m_time = event.timeUs;
+
+    uint8_t* const start = m_block.data() + m_blockBytes;
+    uint8_t* p = putVarint(start, zigzag(delta) << 3 | static_cast<uint8_t>(event.type));
+    switch (event.type) {
+    case MacroEvent::Type::Move:
+    case MacroEvent::Type::Wheel:
+        p = putVarint(p, zigzag(event.x));
+        p = putVarint(p, zigzag(event.y));
+        break;
+    case MacroEvent::Type::MoveAbsolute:
+        p = putVarint(p, zigzag(event.x - m_absX));
+        p = putVarint(p, zigzag(event.y - m_absY));
+        m_absX = event.x;
+        m_absY = event.y;
+        break;
+    default:
+        p = putVarint(p, event.code);
+        break;
+    }
+    m_blockBytes += static_cast<size_t>(p - start);
+
+    ++m_eventCount;
+    m_lastTimeUs = event.timeUs;
+    if (++m_blockLength == MacroBlockEvents) {
+        return flushBlock();
+    }
+    return true;
+}
+
+bool MacroFileWriter::flushBlock() {
+    MacroBlockEntry& entry = m_index.back();
+    entry.bytes = static_cast<uint32_t>(m_blockBytes);
+    entry.checksum = macroChecksum(m_block.data(), m_blockBytes);
+    if (std::fwrite(m_block.data(), 1, m_blockBytes, m_file) != m_blockBytes) {
+        fail("Cannot write " + m_path + ": " + std::strerror(errno));
+        return false;
+    }
+    m_offset += m_blockBytes;
+    m_blockBytes = 0;
+    m_blockLength = 0;
+    return true;
+}
+
+bool MacroFileWriter::finish() {
+    if (!m_file || (m_blockLength > 0 && !flushBlock())) {
+        return false;
+    }
+
+    MacroFileHeader header = {};
+    std::memcpy(header.magic, MacroMagic, sizeof(MacroMagic));
+    header.version = MacroVersion;
+    header.blockEvents = MacroBlockEvents;
+    header.eventCount = m_eventCount;
+    header.durationUs = m_lastTimeUs;
+    header.blockCount = m_index.size();
+
+    const uint8_t padding[8] = {};
+    const size_t pad = static_cast<size_t>(-m_offset & 7);
+    header.indexOffset = m_offset + pad;
+    const bool ok = std::fwrite(padding, 1, pad, m_file) == pad
+        && (m_index.empty() || std::fwrite(m_index.data(), sizeof(MacroBlockEntry), m_index.size(), m_file) == m_index.size())
+        && std::fseek(m_file, 0, SEEK_SET) == 0
+        && std::fwrite(&header, sizeof(header), 1, m_file) == 1;
+    if (!ok) {
+        fail("Cannot write " + m_path + ": " + std::strerror(errno));
+        return false;
+    }
+    m_offset = header.indexOffset + m_index.size() * sizeof(MacroBlockEntry);
+
+    const int closed = std::fclose(m_file);
+    m_file = nullptr;
+    if (closed != 0) {
+        m_lastError = "Cannot write " + m_path + ": " + std::strerror(errno);
+        std::remove(m_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool saveMacroFile(const MacroBuffer& macro, const std::string& path, std::string& error) {
+    MacroFileWriter writer;
+    bool ok = writer.open(path);
+    const size_t count = macro.size();
+    for (size_t i = 0; ok && i < count; ++i) {
+        ok = writer.append(macro.at(i));
+    }
+    ok = ok && writer.finish();
+    error = ok ? std::string() : writer.lastError();
+    return ok;
+}
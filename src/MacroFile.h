@@ -0,0 +1,111 @@
+#ifndef MACROFILE_H
+#define MACROFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "MacroBuffer.h"
+
+// On-disk layout of a saved macro, little-endian:
+//
+//   MacroFileHeader
+//   block 0 .. block N-1   blockEvents encoded events each, the last one shorter
+//   MacroBlockEntry[N]     at indexOffset, 8-byte aligned
+//
+// Every block decodes on its own and is checked against the checksum in its
+// index entry before it is used. An event starts with one varint holding the
+// zigzagged time delta to the previous event (to the block's firstTimeUs for
+// the first) shifted left by 3, with the MacroEvent::Type in the low 3 bits.
+// What follows depends on the type:
+//   Move, Wheel          zigzag varint x, y
+//   MoveAbsolute         zigzag varint x, y as deltas to the previous
+//                        absolute position in the block (0, 0 at its start)
+//   Button*, Key*        varint code
+// A mouse move typically takes 3 to 5 bytes instead of the 24 of a MacroEvent.
+
+struct MacroFileHeader {
+    char magic[8];        // "FLMMACRO"
+    uint32_t version;
+    uint32_t blockEvents; // events per block
+    uint64_t eventCount;
+    int64_t durationUs;   // time of the last event
+    uint64_t indexOffset; // byte offset of the block index
+    uint64_t blockCount;
+};
+
+struct MacroBlockEntry {
+    uint64_t offset;     // byte offset of the block
+    int64_t firstTimeUs;
+    uint32_t bytes;      // encoded length
+    uint32_t checksum;   // macroChecksum() of those bytes
+};
+
+static_assert(sizeof(MacroFileHeader) == 48, "macro header layout changed");
+static_assert(sizeof(MacroBlockEntry) == 24, "macro block entry layout changed");
+
+constexpr char MacroMagic[8] = {'F', 'L', 'M', 'M', 'A', 'C', 'R', 'O'};
+constexpr uint32_t MacroVersion = 1;
+constexpr uint32_t MacroBlockEvents = MacroBuffer::ChunkSize;
+// Longest encoding of one event: three 10-byte varints
+constexpr size_t MacroMaxEventBytes = 30;
+
+// FNV-1a over a block's bytes
+inline uint32_t macroChecksum(const uint8_t* data, size_t size) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Streams events into a macro file in the layout above, holding one encoded
+// block in memory. The header and index are written by finish(); a writer
+// destroyed or failing before that removes its partial file.
+class MacroFileWriter {
+public:
+    MacroFileWriter() = default;
+    ~MacroFileWriter();
+
+    MacroFileWriter(const MacroFileWriter&) = delete;
+    MacroFileWriter& operator=(const MacroFileWriter&) = delete;
+
+    // Creates or truncates path
+    bool open(const std::string& path);
+    // False on a write error or a time step too large to encode
+    bool append(const MacroEvent& event);
+    bool finish();
+    bool isOpen() const { return m_file != nullptr; }
+
+    uint64_t eventCount() const { return m_eventCount; }
+    // Bytes written so far
+    uint64_t size() const { return m_offset + m_blockBytes; }
+    const std::string& lastError() const { return m_lastError; }
+
+private:
+    bool flushBlock();
+    void fail(const std::string& what);
+
+    std::FILE* m_file = nullptr;
+    std::string m_path;
+    std::string m_lastError;
+    uint64_t m_offset = 0;
+    uint64_t m_eventCount = 0;
+    int64_t m_lastTimeUs = 0;
+    std::vector<MacroBlockEntry> m_index;
+
+    // The block being encoded, sized for the worst case up front
+    std::vector<uint8_t> m_block;
+    size_t m_blockBytes = 0;
+    size_t m_blockLength = 0;
+    int64_t m_time = 0;
+    int64_t m_absX = 0;
+    int64_t m_absY = 0;
+};
+
+// Writes macro to path; on failure error says why
+bool saveMacroFile(const MacroBuffer& macro, const std::string& path, std::string& error);
+
+#endif // MACROFILE_H
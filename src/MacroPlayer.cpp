@@ -0,0 +1,250 @@
+#include "MacroPlayer.h"
+#include "PreciseWaiter.h"
+#include "RingLogger.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Merged motion must stay representable; a step that would overflow starts a new move
+bool addsUp(int32_t a, int32_t b) {
+    const int64_t sum = static_cast<int64_t>(a) + b;
+    return sum >= INT32_MIN && sum <= INT32_MAX;
+}
+} // namespace
+
+MacroPlayer::~MacroPlayer() {
+    stop();
+}
+
+bool MacroPlayer::start(const Settings& settings) {
+    if (isRunning() || !m_backend || !m_macro || m_macro->empty()) {
+        return false;
+    }
+    if (!(settings.speed >= MinSpeed && settings.speed <= MaxSpeed) || settings.quantum.count() <= 0) {
+        return false;
+    }
+
+    // A previous run that finished on its own still has to be joined
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    m_settings = settings;
+    m_speedPermille = std::llround(settings.speed * 1000.0);
+    m_events = m_macro->size();
+    // Never shorter than a quantum, so endless loops of a zero-length macro still wait
+    const int64_t quantumUs = (settings.quantum.count() + 999) / 1000;
+    m_loopUs = std::max(m_macro->durationUs(), quantumUs);
+
+    // Merged moves keep most batches small; a wheel event may add two entries
+    m_batch.clear();
+    m_batch.reserve(MaxBatch + 2);
+    m_held.clear();
+    m_readFailed = false;
+
+    m_stopRequested.store(false, std::memory_order_relaxed);
+    m_eventsPlayed.store(0, std::memory_order_relaxed);
+    m_loops.store(0, std::memory_order_relaxed);
+    m_batches.store(0, std::memory_order_relaxed);
+    m_maxLatenessNs.store(0, std::memory_order_relaxed);
+    m_spinTimeNs.store(0, std::memory_order_relaxed);
+    m_running.store(true, std::memory_order_release);
+
+    m_thread = std::thread(&MacroPlayer::run, this);
+    return true;
+}
+
+void MacroPlayer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_stopRequested.store(true, std::memory_order_release);
+    }
+    m_waitCondition.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    m_running.store(false, std::memory_order_release);
+}
+
+MacroPlayer::Clock::duration MacroPlayer::offsetOf(const Cursor& cursor) const {
+    // Integer microseconds scaled once; exact for about 100 days of timeline
+    const int64_t timelineUs = cursor.loop * m_loopUs + cursor.event.timeUs;
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::nanoseconds(timelineUs * 1000000 / m_speedPermille));
+}
+
+uint64_t MacroPlayer::tickFor(Clock::duration offset) const {
+    // Rounded up, so an event never plays before its deadline
+    const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(offset).count();
+    if (ns <= 0) {
+        return 0;
+    }
+    const int64_t quantum = m_settings.quantum.count();
+    return static_cast<uint64_t>((ns + quantum - 1) / quantum);
+}
+
+bool MacroPlayer::next(Cursor& cursor) {
+    if (++cursor.index == m_events) {
+        m_loops.fetch_add(1, std::memory_order_relaxed);
+        cursor.index = 0;
+        ++cursor.loop;
+        if (m_settings.loops > 0 && cursor.loop >= m_settings.loops) {
+            return false;
+        }
+    }
+    m_readFailed = !m_macro->read(cursor.index, cursor.event);
+    return !m_readFailed;
+}
+
+bool MacroPlayer::append(const MacroEvent& event) {
+    using Type = MacroEvent::Type;
+    switch (event.type) {
+    case Type::Move:
+        // Consecutive motion adds up; only what lies between clicks matters
+        if (!m_batch.isEmpty() && m_batch.back().type == InputEvent::Type::MoveRelative
+            && addsUp(m_batch.back().x, event.x) && addsUp(m_batch.back().y, event.y)) {
+            m_batch.back().x += event.x;
+            m_batch.back().y += event.y;
+        } else {
+            m_batch.moveBy(event.x, event.y);
+        }
+        return true;
+    case Type::MoveAbsolute:
+        if (!m_batch.isEmpty() && m_batch.back().type == InputEvent::Type::MoveAbsolute) {
+            m_batch.back().x = event.x;
+            m_batch.back().y = event.y;
+        } else {
+            m_batch.moveTo(event.x, event.y);
+        }
+        return true;
+    case Type::Wheel:
+        if (event.y != 0) {
+            m_batch.wheel(0, event.y);
+        }
+        if (event.x != 0) {
+            m_batch.wheel(event.x, 0);
+        }
+        return true;
+    case Type::ButtonDown:
+    case Type::ButtonUp: {
+        MouseButton button;
+        if (!mouseButtonFromCode(event.code, button)) {
+            return false;
+        }
+        if (event.type == Type::ButtonDown) {
+            m_batch.buttonDown(button);
+        } else {
+            m_batch.buttonUp(button);
+        }
+        return true;
+    }
+    case Type::KeyDown:
+    case Type::KeyUp:
+        if (event.code >= InputCode::Count) {
+            return false;
+        }
+        if (event.type == Type::KeyDown) {
+            m_batch.keyDown(event.code);
+        } else {
+            m_batch.keyUp(event.code);
+        }
+        return true;
+    }
+    return false;
+}
+
+void MacroPlayer::releaseHeld() {
+    m_batch.clear();
+    m_held.releaseInto(m_batch);
+
+    if (!m_batch.isEmpty() && m_backend->submit(m_batch) != m_batch.size()) {
+        FLAME_LOG(Warning, "Macro playback could not release %lld held key(s) or button(s)",
+                  static_cast<long long>(m_batch.size()));
+    }
+}
+
+bool MacroPlayer::waitUntil(Clock::time_point deadline) {
+    const auto stopped = [this]() { return m_stopRequested.load(std::memory_order_acquire); };
+    const auto spun = PreciseWaiter::waitUntil(*m_clock, deadline, m_settings.highRate, m_waitMutex, m_waitCondition,
+                                               m_stopRequested, stopped);
+    m_spinTimeNs.fetch_add(spun.count(), std::memory_order_relaxed);
+    return !m_stopRequested.load(std::memory_order_acquire);
+}
+
+void MacroPlayer::run() {
+    const EngineThreadTiming timing;
+
+    const Clock::time_point origin = m_clock->now();
+    Cursor cursor;
+    StopReason reason = StopReason::Requested;
+    m_readFailed = !m_macro->read(0, cursor.event);
+
+    while (!m_readFailed) {
+        // The earliest event still to play sets the batch's deadline
+        const uint64_t tick = tickFor(offsetOf(cursor));
+        const Clock::time_point deadline = origin + std::chrono::duration_cast<Clock::duration>(m_settings.quantum * static_cast<int64_t>(tick));
+        if (!waitUntil(deadline)) {
+            break;
+        }
+
+        const Clock::time_point woke = m_clock->now();
+        const int64_t lateNs = std::chrono::duration_cast<std::chrono::nanoseconds>(woke - deadline).count();
+        if (lateNs > m_maxLatenessNs.load(std::memory_order_relaxed)) {
+            m_maxLatenessNs.store(lateNs, std::memory_order_relaxed);
+        }
+
+        // Everything due by the quantum we woke in goes into this batch
+        const uint64_t due = std::max(tick, tickFor(woke - origin));
+        m_batch.clear();
+        int64_t taken = 0;
+        bool more = true;
+        do {
+            if (!append(cursor.event)) {
+                FLAME_LOG(Debug, "Macro event %lld has no injectable form, skipped", static_cast<long long>(cursor.index));
+            }
+            ++taken;
+            more = next(cursor);
+        } while (more && m_batch.size() < MaxBatch && tickFor(offsetOf(cursor)) <= due);
+
+        // Last cancellation point before the injection
+        if (m_stopRequested.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        if (!m_batch.isEmpty()) {
+            const int sent = m_backend->submit(m_batch);
+            m_batches.fetch_add(1, std::memory_order_relaxed);
+            m_held.track(m_batch, sent);
+            if (sent != m_batch.size()) {
+                FLAME_LOG(Warning, "Macro playback batch failed after %lld event(s)",
+                          m_eventsPlayed.load(std::memory_order_relaxed));
+                reason = StopReason::Error;
+                break;
+            }
+        }
+        m_eventsPlayed.fetch_add(taken, std::memory_order_relaxed);
+
+        if (!more) {
+            reason = StopReason::ClickLimit;
+            break;
+        }
+    }
+    // A damaged macro file ends the run wherever it happens
+    if (m_readFailed) {
+        FLAME_LOG(Warning, "Macro playback could not read event %lld", static_cast<long long>(cursor.index));
+        reason = StopReason::Error;
+    }
+
+    releaseHeld();
+
+    m_running.store(false, std::memory_order_release);
+    FLAME_LOG(Debug, "Macro playback stopped (reason %lld) after %lld event(s), %lld loop(s), %lld batch(es)",
+              static_cast<int>(reason), m_eventsPlayed.load(std::memory_order_relaxed),
+              m_loops.load(std::memory_order_relaxed), m_batches.load(std::memory_order_relaxed));
+
+    if (reason != StopReason::Requested && m_finished) {
+        m_finished(reason);
+    }
+}
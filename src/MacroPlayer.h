@@ -0,0 +1,125 @@
+#ifndef MACROPLAYER_H
+#define MACROPLAYER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "ClickEngine.h"
+#include "EngineClock.h"
+#include "InputBackend.h"
+#include "InputCodes.h"
+#include "MacroBuffer.h"
+
+// Replays a recorded macro through an InputBackend on an engine thread
+// of its own. Every event has an absolute deadline,
+//   start + (loop * loopLength + event time) / speed,
+// computed afresh in integer nanoseconds, so lateness never carries over
+// from one event to the next and an hour of loops ends on time. Deadlines
+// are rounded up to the quantum and everything due in the same quantum goes
+// out as one injection batch, consecutive moves merged into one.
+//
+// Events are read one at a time as the timeline advances, so a macro file
+// is decoded block by block while it plays. Keys and buttons still held when
+// playback ends, for whatever reason, are released before the thread exits.
+class MacroPlayer {
+public:
+    using Clock = ClickEngine::Clock;
+    using StopReason = ClickEngine::StopReason; // ClickLimit: every loop was played, Error: also an unreadable event
+    using FinishedCallback = ClickEngine::FinishedCallback;
+
+    static constexpr double MinSpeed = 0.25;
+    static constexpr double MaxSpeed = 10.0;
+    // Events per injection at most; a catch-up after a stall spreads over several
+    static constexpr int MaxBatch = 256;
+
+    struct Settings {
+        double speed = 1.0;                                              // MinSpeed .. MaxSpeed
+        int loops = 1;                                                   // <= 0 for endless
+        std::chrono::nanoseconds quantum = std::chrono::milliseconds(1); // events within one share a batch
+        bool highRate = false;                                           // sleep-then-spin waits
+    };
+
+    MacroPlayer() = default;
+    ~MacroPlayer();
+
+    MacroPlayer(const MacroPlayer&) = delete;
+    MacroPlayer& operator=(const MacroPlayer&) = delete;
+
+    // Setup, only while stopped. Backend and macro must outlive the run, and
+    // the macro must not change while it plays.
+    void setBackend(InputBackend* backend) { m_backend = backend; }
+    void setClock(EngineClock* clock) { m_clock = clock ? clock : SteadyEngineClock::instance(); }
+    void setFinishedCallback(FinishedCallback cb) { m_finished = std::move(cb); }
+    void setMacro(MacroTimeline* macro) { m_macro = macro; }
+
+    // False without a backend or events, or with settings out of range.
+    // Must be called from the owning thread, never from the finished callback.
+    bool start(const Settings& settings);
+    // Joins the engine thread; held keys and buttons are released by then
+    void stop();
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+    // Live figures, safe from any thread while running
+    int64_t eventsPlayed() const { return m_eventsPlayed.load(std::memory_order_relaxed); }
+    int64_t loopsCompleted() const { return m_loops.load(std::memory_order_relaxed); }
+    int64_t batchesSubmitted() const { return m_batches.load(std::memory_order_relaxed); }
+    // Worst wake-up past a batch's (quantum-rounded) deadline so far
+    std::chrono::nanoseconds maxLateness() const { return std::chrono::nanoseconds(m_maxLatenessNs.load(std::memory_order_relaxed)); }
+    // Once stopped: whether the run ended on an event the macro could not read
+    bool readFailed() const { return m_readFailed; }
+
+private:
+    // Position in the timeline: event index within a loop, and that event
+    struct Cursor {
+        int64_t loop = 0;
+        size_t index = 0;
+        MacroEvent event;
+    };
+
+    void run();
+    bool waitUntil(Clock::time_point deadline);
+    Clock::duration offsetOf(const Cursor& cursor) const;
+    uint64_t tickFor(Clock::duration offset) const;
+    // Adds the event to the batch; false if it has no injectable form (e.g. an unknown button)
+    bool append(const MacroEvent& event);
+    // Steps to the next event, wrapping into the next loop; false once every
+    // loop is done or when the event cannot be read (m_readFailed)
+    bool next(Cursor& cursor);
+    // Lets go of what the macro left pressed, last pressed first
+    void releaseHeld();
+
+    InputBackend* m_backend = nullptr;
+    EngineClock* m_clock = SteadyEngineClock::instance();
+    FinishedCallback m_finished;
+    MacroTimeline* m_macro = nullptr;
+
+    // Fixed for a run
+    Settings m_settings;
+    int64_t m_speedPermille = 1000;
+    int64_t m_loopUs = 0;
+    size_t m_events = 0;
+
+    // Engine thread only while running
+    InputBatch m_batch;
+    HeldInputs m_held; // pressed by what the backend took
+    bool m_readFailed = false;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_stopRequested{false};
+    std::atomic<int64_t> m_eventsPlayed{0};
+    std::atomic<int64_t> m_loops{0};
+    std::atomic<int64_t> m_batches{0};
+    std::atomic<int64_t> m_maxLatenessNs{0};
+    std::atomic<int64_t> m_spinTimeNs{0};
+
+    // Only used to make stop() interrupt a pending wait immediately
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitCondition;
+};
+
+#endif // MACROPLAYER_H
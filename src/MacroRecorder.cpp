@@ -0,0 +1,36 @@
+#include "MacroRecorder.h"
+
+#ifdef _WIN32
+#include "Win32MacroRecorder.h"
+#elif defined(__linux__)
+#include "EvdevMacroRecorder.h"
+#endif
+
+void MacroRecorder::dropUnreleasedPresses(MacroBuffer& buffer, HeldCodes& held) {
+    // Presses without a release are the stop hotkey, or would stay stuck on playback
+    size_t size = buffer.size();
+    while (size > 0) {
+        const MacroEvent last = buffer.at(size - 1);
+        const bool press = last.type == MacroEvent::Type::KeyDown || last.type == MacroEvent::Type::ButtonDown;
+        if (!press || last.code >= held.size() || !held.test(last.code)) {
+            break;
+        }
+        held.reset(last.code);
+        --size;
+    }
+    buffer.truncate(size);
+}
+
+std::unique_ptr<MacroRecorder> createDefaultMacroRecorder(const ScreenRect& desktop) {
+#if defined(_WIN32)
+    std::unique_ptr<MacroRecorder> recorder = std::make_unique<Win32MacroRecorder>();
+#elif defined(__linux__)
+    std::unique_ptr<MacroRecorder> recorder = std::make_unique<EvdevMacroRecorder>();
+#else
+    std::unique_ptr<MacroRecorder> recorder;
+#endif
+    if (recorder && desktop.width > 0 && desktop.height > 0) {
+        recorder->setScreenGeometry(desktop);
+    }
+    return recorder;
+}
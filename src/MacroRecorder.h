@@ -0,0 +1,48 @@
+#ifndef MACRORECORDER_H
+#define MACRORECORDER_H
+
+#include <bitset>
+#include <memory>
+#include <string>
+
+#include "InputBackend.h"
+#include "InputCodes.h"
+#include "MacroBuffer.h"
+
+// Captures global mouse and keyboard input into a MacroBuffer on a thread of
+// its own. start() and stop() are called from the owning thread only.
+class MacroRecorder {
+public:
+    virtual ~MacroRecorder() = default;
+
+    virtual const char* name() const = 0;
+
+    // Absolute pointers (touch screens, tablets) are scaled to this rectangle
+    void setScreenGeometry(const ScreenRect& rect) { m_screen = rect; }
+
+    // Clears the buffer and starts capturing into it; the buffer must not be
+    // read until stop() returns. On failure returns false and sets lastError().
+    virtual bool start(MacroBuffer& buffer) = 0;
+    // Joins the capture thread. Keys still held at the end (typically the stop
+    // hotkey) are dropped so that playing the macro back leaves none stuck.
+    virtual void stop() = 0;
+    virtual bool isRecording() const = 0;
+
+    const std::string& lastError() const { return m_lastError; }
+
+protected:
+    using HeldCodes = std::bitset<InputCode::Count>;
+
+    // For stop(): drops the presses at the end of the buffer that were never
+    // released, and clears them from `held`
+    static void dropUnreleasedPresses(MacroBuffer& buffer, HeldCodes& held);
+
+    std::string m_lastError;
+    ScreenRect m_screen{0, 0, 1920, 1080};
+};
+
+// Native recorder for the current platform (evdev on Linux, low-level hooks
+// on Windows), nullptr where recording is not supported
+std::unique_ptr<MacroRecorder> createDefaultMacroRecorder(const ScreenRect& desktop);
+
+#endif // MACRORECORDER_H
@@ -0,0 +1,267 @@
+#include "MappedMacroFile.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// Caps what a damaged header can make open() allocate
+constexpr uint32_t MaxBlockEvents = 1u << 20;
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t pageSize() {
+    static const size_t size = []() {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwPageSize);
+#else
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }();
+    return size;
+}
+} // namespace
+
+MappedMacroFile::~MappedMacroFile() {
+    close();
+}
+
+void MappedMacroFile::setLastErrorFromSystem(const char* what) {
+#ifdef _WIN32
+    m_lastError = std::string(what) + " (Error: " + std::to_string(GetLastError()) + ")";
+#else
+    m_lastError = std::string(what) + ": " + std::strerror(errno);
+#endif
+}
+
+bool MappedMacroFile::open(const std::string& path) {
+    close();
+    void* view = nullptr;
+
+#ifdef _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                         FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        m_file = nullptr;
+        setLastErrorFromSystem("Cannot open macro file");
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size)) {
+        setLastErrorFromSystem("Cannot read macro file size");
+        close();
+        return false;
+    }
+    m_bytes = static_cast<uint64_t>(size.QuadPart);
+    if (m_bytes >= sizeof(MacroFileHeader)) {
+        m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping) {
+            view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+        }
+        if (!view) {
+            setLastErrorFromSystem("Cannot map macro file");
+            close();
+            return false;
+        }
+    }
+#else
+    m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0) {
+        setLastErrorFromSystem("Cannot open macro file");
+        return false;
+    }
+    struct stat info;
+    if (fstat(m_fd, &info) != 0) {
+        setLastErrorFromSystem("Cannot read macro file size");
+        close();
+        return false;
+    }
+    m_bytes = static_cast<uint64_t>(info.st_size);
+    if (m_bytes >= sizeof(MacroFileHeader)) {
+        view = mmap(nullptr, m_bytes, PROT_READ, MAP_SHARED, m_fd, 0);
+        if (view == MAP_FAILED) {
+            setLastErrorFromSystem("Cannot map macro file");
+            close();
+            return false;
+        }
+        // Read-ahead for the front-to-back playback
+        madvise(view, m_bytes, MADV_SEQUENTIAL);
+    }
+#endif
+
+    m_data = static_cast<const uint8_t*>(view);
+    MacroFileHeader header = {};
+    if (m_data) {
+        std::memcpy(&header, m_data, sizeof(header));
+    }
+
+    const char* problem = nullptr;
+    if (!m_data || std::memcmp(header.magic, MacroMagic, sizeof(MacroMagic)) != 0) {
+        problem = "Not a macro file";
+    } else if (header.version != MacroVersion) {
+        problem = "Unsupported macro file version";
+    } else if (header.blockEvents == 0 || header.blockEvents > MaxBlockEvents
+               || header.blockCount != header.eventCount / header.blockEvents + (header.eventCount % header.blockEvents != 0)
+               || header.indexOffset < sizeof(header) || header.indexOffset > m_bytes || header.indexOffset % 8 != 0
+               || header.blockCount > (m_bytes - header.indexOffset) / sizeof(MacroBlockEntry)) {
+        problem = "Macro file is truncated or damaged";
+    }
+    if (problem) {
+        m_lastError = problem;
+        close();
+        return false;
+    }
+
+    m_path = path;
+    m_eventCount = static_cast<size_t>(header.eventCount);
+    m_durationUs = header.durationUs;
+    m_blockEvents = header.blockEvents;
+    m_blockCount = static_cast<size_t>(header.blockCount);
+    m_indexOffset = header.indexOffset;
+    m_block.resize(m_blockEvents);
+    m_blockIndex = SIZE_MAX;
+    return true;
+}
+
+void MappedMacroFile::close() {
+#ifdef _WIN32
+    if (m_data) UnmapViewOfFile(m_data);
+    if (m_mapping) CloseHandle(m_mapping);
+    if (m_file) CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    if (m_data) munmap(const_cast<uint8_t*>(m_data), m_bytes);
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+#endif
+    m_data = nullptr;
+    m_bytes = 0;
+    m_path.clear();
+    m_eventCount = 0;
+    m_durationUs = 0;
+    m_blockCount = 0;
+    m_block.clear();
+    m_block.shrink_to_fit();
+    m_blockIndex = SIZE_MAX;
+}
+
+bool MappedMacroFile::read(size_t index, MacroEvent& event) {
+    if (index >= m_eventCount) {
+        return false;
+    }
+    const size_t block = index / m_blockEvents;
+    if (block != m_blockIndex && !decodeBlock(block)) {
+        return false;
+    }
+    event = m_block[index - block * m_blockEvents];
+    return true;
+}
+
+bool MappedMacroFile::decodeBlock(size_t block) {
+    MacroBlockEntry entry;
+    std::memcpy(&entry, m_data + m_indexOffset + block * sizeof(MacroBlockEntry), sizeof(entry));
+
+    const size_t length = std::min(m_blockEvents, m_eventCount - block * m_blockEvents);
+    bool ok = entry.offset >= sizeof(MacroFileHeader) && entry.offset <= m_indexOffset
+           && entry.bytes <= m_indexOffset - entry.offset;
+    const uint8_t* p = m_data + (ok ? entry.offset : 0);
+    const uint8_t* const begin = p;
+    const uint8_t* const end = p + (ok ? entry.bytes : 0);
+    ok = ok && macroChecksum(begin, entry.bytes) == entry.checksum;
+
+    // Unsigned sums: a damaged delta may wrap, but must not be undefined
+    uint64_t time = static_cast<uint64_t>(entry.firstTimeUs);
+    uint64_t absX = 0;
+    uint64_t absY = 0;
+    for (size_t i = 0; ok && i < length; ++i) {
+        uint64_t head = 0;
+        uint64_t a = 0;
+        uint64_t b = 0;
+        ok = getVarint(p, end, head) && (head & 7) <= static_cast<uint64_t>(MacroEvent::Type::KeyUp);
+        if (!ok) {
+            break;
+        }
+        MacroEvent& event = m_block[i];
+        time += static_cast<uint64_t>(unzigzag(head >> 3));
+        event.timeUs = static_cast<int64_t>(time);
+        event.type = static_cast<MacroEvent::Type>(head & 7);
+        event.code = 0;
+        event.x = 0;
+        event.y = 0;
+
+        switch (event.type) {
+        case MacroEvent::Type::Move:
+        case MacroEvent::Type::Wheel:
+            ok = getVarint(p, end, a) && getVarint(p, end, b);
+            event.x = static_cast<int32_t>(unzigzag(a));
+            event.y = static_cast<int32_t>(unzigzag(b));
+            break;
+        case MacroEvent::Type::MoveAbsolute:
+            ok = getVarint(p, end, a) && getVarint(p, end, b);
+            absX += static_cast<uint64_t>(unzigzag(a));
+            absY += static_cast<uint64_t>(unzigzag(b));
+            event.x = static_cast<int32_t>(absX);
+            event.y = static_cast<int32_t>(absY);
+            break;
+        default:
+            ok = getVarint(p, end, a) && a <= UINT16_MAX;
+            event.code = static_cast<uint16_t>(a);
+            break;
+        }
+    }
+    // The block must be used up exactly
+    ok = ok && p == end;
+
+    if (!ok) {
+        m_blockIndex = SIZE_MAX;
+        m_lastError = "Macro file is damaged in block " + std::to_string(block);
+        return false;
+    }
+    m_blockIndex = block;
+    releasePages(begin, end);
+    return true;
+}
+
+void MappedMacroFile::releasePages(const uint8_t* begin, const uint8_t* end) const {
+    // The page shared with the block before goes too: playback has moved past
+    // it, and a mapped page dropped early is simply read from the file again
+    const uintptr_t page = pageSize();
+    const uintptr_t first = reinterpret_cast<uintptr_t>(begin) & ~(page - 1);
+    const uintptr_t last = reinterpret_cast<uintptr_t>(end) & ~(page - 1);
+    if (first >= last) {
+        return;
+    }
+#ifdef _WIN32
+    // Unlocking pages that are not locked takes them out of the working set
+    VirtualUnlock(reinterpret_cast<void*>(first), last - first);
+#else
+    // Clean file pages: they are read back from the file if needed again
+    madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+#endif
+}
@@ -0,0 +1,69 @@
+#ifndef MAPPEDMACROFILE_H
+#define MAPPEDMACROFILE_H
+
+#include "MacroFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A saved macro played straight from a read-only memory mapping. open()
+// checks the header and nothing else, so it returns at once however long
+// the timeline is. Blocks are decoded on demand, found through the block
+// index, into one block-sized buffer; the mapped pages of a block are handed
+// back to the OS once it is decoded, so memory stays constant for a file of
+// any size.
+//
+// A damaged block is only noticed when it is reached: read() then fails and
+// lastError() says where.
+class MappedMacroFile : public MacroTimeline {
+public:
+    MappedMacroFile() = default;
+    ~MappedMacroFile() override;
+
+    MappedMacroFile(const MappedMacroFile&) = delete;
+    MappedMacroFile& operator=(const MappedMacroFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    const std::string& path() const { return m_path; }
+
+    size_t size() const override { return m_eventCount; }
+    int64_t durationUs() const override { return m_durationUs; }
+    bool read(size_t index, MacroEvent& event) override;
+
+    size_t blockCount() const { return m_blockCount; }
+    const std::string& lastError() const { return m_lastError; }
+
+private:
+    bool decodeBlock(size_t block);
+    void releasePages(const uint8_t* begin, const uint8_t* end) const;
+    void setLastErrorFromSystem(const char* what);
+
+    const uint8_t* m_data = nullptr;
+    uint64_t m_bytes = 0;
+    std::string m_path;
+    std::string m_lastError;
+
+    // From the header
+    size_t m_eventCount = 0;
+    int64_t m_durationUs = 0;
+    size_t m_blockEvents = 0;
+    size_t m_blockCount = 0;
+    uint64_t m_indexOffset = 0;
+
+    // The block read() last decoded
+    std::vector<MacroEvent> m_block;
+    size_t m_blockIndex = SIZE_MAX;
+
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+#endif // MAPPEDMACROFILE_H
@@ -0,0 +1,81 @@
+#include "PreciseWaiter.h"
+
+#include <algorithm>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define FLAME_CPU_RELAX() _mm_pause()
+#else
+#define FLAME_CPU_RELAX() std::this_thread::yield()
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+namespace {
+constexpr int CALIBRATION_SAMPLES = 20;
+constexpr std::chrono::microseconds CALIBRATION_SLEEP(1000);
+constexpr std::chrono::microseconds SAFETY_MARGIN(50);
+constexpr std::chrono::microseconds MIN_MARGIN(100);
+constexpr std::chrono::microseconds MAX_MARGIN(4000);
+constexpr std::chrono::microseconds DEFAULT_MARGIN(2000);
+} // namespace
+
+std::atomic<long long> PreciseWaiter::s_spinMarginNs{
+    std::chrono::duration_cast<std::chrono::nanoseconds>(DEFAULT_MARGIN).count()};
+
+std::chrono::nanoseconds PreciseWaiter::calibrate() {
+#ifdef _WIN32
+    // Calibrate under the same timer resolution the engine thread runs with
+    timeBeginPeriod(1);
+#endif
+
+    // The worst wake-up lateness is what the margin has to cover, not the average
+    std::chrono::nanoseconds worst(0);
+    for (int i = 0; i < CALIBRATION_SAMPLES; ++i) {
+        const Clock::time_point before = Clock::now();
+        std::this_thread::sleep_for(CALIBRATION_SLEEP);
+        const auto overshoot = (Clock::now() - before) - CALIBRATION_SLEEP;
+        worst = std::max(worst, std::chrono::duration_cast<std::chrono::nanoseconds>(overshoot));
+    }
+
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+
+    const std::chrono::nanoseconds margin = std::clamp<std::chrono::nanoseconds>(
+        worst + SAFETY_MARGIN, MIN_MARGIN, MAX_MARGIN);
+    s_spinMarginNs.store(margin.count(), std::memory_order_relaxed);
+    return margin;
+}
+
+std::chrono::nanoseconds PreciseWaiter::spinMargin() {
+    return std::chrono::nanoseconds(s_spinMarginNs.load(std::memory_order_relaxed));
+}
+
+std::chrono::nanoseconds PreciseWaiter::spinUntil(Clock::time_point deadline, const std::atomic<bool>& cancel) {
+    const Clock::time_point start = Clock::now();
+    Clock::time_point now = start;
+    while (now < deadline && !cancel.load(std::memory_order_relaxed)) {
+        FLAME_CPU_RELAX();
+        now = Clock::now();
+    }
+    return now - start;
+}
+
+EngineThreadTiming::EngineThreadTiming() {
+#ifdef _WIN32
+    timeBeginPeriod(1);
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+#endif
+}
+
+EngineThreadTiming::~EngineThreadTiming() {
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
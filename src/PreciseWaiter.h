@@ -0,0 +1,72 @@
+#ifndef PRECISEWAITER_H
+#define PRECISEWAITER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+#include "EngineClock.h"
+
+// Hybrid sleep-then-spin waiting for sub-millisecond deadlines.
+// The OS sleep is only trusted up to spinMargin() before the deadline; the rest
+// is spent busy-waiting. The margin is calibrated per machine so the spinning
+// portion (and therefore the CPU burn) stays as small as the scheduler allows.
+class PreciseWaiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Measures how late short OS sleeps wake up and derives the spin margin.
+    // Blocks for a few tens of milliseconds; call once at startup.
+    static std::chrono::nanoseconds calibrate();
+
+    // Calibrated margin, or a conservative default if calibrate() never ran
+    static std::chrono::nanoseconds spinMargin();
+
+    // Latest point the caller may sleep until before switching to spinUntil()
+    static Clock::time_point sleepDeadline(Clock::time_point deadline) { return deadline - spinMargin(); }
+
+    // Busy-waits until deadline or until cancel is set. Returns the time spent spinning.
+    static std::chrono::nanoseconds spinUntil(Clock::time_point deadline, const std::atomic<bool>& cancel);
+
+    // An engine thread's wait for an absolute deadline. A virtual clock jumps
+    // straight there; otherwise the thread sleeps on condition until the
+    // deadline (less the spin margin in high-rate mode) or until interrupted()
+    // holds, then spins the rest unless interrupted or cancelled. Whoever
+    // changes what interrupted() reads does so under mutex and notifies.
+    // Returns the time spent spinning.
+    template <typename Interrupted>
+    static std::chrono::nanoseconds waitUntil(EngineClock& clock, Clock::time_point deadline, bool highRate,
+                                              std::mutex& mutex, std::condition_variable& condition,
+                                              const std::atomic<bool>& cancel, Interrupted interrupted) {
+        if (clock.advanceTo(deadline)) {
+            return std::chrono::nanoseconds(0);
+        }
+        const Clock::time_point coarse = highRate ? sleepDeadline(deadline) : deadline;
+        if (coarse > clock.now()) {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait_until(lock, coarse, interrupted);
+        }
+        if (!highRate || interrupted()) {
+            return std::chrono::nanoseconds(0);
+        }
+        return spinUntil(deadline, cancel);
+    }
+
+private:
+    static std::atomic<long long> s_spinMarginNs;
+};
+
+// Windows: 1 ms scheduler granularity instead of the default 15.6 ms tick and
+// time-critical priority for the calling engine thread, while in scope.
+// Nothing elsewhere.
+class EngineThreadTiming {
+public:
+    EngineThreadTiming();
+    ~EngineThreadTiming();
+
+    EngineThreadTiming(const EngineThreadTiming&) = delete;
+    EngineThreadTiming& operator=(const EngineThreadTiming&) = delete;
+};
+
+#endif // PRECISEWAITER_H
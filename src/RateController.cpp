@@ -0,0 +1,77 @@
+#include "RateController.h"
+
+#include <algorithm>
+
+void RateController::reset(Duration targetPeriod, int targetBurst) {
+    m_targetPeriod = targetPeriod;
+    m_targetBurst = std::max(1, targetBurst);
+    m_period = m_targetPeriod;
+    m_burst = m_targetBurst;
+    m_clean = 0;
+    m_rejected = 0;
+}
+
+RateController::Verdict RateController::record(int requested, int accepted, Duration injection, Duration settled) {
+    const bool rejected = accepted < requested;
+    const Duration blockedFor = std::max(Duration(0), injection - settled);
+    const bool blocked = blockedFor.count() > m_tuning.latencyBudget * static_cast<double>(m_period.count());
+
+    if (!rejected && !blocked) {
+        m_rejected = 0;
+        // Probe back up gently; only a clean window earns the next step
+        if (++m_clean >= m_tuning.cleanWindow) {
+            m_clean = 0;
+            return recover();
+        }
+        return Verdict::Keep;
+    }
+
+    m_clean = 0;
+    m_rejected = accepted == 0 ? m_rejected + 1 : 0;
+    const bool slowest = m_burst == 1 && m_period.count() >= m_targetPeriod.count() * m_tuning.maxSlowdown;
+    if (slowest && m_rejected >= m_tuning.maxRejected) {
+        return Verdict::GiveUp;
+    }
+    // A slow call without rejections halves the batch before the period grows
+    return backOff(rejected ? accepted : m_burst / 2);
+}
+
+double RateController::rateFactor() const {
+    if (m_period.count() <= 0) {
+        return 1.0;
+    }
+    return static_cast<double>(m_burst) / m_targetBurst
+         * static_cast<double>(m_targetPeriod.count()) / static_cast<double>(m_period.count());
+}
+
+RateController::Verdict RateController::backOff(int accepted) {
+    // A batch the queue only partly took is cut to what went through
+    if (m_burst > 1) {
+        ++m_backoffs;
+        m_burst = accepted > 0 ? std::min(accepted, m_burst - 1) : std::max(1, m_burst / 2);
+        return Verdict::Changed;
+    }
+
+    const double maxPeriod = m_targetPeriod.count() * m_tuning.maxSlowdown;
+    const Duration period(static_cast<Duration::rep>(std::min(m_period.count() * m_tuning.backoff, maxPeriod)));
+    if (period == m_period) {
+        return Verdict::Keep;
+    }
+    ++m_backoffs;
+    m_period = period;
+    return Verdict::Changed;
+}
+
+RateController::Verdict RateController::recover() {
+    if (m_period > m_targetPeriod) {
+        const double shorter = m_period.count() * m_tuning.recovery;
+        m_period = Duration(static_cast<Duration::rep>(std::max(shorter, static_cast<double>(m_targetPeriod.count()))));
+        return Verdict::Changed;
+    }
+    if (m_burst < m_targetBurst) {
+        // Additive increase, about 16 steps from one click back to the full burst
+        m_burst = std::min(m_targetBurst, m_burst + std::max(1, m_targetBurst / 16));
+        return Verdict::Changed;
+    }
+    return Verdict::Keep;
+}
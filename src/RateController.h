@@ -0,0 +1,67 @@
+#ifndef RATECONTROLLER_H
+#define RATECONTROLLER_H
+
+#include <chrono>
+#include <cstdint>
+
+// Closed-loop pacing for ClickEngine's adaptive mode, AIMD style like TCP
+// congestion control. Fed one sample per injection, it backs off as soon as
+// the OS input queue or the target pushes back and creeps back towards the
+// requested rate while injections go through cleanly, so a long run settles
+// just below the highest rate the system sustains instead of ending on the
+// first partial send. Engine thread only.
+//
+// Two knobs: the clicks per injection and the period between wake-ups.
+// A batch the queue only partly took shrinks to what it accepted; once down
+// to single clicks, rejections and injections that block for a large share
+// of the period stretch the period instead. Recovery undoes the period first.
+class RateController {
+public:
+    using Duration = std::chrono::nanoseconds;
+
+    struct Tuning {
+        double backoff = 1.5;        // period multiplier on pushback
+        double recovery = 0.95;      // period multiplier after each clean window
+        int cleanWindow = 32;        // clean injections needed for one recovery step
+        double latencyBudget = 0.5;  // injection time above this share of the period is pushback
+        double maxSlowdown = 64.0;   // the period never grows beyond target * maxSlowdown
+        int maxRejected = 32;        // injections in a row with nothing accepted at full slowdown
+    };
+
+    enum class Verdict {
+        Keep,    // carry on as before
+        Changed, // period() or burst() moved; reschedule from the last deadline
+        GiveUp   // the OS keeps rejecting everything even at the slowest rate
+    };
+
+    RateController() = default;
+    explicit RateController(const Tuning& tuning) : m_tuning(tuning) {}
+
+    // Starts over at the requested period and clicks per injection
+    void reset(Duration targetPeriod, int targetBurst);
+
+    // `injection` is the whole click call; `settled` the part of it spent
+    // waiting on purpose, which is not pushback
+    Verdict record(int requested, int accepted, Duration injection, Duration settled = Duration(0));
+
+    Duration period() const { return m_period; }
+    int burst() const { return m_burst; }
+    // Share of the requested rate currently in force, 1.0 when on target
+    double rateFactor() const;
+    int64_t backoffs() const { return m_backoffs; }
+
+private:
+    Verdict backOff(int accepted);
+    Verdict recover();
+
+    Tuning m_tuning;
+    Duration m_targetPeriod{0};
+    int m_targetBurst = 1;
+    Duration m_period{0};
+    int m_burst = 1;
+    int m_clean = 0;
+    int m_rejected = 0;
+    int64_t m_backoffs = 0;
+};
+
+#endif // RATECONTROLLER_H
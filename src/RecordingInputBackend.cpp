@@ -0,0 +1,86 @@
+#include "RecordingInputBackend.h"
+
+#include <algorithm>
+
+RecordingInputBackend::RecordingInputBackend(size_t capacity, const EngineClock* clock)
+    : m_clock(clock ? clock : SteadyEngineClock::instance()) {
+    m_records.reserve(capacity);
+}
+
+void RecordingInputBackend::reset() {
+    m_records.clear();
+    m_submits.store(0, std::memory_order_relaxed);
+    m_totalEvents.store(0, std::memory_order_relaxed);
+    m_buttonDowns.store(0, std::memory_order_relaxed);
+    m_buttonUps.store(0, std::memory_order_relaxed);
+    m_moves.store(0, std::memory_order_relaxed);
+    m_keyDowns.store(0, std::memory_order_relaxed);
+    m_keyUps.store(0, std::memory_order_relaxed);
+}
+
+bool RecordingInputBackend::virtualScreen(ScreenRect& rect) const {
+    rect = m_screen;
+    return true;
+}
+
+bool RecordingInputBackend::cursorPosition(int& x, int& y) {
+    x = m_cursorX;
+    y = m_cursorY;
+    return true;
+}
+
+bool RecordingInputBackend::setCursorPosition(int x, int y) {
+    InputBatch batch;
+    batch.moveTo(x, y);
+    return submit(batch) == 1;
+}
+
+int RecordingInputBackend::submit(const InputBatch& batch) {
+    const int64_t submitIndex = m_submits.fetch_add(1, std::memory_order_relaxed);
+    if (m_failAfter >= 0 && submitIndex >= m_failAfter) {
+        m_lastError = "Simulated injection failure";
+        return 0;
+    }
+
+    const int accepted = submitIndex == m_cutSubmit ? std::min(m_cutEvents, batch.size()) : batch.size();
+    const EngineClock::Clock::time_point now = m_clock->now();
+    for (int i = 0; i < accepted; ++i) {
+        const InputEvent& event = batch.events()[i];
+        switch (event.type) {
+        case InputEvent::Type::MoveAbsolute:
+            m_cursorX = event.x;
+            m_cursorY = event.y;
+            m_moves.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case InputEvent::Type::ButtonDown:
+            m_buttonDowns.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case InputEvent::Type::ButtonUp:
+            m_buttonUps.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case InputEvent::Type::MoveRelative:
+            m_cursorX += event.x;
+            m_cursorY += event.y;
+            m_moves.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case InputEvent::Type::Wheel:
+            break;
+        case InputEvent::Type::KeyDown:
+            m_keyDowns.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case InputEvent::Type::KeyUp:
+            m_keyUps.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+
+        // Never grow past the preallocated capacity
+        if (m_records.size() < m_records.capacity()) {
+            m_records.push_back({now, event});
+        }
+    }
+    m_totalEvents.fetch_add(accepted, std::memory_order_relaxed);
+    if (accepted < batch.size()) {
+        m_lastError = "Simulated full input queue";
+    }
+    return accepted;
+}
@@ -0,0 +1,72 @@
+#ifndef RECORDINGINPUTBACKEND_H
+#define RECORDINGINPUTBACKEND_H
+
+#include "EngineClock.h"
+#include "InputBackend.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Mock backend that injects nothing and records every submitted event.
+// The event buffer is allocated up front; once it is full only the counters
+// keep going, so arbitrarily long simulated runs never allocate on submit().
+class RecordingInputBackend : public InputBackend {
+public:
+    struct Record {
+        EngineClock::Clock::time_point time;
+        InputEvent event;
+    };
+
+    // Timestamps come from clock (the engine's clock, real or virtual)
+    explicit RecordingInputBackend(size_t capacity, const EngineClock* clock = SteadyEngineClock::instance());
+
+    void setScreen(const ScreenRect& rect) { m_screen = rect; }
+    // Makes every submit() after the first n fail, to exercise error paths
+    void failAfterSubmits(int64_t n) { m_failAfter = n; }
+    // Makes submit number index take only its first events events, like an
+    // input queue that fills up halfway through a batch
+    void cutSubmit(int64_t index, int events) {
+        m_cutSubmit = index;
+        m_cutEvents = events;
+    }
+    void reset();
+
+    const char* name() const override { return "recording"; }
+    bool open() override { return true; }
+    bool virtualScreen(ScreenRect& rect) const override;
+    bool cursorPosition(int& x, int& y) override;
+    bool setCursorPosition(int x, int y) override;
+    int submit(const InputBatch& batch) override;
+
+    // Read after the engine has stopped; counters may also be sampled live
+    const std::vector<Record>& records() const { return m_records; }
+    int64_t submits() const { return m_submits.load(std::memory_order_relaxed); }
+    int64_t totalEvents() const { return m_totalEvents.load(std::memory_order_relaxed); }
+    int64_t buttonDowns() const { return m_buttonDowns.load(std::memory_order_relaxed); }
+    int64_t buttonUps() const { return m_buttonUps.load(std::memory_order_relaxed); }
+    int64_t moves() const { return m_moves.load(std::memory_order_relaxed); }
+    int64_t keyDowns() const { return m_keyDowns.load(std::memory_order_relaxed); }
+    int64_t keyUps() const { return m_keyUps.load(std::memory_order_relaxed); }
+    int64_t droppedRecords() const { return totalEvents() - static_cast<int64_t>(m_records.size()); }
+
+private:
+    const EngineClock* m_clock;
+    ScreenRect m_screen{0, 0, 1920, 1080};
+    int m_cursorX = 0;
+    int m_cursorY = 0;
+    int64_t m_failAfter = -1;
+    int64_t m_cutSubmit = -1;
+    int m_cutEvents = 0;
+
+    std::vector<Record> m_records;
+    std::atomic<int64_t> m_submits{0};
+    std::atomic<int64_t> m_totalEvents{0};
+    std::atomic<int64_t> m_buttonDowns{0};
+    std::atomic<int64_t> m_buttonUps{0};
+    std::atomic<int64_t> m_moves{0};
+    std::atomic<int64_t> m_keyDowns{0};
+    std::atomic<int64_t> m_keyUps{0};
+};
+
+#endif // RECORDINGINPUTBACKEND_H
@@ -0,0 +1,110 @@
+#include "RingLogger.h"
+
+#include <chrono>
+#include <cstdio>
+
+RingLogger& RingLogger::instance() {
+    static RingLogger logger;
+    return logger;
+}
+
+RingLogger::RingLogger() {
+    for (uint64_t i = 0; i < Capacity; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    m_sink = [](Level, const char* message) { std::fprintf(stderr, "%s\n", message); };
+}
+
+RingLogger::~RingLogger() {
+    stop();
+}
+
+void RingLogger::start() {
+    if (m_running.exchange(true)) {
+        return;
+    }
+    m_thread = std::thread(&RingLogger::run, this);
+}
+
+void RingLogger::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_running.store(false);
+    }
+    m_wake.notify_all();
+
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool RingLogger::push(Level level, const char* format, const long long* args) {
+    uint64_t position = m_head.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &m_slots[position & (Capacity - 1)];
+        const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        const int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+        if (diff == 0) {
+            if (m_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Full: the flush thread has not caught up
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = m_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->entry.format = format;
+    slot->entry.level = level;
+    for (int i = 0; i < MaxArgs; ++i) {
+        slot->entry.args[i] = args[i];
+    }
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool RingLogger::pop(Entry& entry) {
+    Slot& slot = m_slots[m_tail & (Capacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != m_tail + 1) {
+        return false;
+    }
+    entry = slot.entry;
+    slot.sequence.store(m_tail + Capacity, std::memory_order_release);
+    ++m_tail;
+    return true;
+}
+
+void RingLogger::drain() {
+    Entry entry;
+    char message[512];
+    while (pop(entry)) {
+        std::snprintf(message, sizeof(message), entry.format,
+                      entry.args[0], entry.args[1], entry.args[2], entry.args[3]);
+        m_sink(entry.level, message);
+    }
+
+    const int64_t dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_reportedDrops) {
+        std::snprintf(message, sizeof(message), "Log ring full, dropped %lld message(s)",
+                      static_cast<long long>(dropped - m_reportedDrops));
+        m_sink(Level::Warning, message);
+        m_reportedDrops = dropped;
+    }
+}
+
+void RingLogger::run() {
+    // Producers never signal; polling keeps log() free of any syscall
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    while (m_running.load()) {
+        m_wake.wait_for(lock, std::chrono::milliseconds(50));
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+    lock.unlock();
+    drain();
+}
@@ -0,0 +1,107 @@
+#ifndef RINGLOGGER_H
+#define RINGLOGGER_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+// Levels below FLAME_LOG_LEVEL compile away entirely. Release builds keep
+// Info and above, debug builds keep everything.
+#ifndef FLAME_LOG_LEVEL
+#ifdef NDEBUG
+#define FLAME_LOG_LEVEL 2
+#else
+#define FLAME_LOG_LEVEL 0
+#endif
+#endif
+
+// FLAME_LOG(Trace, "click %lld", n): printf-style format literal with up to
+// four integer arguments, formatted later on the logger thread (use %lld).
+#define FLAME_LOG(level, ...)                                                              \
+    do {                                                                                   \
+        if constexpr (RingLogger::compiledIn(RingLogger::Level::level)) {                  \
+            RingLogger::instance().log(RingLogger::Level::level, __VA_ARGS__);             \
+        }                                                                                  \
+    } while (0)
+
+// Logger for threads that must not block or allocate, such as the click
+// engine. log() copies the format pointer and raw arguments into a bounded
+// lock-free ring; a background thread formats them and hands the text to
+// the sink. When the ring is full, entries are dropped and counted.
+class RingLogger {
+public:
+    enum class Level {
+        Trace,
+        Debug,
+        Info,
+        Warning
+    };
+
+    using Sink = std::function<void(Level level, const char* message)>;
+
+    static RingLogger& instance();
+
+    static constexpr bool compiledIn(Level level) { return static_cast<int>(level) >= FLAME_LOG_LEVEL; }
+
+    ~RingLogger();
+
+    // Defaults to stderr. Set before start().
+    void setSink(Sink sink) { m_sink = std::move(sink); }
+
+    // Starts the flush thread; stop() drains what is left and joins it
+    void start();
+    void stop();
+
+    template <typename... Args>
+    bool log(Level level, const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= MaxArgs, "RingLogger takes at most four arguments");
+        static_assert((std::is_integral<Args>::value && ...), "RingLogger only takes integer arguments");
+        const long long values[MaxArgs + 1] = {static_cast<long long>(args)..., 0};
+        return push(level, format, values);
+    }
+
+    int64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int MaxArgs = 4;
+    static constexpr uint64_t Capacity = 1024; // power of two
+
+    struct Entry {
+        const char* format = nullptr;
+        long long args[MaxArgs] = {};
+        Level level = Level::Info;
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        Entry entry;
+    };
+
+    RingLogger();
+
+    bool push(Level level, const char* format, const long long* args);
+    bool pop(Entry& entry);
+    void drain();
+    void run();
+
+    // Bounded queue after Vyukov: each slot's sequence says whose turn it is,
+    // so producers claim slots with one CAS and never wait for each other
+    std::array<Slot, Capacity> m_slots;
+    alignas(64) std::atomic<uint64_t> m_head{0};
+    alignas(64) uint64_t m_tail = 0; // flush thread only
+    std::atomic<int64_t> m_dropped{0};
+    int64_t m_reportedDrops = 0;
+
+    Sink m_sink;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+};
+
+#endif // RINGLOGGER_H
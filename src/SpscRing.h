@@ -0,0 +1,70 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded single-producer / single-consumer queue. push() and pop() are
+// wait-free: one relaxed load, one acquire load and one release store each.
+// A full ring rejects the push instead of waiting, so a slow consumer can
+// never hold up the producer.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side
+    bool push(const T& value) {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == Capacity) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_items[head & (Capacity - 1)] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool pop(T& value) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = m_items[tail & (Capacity - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; calls fn for everything queued at the time of the call
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t head = m_head.load(std::memory_order_acquire);
+        for (size_t i = tail; i != head; ++i) {
+            fn(m_items[i & (Capacity - 1)]);
+        }
+        m_tail.store(head, std::memory_order_release);
+        return head - tail;
+    }
+
+    // Only while neither side is running
+    void reset() {
+        m_head.store(0, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_dropped.store(0, std::memory_order_relaxed);
+    }
+
+    int64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    // Indices on separate cache lines so the two threads don't share one
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+    alignas(64) std::atomic<int64_t> m_dropped{0};
+    std::array<T, Capacity> m_items{};
+};
+
+#endif // SPSCRING_H
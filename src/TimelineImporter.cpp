@@ -0,0 +1,545 @@
+#include "TimelineImporter.h"
+#include "DisplayCache.h"
+#include "InputCodes.h"
+#include "MacroFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+constexpr size_t ChunkBytes = size_t(8) << 20;
+// Below this a chunk is not worth another thread
+constexpr size_t MinSliceBytes = size_t(256) << 10;
+constexpr int MaxCsvColumns = 16;
+
+struct Click {
+    int64_t timeUs;
+    int32_t x;
+    int32_t y;
+    uint16_t code;
+};
+
+// CSV field positions, from the header row if there is one; button -1 if absent
+struct Columns {
+    int time = 0;
+    int x = 1;
+    int y = 2;
+    int button = 3;
+};
+
+// A run of whole lines, parsed by one thread
+struct Slice {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    std::vector<Click> clicks;
+    uint64_t lines = 0;
+    uint64_t offScreen = 0;
+    bool sorted = true;
+    uint64_t errorLine = 0; // within the slice, 1-based
+    const char* error = nullptr;
+};
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+std::string_view unquote(std::string_view text) {
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+        return text.substr(1, text.size() - 2);
+    }
+    return text;
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+template <typename T>
+bool parseInt(std::string_view text, T& value) {
+    text = trim(text);
+    if (!text.empty() && text.front() == '+') {
+        text.remove_prefix(1);
+    }
+    const char* end = text.data() + text.size();
+    const auto parsed = std::from_chars(text.data(), end, value);
+    return !text.empty() && parsed.ec == std::errc() && parsed.ptr == end;
+}
+
+bool parseButton(std::string_view text, uint16_t& code) {
+    static constexpr const char* Names[] = {"left", "right", "middle", "back", "forward"};
+    text = unquote(trim(text));
+    int index = 0;
+    if (text.empty()) {
+        index = 0;
+    } else if (parseInt(text, index)) {
+        if (index < 0 || index > static_cast<int>(MouseButton::Forward)) {
+            return false;
+        }
+    } else {
+        const auto name = std::find_if(std::begin(Names), std::end(Names), [text](const char* candidate) {
+            return equalsIgnoreCase(text, candidate);
+        });
+        if (name == std::end(Names)) {
+            return false;
+        }
+        index = static_cast<int>(name - std::begin(Names));
+    }
+    code = codeFromMouseButton(static_cast<MouseButton>(index));
+    return true;
+}
+
+int splitCsv(std::string_view line, std::string_view (&fields)[MaxCsvColumns]) {
+    int count = 0;
+    for (;;) {
+        const size_t comma = line.find(',');
+        fields[count++] = trim(line.substr(0, comma));
+        if (comma == std::string_view::npos || count == MaxCsvColumns) {
+            return count;
+        }
+        line.remove_prefix(comma + 1);
+    }
+}
+
+// A first CSV line naming its columns, quoted or not, rather than a row
+bool isHeader(std::string_view line) {
+    std::string_view fields[MaxCsvColumns];
+    splitCsv(line, fields);
+    const std::string_view first = unquote(fields[0]);
+    return !first.empty() && std::isalpha(static_cast<unsigned char>(first.front()));
+}
+
+// Both formats take the same names for the time column
+bool isTimeName(std::string_view name) {
+    return equalsIgnoreCase(name, "t_us") || equalsIgnoreCase(name, "time_us") || equalsIgnoreCase(name, "t");
+}
+
+bool parseHeader(std::string_view line, Columns& columns) {
+    std::string_view fields[MaxCsvColumns];
+    const int count = splitCsv(line, fields);
+    columns = {-1, -1, -1, -1};
+    for (int i = 0; i < count; ++i) {
+        const std::string_view name = unquote(fields[i]);
+        if (isTimeName(name)) {
+            columns.time = i;
+        } else if (equalsIgnoreCase(name, "x")) {
+            columns.x = i;
+        } else if (equalsIgnoreCase(name, "y")) {
+            columns.y = i;
+        } else if (equalsIgnoreCase(name, "button")) {
+            columns.button = i;
+        }
+    }
+    return columns.time >= 0 && columns.x >= 0 && columns.y >= 0;
+}
+
+// Each returns nullptr on success, else what is wrong with the line
+const char* parseCsv(std::string_view line, const Columns& columns, Click& click) {
+    std::string_view fields[MaxCsvColumns];
+    const int count = splitCsv(line, fields);
+    if (count <= std::max({columns.time, columns.x, columns.y})) {
+        return "missing columns";
+    }
+    if (!parseInt(unquote(fields[columns.time]), click.timeUs) || click.timeUs < 0) {
+        return "t_us is not a non-negative integer";
+    }
+    if (!parseInt(unquote(fields[columns.x]), click.x) || !parseInt(unquote(fields[columns.y]), click.y)) {
+        return "x or y is not an integer";
+    }
+    click.code = InputCode::BtnLeft;
+    if (columns.button >= 0 && columns.button < count && !parseButton(fields[columns.button], click.code)) {
+        return "unknown button";
+    }
+    return nullptr;
+}
+
+// Flat objects only: string and number values, no escapes or nesting
+const char* parseJson(std::string_view line, Click& click) {
+    size_t i = 0;
+    const auto skipSpace = [&]() {
+        while (i < line.size() && std::isspace(static_cast<unsigned char>(line[i]))) {
+            ++i;
+        }
+    };
+
+    skipSpace();
+    if (i == line.size() || line[i] != '{') {
+        return "not a JSON object";
+    }
+    ++i;
+    bool hasTime = false;
+    bool hasX = false;
+    bool hasY = false;
+    click.code = InputCode::BtnLeft;
+
+    skipSpace();
+    bool more = i < line.size() && line[i] != '}';
+    if (!more) {
+        ++i;
+    }
+    while (more) {
+        skipSpace();
+        if (i == line.size() || line[i] != '"') {
+            return "expected a key";
+        }
+        const size_t keyEnd = line.find('"', i + 1);
+        if (keyEnd == std::string_view::npos) {
+            return "unterminated key";
+        }
+        const std::string_view key = line.substr(i + 1, keyEnd - i - 1);
+        i = keyEnd + 1;
+        skipSpace();
+        if (i == line.size() || line[i] != ':') {
+            return "expected ':'";
+        }
+        ++i;
+        skipSpace();
+
+        std::string_view value;
+        bool quoted = false;
+        if (i < line.size() && line[i] == '"') {
+            const size_t valueEnd = line.find('"', i + 1);
+            if (valueEnd == std::string_view::npos) {
+                return "unterminated string";
+            }
+            value = line.substr(i + 1, valueEnd - i - 1);
+            i = valueEnd + 1;
+            quoted = true;
+        } else {
+            const size_t start = i;
+            while (i < line.size() && line[i] != ',' && line[i] != '}') {
+                ++i;
+            }
+            value = trim(line.substr(start, i - start));
+        }
+
+        if (isTimeName(key)) {
+            if (quoted || !parseInt(value, click.timeUs) || click.timeUs < 0) {
+                return "t_us is not a non-negative integer";
+            }
+            hasTime = true;
+        } else if (equalsIgnoreCase(key, "x") || equalsIgnoreCase(key, "y")) {
+            const bool isX = equalsIgnoreCase(key, "x");
+            if (quoted || !parseInt(value, isX ? click.x : click.y)) {
+                return "x or y is not an integer";
+            }
+            (isX ? hasX : hasY) = true;
+        } else if (equalsIgnoreCase(key, "button")) {
+            if (!parseButton(value, click.code)) {
+                return "unknown button";
+            }
+        }
+
+        skipSpace();
+        if (i < line.size() && line[i] == ',') {
+            ++i;
+        } else if (i < line.size() && line[i] == '}') {
+            ++i;
+            more = false;
+        } else {
+            return "expected ',' or '}'";
+        }
+    }
+
+    skipSpace();
+    if (i != line.size()) {
+        return "text after the object";
+    }
+    if (!hasTime || !hasX || !hasY) {
+        return "t_us, x or y missing";
+    }
+    return nullptr;
+}
+
+void parseSlice(Slice& slice, TimelineFormat format, const Columns& columns, const std::vector<ScreenRect>& screens) {
+    int64_t last = INT64_MIN;
+    const char* p = slice.begin;
+    while (p < slice.end) {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(slice.end - p)));
+        const char* lineEnd = newline ? newline : slice.end;
+        const std::string_view line = trim(std::string_view(p, static_cast<size_t>(lineEnd - p)));
+        p = newline ? newline + 1 : slice.end;
+        ++slice.lines;
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+
+        Click click;
+        const char* error = format == TimelineFormat::Csv ? parseCsv(line, columns, click) : parseJson(line, click);
+        if (error) {
+            slice.error = error;
+            slice.errorLine = slice.lines;
+            return;
+        }
+        if (!screens.empty() && std::none_of(screens.begin(), screens.end(), [&click](const ScreenRect& screen) {
+                return screen.contains(click.x, click.y);
+            })) {
+            ++slice.offScreen;
+            continue;
+        }
+        slice.sorted = slice.sorted && click.timeUs >= last;
+        last = click.timeUs;
+        slice.clicks.push_back(click);
+    }
+}
+
+TimelineFormat formatOf(const std::string& path) {
+    const size_t dot = path.find_last_of('.');
+    const std::string_view extension = dot == std::string::npos ? std::string_view() : std::string_view(path).substr(dot + 1);
+    if (equalsIgnoreCase(extension, "csv")) {
+        return TimelineFormat::Csv;
+    }
+    if (equalsIgnoreCase(extension, "ndjson") || equalsIgnoreCase(extension, "jsonl") || equalsIgnoreCase(extension, "json")) {
+        return TimelineFormat::NdJson;
+    }
+    return TimelineFormat::Auto;
+}
+
+bool appendClick(MacroFileWriter& writer, const Click& click) {
+    MacroEvent event;
+    event.timeUs = click.timeUs;
+    event.type = MacroEvent::Type::MoveAbsolute;
+    event.x = click.x;
+    event.y = click.y;
+    bool ok = writer.append(event);
+    event.type = MacroEvent::Type::ButtonDown;
+    event.code = click.code;
+    event.x = event.y = 0;
+    ok = ok && writer.append(event);
+    event.type = MacroEvent::Type::ButtonUp;
+    return ok && writer.append(event);
+}
+
+// Reads the input chunk by chunk and hands each parsed slice to consume, in
+// file order. Stops early, returning false, when consume does; an error
+// of its own is reported in error.
+bool readTimeline(FILE* input, const std::string& source, TimelineFormat& format, unsigned threads,
+                  const std::vector<ScreenRect>& screens, TimelineImportResult& result, std::string& error,
+                  const std::function<bool(const Slice&)>& consume) {
+    std::vector<Slice> slices(threads);
+    std::vector<char> buffer(ChunkBytes);
+    Columns columns;
+    size_t carried = 0;
+    uint64_t lineBase = 0;
+    bool first = true;
+
+    for (;;) {
+        const size_t got = std::fread(buffer.data() + carried, 1, buffer.size() - carried, input);
+        if (std::ferror(input)) {
+            error = "Cannot read " + source + ": " + std::strerror(errno);
+            return false;
+        }
+        result.inputBytes += got;
+        const size_t filled = carried + got;
+        const bool atEnd = filled < buffer.size();
+
+        // Whole lines only; the tail waits for the next chunk
+        size_t usable = filled;
+        if (!atEnd) {
+            while (usable > 0 && buffer[usable - 1] != '\n') {
+                --usable;
+            }
+            if (usable == 0) {
+                error = "Line " + std::to_string(lineBase + 1) + " is too long";
+                return false;
+            }
+        }
+        const char* begin = buffer.data();
+        const char* const end = begin + usable;
+
+        if (first) {
+            first = false;
+            if (usable >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0) {
+                begin += 3;
+            }
+            const char* text = begin;
+            while (text < end && std::isspace(static_cast<unsigned char>(*text))) {
+                ++text;
+            }
+            if (format == TimelineFormat::Auto) {
+                format = text < end && *text == '{' ? TimelineFormat::NdJson : TimelineFormat::Csv;
+            }
+            const char* newline = static_cast<const char*>(std::memchr(text, '\n', static_cast<size_t>(end - text)));
+            const char* headerEnd = newline ? newline : end;
+            const std::string_view line(text, static_cast<size_t>(headerEnd - text));
+            if (format == TimelineFormat::Csv && isHeader(line)) {
+                if (!parseHeader(line, columns)) {
+                    error = "The CSV header needs t_us, x and y columns";
+                    return false;
+                }
+                lineBase = 1 + static_cast<uint64_t>(std::count(begin, text, '\n'));
+                begin = newline ? newline + 1 : end;
+            }
+        }
+
+        // Split at line boundaries, one slice per thread
+        const size_t bytes = static_cast<size_t>(end - begin);
+        const size_t count = std::max<size_t>(1, std::min<size_t>(threads, bytes / MinSliceBytes));
+        const char* sliceBegin = begin;
+        for (size_t k = 0; k < count; ++k) {
+            Slice& slice = slices[k];
+            const char* sliceEnd = end;
+            if (k + 1 < count) {
+                sliceEnd = begin + bytes * (k + 1) / count;
+                sliceEnd = std::max(sliceEnd, sliceBegin);
+                const char* newline = static_cast<const char*>(std::memchr(sliceEnd, '\n', static_cast<size_t>(end - sliceEnd)));
+                sliceEnd = newline ? newline + 1 : end;
+            }
+            slice.begin = sliceBegin;
+            slice.end = sliceEnd;
+            slice.clicks.clear();
+            slice.lines = 0;
+            slice.offScreen = 0;
+            slice.sorted = true;
+            slice.error = nullptr;
+            sliceBegin = sliceEnd;
+        }
+
+        std::vector<std::thread> workers;
+        workers.reserve(count - 1);
+        for (size_t k = 1; k < count; ++k) {
+            workers.emplace_back(parseSlice, std::ref(slices[k]), format, std::cref(columns), std::cref(screens));
+        }
+        parseSlice(slices[0], format, columns, screens);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        for (size_t k = 0; k < count; ++k) {
+            const Slice& slice = slices[k];
+            if (slice.error) {
+                error = "Line " + std::to_string(lineBase + slice.errorLine) + ": " + slice.error;
+                return false;
+            }
+            if (!consume(slice)) {
+                return false;
+            }
+            result.offScreen += slice.offScreen;
+            lineBase += slice.lines;
+        }
+
+        if (atEnd) {
+            return true;
+        }
+        carried = filled - usable;
+        std::memmove(buffer.data(), buffer.data() + usable, carried);
+    }
+}
+} // namespace
+
+bool importTimeline(const std::string& source, const std::string& target, const TimelineImportOptions& options,
+                    TimelineImportResult& result, std::string& error) {
+    const auto started = std::chrono::steady_clock::now();
+    result = TimelineImportResult();
+    error.clear();
+
+    FILE* input = std::fopen(source.c_str(), "rb");
+    if (!input) {
+        error = "Cannot open " + source + ": " + std::strerror(errno);
+        return false;
+    }
+
+    // One snapshot for the whole import; a gap between monitors counts as off-screen
+    std::vector<ScreenRect> screens;
+    if (options.display && options.display->isValid()) {
+        for (const MonitorInfo& monitor : options.display->monitors()) {
+            screens.push_back(monitor.rect);
+        }
+        if (screens.empty()) {
+            screens.push_back(options.display->virtualDesktop());
+        }
+    }
+
+    const unsigned threads = options.threads > 0 ? static_cast<unsigned>(options.threads)
+                                                 : std::max(1u, std::thread::hardware_concurrency());
+    TimelineFormat format = options.format == TimelineFormat::Auto ? formatOf(source) : options.format;
+
+    // Rows in time order, the usual case, go straight into the macro file a
+    // chunk at a time, so memory does not grow with the input
+    MacroFileWriter writer;
+    bool ok = writer.open(target);
+    if (!ok) {
+        error = writer.lastError();
+    }
+    int64_t last = INT64_MIN;
+    ok = ok && readTimeline(input, source, format, threads, screens, result, error, [&](const Slice& slice) {
+        if (!slice.sorted || (!slice.clicks.empty() && slice.clicks.front().timeUs < last)) {
+            result.sorted = false;
+            return false;
+        }
+        for (const Click& click : slice.clicks) {
+            if (!appendClick(writer, click)) {
+                error = writer.lastError();
+                return false;
+            }
+        }
+        if (!slice.clicks.empty()) {
+            last = slice.clicks.back().timeUs;
+        }
+        result.clicks += slice.clicks.size();
+        return true;
+    });
+
+    // Out of order: start over from the top, collect every row and sort. The
+    // rows already streamed are in the abandoned file, not in memory.
+    std::vector<Click> clicks;
+    if (!result.sorted) {
+        result = TimelineImportResult();
+        result.sorted = false;
+        std::rewind(input);
+        ok = writer.open(target);
+        if (!ok) {
+            error = writer.lastError();
+        }
+        ok = ok && readTimeline(input, source, format, threads, screens, result, error, [&](const Slice& slice) {
+            clicks.insert(clicks.end(), slice.clicks.begin(), slice.clicks.end());
+            return true;
+        });
+        std::stable_sort(clicks.begin(), clicks.end(), [](const Click& a, const Click& b) {
+            return a.timeUs < b.timeUs;
+        });
+        for (size_t i = 0; ok && i < clicks.size(); ++i) {
+            ok = appendClick(writer, clicks[i]);
+            if (!ok) {
+                error = writer.lastError();
+            }
+        }
+        result.clicks = clicks.size();
+    }
+    std::fclose(input);
+
+    if (ok && result.clicks == 0) {
+        error = result.offScreen > 0 ? "Every click is off-screen" : "No clicks in " + source;
+        ok = false;
+    }
+    // An unfinished writer removes its file when it goes out of scope
+    if (ok && !writer.finish()) {
+        error = writer.lastError();
+        ok = false;
+    }
+    if (ok) {
+        result.outputBytes = writer.size();
+    }
+
+    if (!ok) {
+        result.clicks = 0;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return ok;
+}
@@ -0,0 +1,53 @@
+#ifndef TIMELINEIMPORTER_H
+#define TIMELINEIMPORTER_H
+
+#include <cstdint>
+#include <string>
+
+class DisplayCache;
+
+// Bulk import of click schedules into a macro file. Every row is one click
+// at an absolute time since the start of the schedule:
+//
+//   CSV     t_us,x,y[,button]      an optional header row names the columns
+//   NDJSON  {"t_us": 1000, "x": 10, "y": 20, "button": "left"}
+//
+// Either format also takes time_us or t for the time, and any letter case.
+// button is left (the default), right, middle, back, forward or 0-4. The
+// input is read in large chunks, each parsed by several threads at once.
+// Rows already in time order are written out chunk by chunk; otherwise the
+// input is read again, collected and sorted (stable, so equal times keep file
+// order). Each row becomes a MoveAbsolute, ButtonDown and ButtonUp event,
+// which the player sends as one injection.
+
+enum class TimelineFormat {
+    Auto,  // by extension (.csv, .ndjson/.jsonl/.json), else by the first character
+    Csv,
+    NdJson
+};
+
+struct TimelineImportOptions {
+    TimelineFormat format = TimelineFormat::Auto;
+    // Clicks off every monitor are skipped; nullptr accepts any position
+    const DisplayCache* display = nullptr;
+    int threads = 0; // 0: one per hardware thread
+};
+
+struct TimelineImportResult {
+    uint64_t clicks = 0;      // rows written
+    uint64_t offScreen = 0;   // rows skipped by the display check
+    uint64_t inputBytes = 0;
+    uint64_t outputBytes = 0;
+    bool sorted = true;       // already in time order, no sort needed
+    double seconds = 0.0;
+
+    double rowsPerSecond() const { return seconds > 0 ? (clicks + offScreen) / seconds : 0.0; }
+    double megabytesPerSecond() const { return seconds > 0 ? inputBytes / 1e6 / seconds : 0.0; }
+};
+
+// Converts source into a macro file at target. A malformed row fails the
+// whole import, with its line number in error, and leaves no target behind.
+bool importTimeline(const std::string& source, const std::string& target, const TimelineImportOptions& options,
+                    TimelineImportResult& result, std::string& error);
+
+#endif // TIMELINEIMPORTER_H
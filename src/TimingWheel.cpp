@@ -0,0 +1,175 @@
+#include "TimingWheel.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+int lowestBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(value);
+#endif
+}
+
+uint64_t rotateRight(uint64_t value, int shift) {
+    return shift == 0 ? value : (value >> shift) | (value << (64 - shift));
+}
+} // namespace
+
+void TimingWheel::reserve(int capacity) {
+    if (capacity <= static_cast<int>(m_level.size())) {
+        return;
+    }
+    m_expiry.resize(capacity, 0);
+    m_next.resize(capacity, -1);
+    m_prev.resize(capacity, -1);
+    m_level.resize(capacity, -1);
+    m_slot.resize(capacity, 0);
+    m_due.reserve(capacity);
+    m_moving.reserve(capacity);
+}
+
+void TimingWheel::clear() {
+    for (int level = 0; level < Levels; ++level) {
+        std::fill(std::begin(m_heads[level]), std::end(m_heads[level]), -1);
+        m_occupied[level] = 0;
+    }
+    std::fill(m_level.begin(), m_level.end(), int8_t(-1));
+    m_now = 0;
+    m_size = 0;
+}
+
+void TimingWheel::schedule(int id, uint64_t expiry) {
+    if (isScheduled(id)) {
+        unlink(id);
+    }
+
+    // Overdue entries land in the current slot
+    const uint64_t at = std::max(expiry, m_now);
+    m_expiry[id] = at;
+
+    const uint64_t distance = at - m_now;
+    int level = 0;
+    while (level < Levels - 1 && distance >= span(level + 1)) {
+        ++level;
+    }
+
+    // Beyond the horizon: park in the top slot the wheel reaches last and
+    // place it again from there
+    const int slot = distance >= span(Levels) ? slotOf(m_now, Levels - 1) : slotOf(at, level);
+    link(id, level, slot);
+}
+
+void TimingWheel::cancel(int id) {
+    if (isScheduled(id)) {
+        unlink(id);
+    }
+}
+
+void TimingWheel::link(int id, int level, int slot) {
+    const int head = m_heads[level][slot];
+    m_next[id] = head;
+    m_prev[id] = -1;
+    if (head >= 0) {
+        m_prev[head] = id;
+    }
+    m_heads[level][slot] = id;
+    m_occupied[level] |= uint64_t(1) << slot;
+    m_level[id] = static_cast<int8_t>(level);
+    m_slot[id] = static_cast<int8_t>(slot);
+    ++m_size;
+}
+
+void TimingWheel::unlink(int id) {
+    const int level = m_level[id];
+    const int slot = m_slot[id];
+    if (m_prev[id] >= 0) {
+        m_next[m_prev[id]] = m_next[id];
+    } else {
+        m_heads[level][slot] = m_next[id];
+    }
+    if (m_next[id] >= 0) {
+        m_prev[m_next[id]] = m_prev[id];
+    }
+    if (m_heads[level][slot] < 0) {
+        m_occupied[level] &= ~(uint64_t(1) << slot);
+    }
+    m_level[id] = -1;
+    --m_size;
+}
+
+int TimingWheel::firstSlot(int level) const {
+    const uint64_t occupied = m_occupied[level];
+    if (occupied == 0) {
+        return -1;
+    }
+    // The current slot of a higher level holds the next lap, so it comes last
+    const int start = (slotOf(m_now, level) + (level > 0 ? 1 : 0)) & (Slots - 1);
+    return (lowestBit(rotateRight(occupied, start)) + start) & (Slots - 1);
+}
+
+uint64_t TimingWheel::slotTick(int level, int slot) const {
+    const int current = slotOf(m_now, level);
+    uint64_t laps = static_cast<uint64_t>((slot - current) & (Slots - 1));
+    if (level == 0) {
+        return m_now + laps;
+    }
+    if (laps == 0) {
+        laps = Slots;
+    }
+    return ((m_now >> (SlotBits * level)) + laps) << (SlotBits * level);
+}
+
+uint64_t TimingWheel::nextEvent() const {
+    uint64_t next = Never;
+    for (int level = 0; level < Levels; ++level) {
+        const int slot = firstSlot(level);
+        if (slot >= 0) {
+            next = std::min(next, slotTick(level, slot));
+        }
+    }
+    return next;
+}
+
+uint64_t TimingWheel::earliestIn(int level, int slot) const {
+    uint64_t earliest = Never;
+    for (int id = m_heads[level][slot]; id >= 0; id = m_next[id]) {
+        earliest = std::min(earliest, m_expiry[id]);
+    }
+    return earliest;
+}
+
+uint64_t TimingWheel::nextExpiry() const {
+    // Within a level the first slot reached holds that level's earliest
+    // entry; across levels the laps overlap, so compare them all
+    uint64_t next = Never;
+    for (int level = 0; level < Levels - 1; ++level) {
+        const int slot = firstSlot(level);
+        if (slot >= 0) {
+            next = std::min(next, earliestIn(level, slot));
+        }
+    }
+
+    // Entries parked beyond the horizon break the slot order of the top level
+    for (uint64_t occupied = m_occupied[Levels - 1]; occupied != 0; occupied &= occupied - 1) {
+        next = std::min(next, earliestIn(Levels - 1, lowestBit(occupied)));
+    }
+    return next;
+}
+
+void TimingWheel::cascade(int level, int slot) {
+    m_moving.clear();
+    for (int id = m_heads[level][slot]; id >= 0; id = m_next[id]) {
+        m_moving.push_back(id);
+    }
+    for (int id : m_moving) {
+        unlink(id);
+        schedule(id, m_expiry[id]);
+    }
+}
@@ -0,0 +1,118 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timing wheel over integer ticks (Varghese & Lauck). Level l has
+// 64 slots of 64^l ticks each; an entry sits in the lowest level whose span
+// covers its distance from now and moves down a level each time the wheel
+// reaches its slot, so schedule, cancel and expiry are O(1) per entry. An
+// occupancy bitmap per level finds the next non-empty slot without scanning.
+//
+// Entries are small integer ids chosen by the caller (e.g. job indices) and
+// linked through arrays, so nothing allocates after reserve(). Not thread safe.
+class TimingWheel {
+public:
+    static constexpr int Levels = 5;
+    static constexpr int SlotBits = 6;
+    static constexpr int Slots = 1 << SlotBits;
+    static constexpr uint64_t Never = UINT64_MAX;
+
+    TimingWheel() { clear(); }
+
+    // Room for ids 0 .. capacity-1; only while nothing is scheduled
+    void reserve(int capacity);
+    // Drops every entry and restarts time at tick 0
+    void clear();
+
+    uint64_t now() const { return m_now; }
+    bool empty() const { return m_size == 0; }
+    int size() const { return m_size; }
+
+    // An expiry at or before now() is due on the next advance()
+    void schedule(int id, uint64_t expiry);
+    void cancel(int id);
+    bool isScheduled(int id) const { return m_level[id] >= 0; }
+    uint64_t expiryOf(int id) const { return m_expiry[id]; }
+
+    // Earliest expiry of any entry, Never if the wheel is empty
+    uint64_t nextExpiry() const;
+
+    // Moves time forward to `to` and calls due(id) for every entry that expires
+    // on the way, in expiry order. Entries due on the same tick are unscheduled
+    // together before their callbacks run, so a callback may schedule its id again.
+    template <typename Due>
+    void advance(uint64_t to, Due&& due);
+
+private:
+    static uint64_t span(int level) { return uint64_t(1) << (SlotBits * level); }
+    static int slotOf(uint64_t expiry, int level) { return static_cast<int>((expiry >> (SlotBits * level)) & (Slots - 1)); }
+
+    void link(int id, int level, int slot);
+    void unlink(int id);
+    // First occupied slot of a level in the order the wheel will reach them, -1 if none
+    int firstSlot(int level) const;
+    // Tick at which the wheel reaches that slot of the level
+    uint64_t slotTick(int level, int slot) const;
+    uint64_t earliestIn(int level, int slot) const;
+    // Next tick at which advance() has work to do
+    uint64_t nextEvent() const;
+    void cascade(int level, int slot);
+
+    uint64_t m_now = 0;
+    int m_size = 0;
+    int m_heads[Levels][Slots];
+    uint64_t m_occupied[Levels];
+
+    // Per id
+    std::vector<uint64_t> m_expiry;
+    std::vector<int> m_next;
+    std::vector<int> m_prev;
+    std::vector<int8_t> m_level; // -1 while not scheduled
+    std::vector<int8_t> m_slot;
+    // Scratch lists for advance() and cascade()
+    std::vector<int> m_due;
+    std::vector<int> m_moving;
+};
+
+template <typename Due>
+void TimingWheel::advance(uint64_t to, Due&& due) {
+    uint64_t tick = nextEvent();
+    while (tick <= to) {
+        if (tick > m_now) {
+            m_now = tick;
+            // Bring entries whose higher-level slot starts now down to where they belong
+            for (int level = Levels - 1; level > 0; --level) {
+                if ((m_now & (span(level) - 1)) == 0) {
+                    cascade(level, slotOf(m_now, level));
+                }
+            }
+        }
+
+        // Detach the whole slot first so the callbacks may schedule freely
+        const int slot = slotOf(m_now, 0);
+        m_due.clear();
+        for (int id = m_heads[0][slot]; id >= 0; id = m_next[id]) {
+            m_due.push_back(id);
+        }
+        for (int id : m_due) {
+            unlink(id);
+        }
+        for (int id : m_due) {
+            due(id);
+        }
+
+        // Anything rescheduled at or before now waits for the next call
+        tick = nextEvent();
+        if (tick <= m_now) {
+            break;
+        }
+    }
+    // Idle ticks up to `to` need no work; overdue entries keep the wheel where it is
+    if (tick > to && to > m_now) {
+        m_now = to;
+    }
+}
+
+#endif // TIMINGWHEEL_H
@@ -0,0 +1,42 @@
+#ifndef TRACEFILE_H
+#define TRACEFILE_H
+
+#include <cstdint>
+
+// On-disk layout of a click trace: one header followed by fixed-size records
+// in the order they happened. Shared by TraceWriter and the offline converter.
+
+struct TraceFileHeader {
+    char magic[8];          // "FLMTRACE"
+    uint32_t version;
+    uint32_t recordSize;    // sizeof(TraceRecord)
+    int64_t ticksPerSecond; // unit of TraceRecord::time and value
+    uint64_t recordCount;   // valid records after the header
+};
+
+struct TraceRecord {
+    enum Type : uint32_t {
+        RunStart = 1, // value: interval, tick: click limit (-1 infinite)
+        Wake,         // time: actual wake-up, value: scheduled deadline
+        Inject,       // time: submit started, value: submit finished
+        Error,        // time: failure, tick: the failed click
+        RunEnd,       // value: ClickEngine::StopReason, tick: clicks performed
+        Pause,        // time: paused, value: resumed (or stopped), tick: last click before
+        Missed,       // time: late wake-up, value: deadlines already due after this one, tick: the late click
+        Rate          // time: adapted, value: new period between wake-ups, tick: new clicks per wake-up
+    };
+
+    int64_t time = 0;
+    int64_t value = 0;
+    int64_t tick = 0;
+    uint32_t type = 0;
+    uint32_t reserved = 0;
+};
+
+static_assert(sizeof(TraceFileHeader) == 32, "trace header layout changed");
+static_assert(sizeof(TraceRecord) == 32, "trace record layout changed");
+
+constexpr char TraceMagic[8] = {'F', 'L', 'M', 'T', 'R', 'A', 'C', 'E'};
+constexpr uint32_t TraceVersion = 1;
+
+#endif // TRACEFILE_H
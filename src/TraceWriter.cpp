@@ -0,0 +1,129 @@
+#include "TraceWriter.h"
+
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+void TraceWriter::setLastErrorFromSystem(const char* what) {
+#ifdef _WIN32
+    m_lastError = std::string(what) + " (Error: " + std::to_string(GetLastError()) + ")";
+#else
+    m_lastError = std::string(what) + ": " + std::strerror(errno);
+#endif
+}
+
+bool TraceWriter::open(const std::string& path, size_t capacity) {
+    close();
+    if (capacity == 0) {
+        m_lastError = "Trace capacity must not be zero";
+        return false;
+    }
+
+    const size_t bytes = sizeof(TraceFileHeader) + capacity * sizeof(TraceRecord);
+    void* view = nullptr;
+
+#ifdef _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                         CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        m_file = nullptr;
+        setLastErrorFromSystem("Cannot create trace file");
+        return false;
+    }
+
+    // Mapping a larger size than the file grows the file to match
+    const unsigned long long size = bytes;
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE,
+                                   static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+    if (m_mapping) {
+        view = MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, bytes);
+    }
+    if (!view) {
+        setLastErrorFromSystem("Cannot map trace file");
+        if (m_mapping) CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        m_mapping = nullptr;
+        m_file = nullptr;
+        return false;
+    }
+#else
+    m_fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        setLastErrorFromSystem("Cannot create trace file");
+        return false;
+    }
+
+    if (ftruncate(m_fd, static_cast<off_t>(bytes)) == 0) {
+        view = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    }
+    if (!view || view == MAP_FAILED) {
+        setLastErrorFromSystem("Cannot map trace file");
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+#endif
+
+    // Touch every page now so the first append to each one does not fault
+    std::memset(view, 0, bytes);
+
+    m_mappedBytes = bytes;
+    m_header = static_cast<TraceFileHeader*>(view);
+    m_records = reinterpret_cast<TraceRecord*>(m_header + 1);
+    m_capacity = capacity;
+    m_count = 0;
+    m_dropped = 0;
+
+    using Period = std::chrono::steady_clock::period;
+    std::memcpy(m_header->magic, TraceMagic, sizeof(TraceMagic));
+    m_header->version = TraceVersion;
+    m_header->recordSize = sizeof(TraceRecord);
+    m_header->ticksPerSecond = static_cast<int64_t>(Period::den / Period::num);
+    m_header->recordCount = 0;
+    return true;
+}
+
+void TraceWriter::close() {
+    if (!m_records) {
+        return;
+    }
+
+    const size_t usedBytes = sizeof(TraceFileHeader) + m_count * sizeof(TraceRecord);
+
+#ifdef _WIN32
+    FlushViewOfFile(m_header, usedBytes);
+    UnmapViewOfFile(m_header);
+    CloseHandle(m_mapping);
+
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(usedBytes);
+    SetFilePointerEx(m_file, end, nullptr, FILE_BEGIN);
+    SetEndOfFile(m_file);
+    CloseHandle(m_file);
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    munmap(m_header, m_mappedBytes);
+    if (ftruncate(m_fd, static_cast<off_t>(usedBytes)) != 0) {
+        setLastErrorFromSystem("Cannot trim trace file");
+    }
+    ::close(m_fd);
+    m_fd = -1;
+#endif
+
+    m_header = nullptr;
+    m_records = nullptr;
+    m_mappedBytes = 0;
+}
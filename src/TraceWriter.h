@@ -0,0 +1,65 @@
+#ifndef TRACEWRITER_H
+#define TRACEWRITER_H
+
+#include "TraceFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Append-only click trace backed by a memory-mapped file. The file is sized
+// and its pages touched in open(), so append() is a plain store into mapped
+// memory: no allocation, no lock, no syscall. Once the capacity is used up
+// further records are counted as dropped. Single writer (the engine thread).
+class TraceWriter {
+public:
+    TraceWriter() = default;
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Creates or truncates path with room for capacity records
+    bool open(const std::string& path, size_t capacity);
+    // Trims the file to the records written and unmaps it
+    void close();
+    bool isOpen() const { return m_records != nullptr; }
+
+    void append(TraceRecord::Type type, int64_t time, int64_t value, int64_t tick) {
+        if (m_count == m_capacity) {
+            ++m_dropped;
+            return;
+        }
+        TraceRecord& record = m_records[m_count++];
+        record.time = time;
+        record.value = value;
+        record.tick = tick;
+        record.type = type;
+        // Keeps the file readable even if the process dies mid-run
+        m_header->recordCount = m_count;
+    }
+
+    uint64_t recordCount() const { return m_count; }
+    uint64_t dropped() const { return m_dropped; }
+    const std::string& lastError() const { return m_lastError; }
+
+private:
+    void setLastErrorFromSystem(const char* what);
+
+    TraceFileHeader* m_header = nullptr;
+    TraceRecord* m_records = nullptr;
+    uint64_t m_capacity = 0;
+    uint64_t m_count = 0;
+    uint64_t m_dropped = 0;
+    size_t m_mappedBytes = 0;
+    std::string m_lastError;
+
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+};
+
+#endif // TRACEWRITER_H
@@ -0,0 +1,262 @@
+#include "UInputBackend.h"
+#include "InputCodes.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <thread>
+
+#include <fcntl.h>
+#include <linux/uinput.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+void append(std::vector<input_event>& events, unsigned short type, unsigned short code, int value) {
+    input_event event;
+    std::memset(&event, 0, sizeof(event));
+    event.type = type;
+    event.code = code;
+    event.value = value;
+    events.push_back(event);
+}
+
+// The kernel drops an ABS value equal to the current one, so a move to where
+// the device pointer already is would never reach the compositor, and the
+// click would land wherever the real mouse left the cursor. An absolute move
+// is therefore two frames: the target, and the target again. Only when the
+// target is the device's current position does the first frame go one pixel
+// off it; otherwise the kernel drops the repeat along with its empty frame.
+constexpr int AbsoluteMoveEvents = 5;
+
+int nudged(int value, int extent) {
+    return value + 1 < extent ? value + 1 : value - 1;
+}
+
+void setAbsoluteMove(input_event* move, int x, int y, const ScreenRect& screen) {
+    move[3].value = x - screen.x;
+    move[4].value = y - screen.y;
+}
+
+// Fills in the first frame of an encoded move, given the device position
+// before it, and moves that position to the target
+void resolveAbsoluteMove(input_event* move, const ScreenRect& screen, int& deviceX, int& deviceY) {
+    const int x = move[3].value;
+    const int y = move[4].value;
+    const bool unchanged = x == deviceX && y == deviceY;
+    move[0].value = unchanged ? nudged(x, screen.width) : x;
+    move[1].value = unchanged ? nudged(y, screen.height) : y;
+    deviceX = x;
+    deviceY = y;
+}
+} // namespace
+
+UInputBackend::~UInputBackend() {
+    if (m_fd >= 0) {
+        ioctl(m_fd, UI_DEV_DESTROY);
+        close(m_fd);
+    }
+}
+
+void UInputBackend::setLastErrorFromErrno(const char* what) {
+    m_lastError = std::string(what) + ": " + std::strerror(errno);
+}
+
+bool UInputBackend::open() {
+    if (m_fd >= 0) {
+        return true;
+    }
+
+    m_fd = ::open("/dev/uinput", O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        setLastErrorFromErrno("Cannot open /dev/uinput");
+        return false;
+    }
+
+    bool ok = ioctl(m_fd, UI_SET_EVBIT, EV_KEY) == 0
+           && ioctl(m_fd, UI_SET_EVBIT, EV_ABS) == 0
+           && ioctl(m_fd, UI_SET_EVBIT, EV_REL) == 0
+           && ioctl(m_fd, UI_SET_EVBIT, EV_SYN) == 0;
+    for (unsigned short axis : {REL_X, REL_Y, REL_WHEEL, REL_HWHEEL}) {
+        ok = ok && ioctl(m_fd, UI_SET_RELBIT, axis) == 0;
+    }
+    // Every mouse button macros can carry, and the whole keyboard
+    for (int code = BTN_LEFT; code <= BTN_EXTRA; ++code) {
+        ok = ok && ioctl(m_fd, UI_SET_KEYBIT, code) == 0;
+    }
+    for (int code = KEY_ESC; code < BTN_MISC; ++code) {
+        ok = ok && ioctl(m_fd, UI_SET_KEYBIT, code) == 0;
+    }
+
+    // Absolute axes span the virtual desktop so moves land on exact pixels
+    for (unsigned short axis : {ABS_X, ABS_Y}) {
+        uinput_abs_setup abs;
+        std::memset(&abs, 0, sizeof(abs));
+        abs.code = axis;
+        abs.absinfo.minimum = 0;
+        abs.absinfo.maximum = (axis == ABS_X ? m_screen.width : m_screen.height) - 1;
+        ok = ok && ioctl(m_fd, UI_ABS_SETUP, &abs) == 0;
+    }
+
+    uinput_setup setup;
+    std::memset(&setup, 0, sizeof(setup));
+    setup.id.bustype = BUS_VIRTUAL;
+    setup.id.vendor = 0x1209;
+    setup.id.product = 0xF1A3;
+    std::strncpy(setup.name, DeviceName, UINPUT_MAX_NAME_SIZE - 1);
+
+    ok = ok && ioctl(m_fd, UI_DEV_SETUP, &setup) == 0
+            && ioctl(m_fd, UI_DEV_CREATE) == 0;
+
+    if (!ok) {
+        setLastErrorFromErrno("uinput device setup failed");
+        close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+
+    // Give udev and the compositor time to pick up the new device,
+    // otherwise the first clicks are silently dropped. Only paid once.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    return true;
+}
+
+bool UInputBackend::virtualScreen(ScreenRect& rect) const {
+    rect = m_screen;
+    return rect.width > 0 && rect.height > 0;
+}
+
+bool UInputBackend::cursorPosition(int&, int&) {
+    // Write-only device: the pointer position lives in the compositor
+    m_lastError = "uinput cannot read the cursor position";
+    return false;
+}
+
+bool UInputBackend::setCursorPosition(int x, int y) {
+    InputBatch batch;
+    batch.moveTo(x, y);
+    return submit(batch) == 1;
+}
+
+void UInputBackend::encode(const InputBatch& batch, std::vector<input_event>& events, std::vector<int>* eventOffsets,
+                           std::vector<int>* moveOffsets) const {
+    // Each state change gets its own SYN_REPORT frame: consumers collapse a
+    // press and release of the same button inside a single frame. The whole
+    // batch still goes to the kernel in one write().
+    events.clear();
+    for (const InputEvent& event : batch.events()) {
+        if (eventOffsets) {
+            eventOffsets->push_back(static_cast<int>(events.size()));
+        }
+        switch (event.type) {
+        case InputEvent::Type::MoveAbsolute:
+            moveOffsets->push_back(static_cast<int>(events.size()));
+            append(events, EV_ABS, ABS_X, 0);
+            append(events, EV_ABS, ABS_Y, 0);
+            append(events, EV_SYN, SYN_REPORT, 0);
+            append(events, EV_ABS, ABS_X, 0);
+            append(events, EV_ABS, ABS_Y, 0);
+            setAbsoluteMove(&events[events.size() - AbsoluteMoveEvents], event.x, event.y, m_screen);
+            break;
+        case InputEvent::Type::ButtonDown:
+            append(events, EV_KEY, codeFromMouseButton(event.button), 1);
+            break;
+        case InputEvent::Type::ButtonUp:
+            append(events, EV_KEY, codeFromMouseButton(event.button), 0);
+            break;
+        case InputEvent::Type::MoveRelative:
+            append(events, EV_REL, REL_X, event.x);
+            append(events, EV_REL, REL_Y, event.y);
+            break;
+        case InputEvent::Type::Wheel:
+            if (event.y != 0) {
+                append(events, EV_REL, REL_WHEEL, event.y);
+            } else {
+                append(events, EV_REL, REL_HWHEEL, event.x);
+            }
+            break;
+        case InputEvent::Type::KeyDown:
+            append(events, EV_KEY, event.key, 1);
+            break;
+        case InputEvent::Type::KeyUp:
+            append(events, EV_KEY, event.key, 0);
+            break;
+        }
+        append(events, EV_SYN, SYN_REPORT, 0);
+    }
+}
+
+int UInputBackend::writeEvents(std::vector<input_event>& events, const std::vector<int>& moveOffsets,
+                               const ScreenRect& screen, int accepted) {
+    if (m_fd < 0) {
+        m_lastError = "uinput device not open";
+        return 0;
+    }
+    if (events.empty()) {
+        return 0;
+    }
+
+    // The device position only changes if the whole write goes through
+    int deviceX = m_deviceX;
+    int deviceY = m_deviceY;
+    for (int offset : moveOffsets) {
+        resolveAbsoluteMove(&events[offset], screen, deviceX, deviceY);
+    }
+
+    const size_t bytes = events.size() * sizeof(input_event);
+    const ssize_t written = write(m_fd, events.data(), bytes);
+    if (written != static_cast<ssize_t>(bytes)) {
+        setLastErrorFromErrno("uinput write failed");
+        return 0;
+    }
+    m_deviceX = deviceX;
+    m_deviceY = deviceY;
+    return accepted;
+}
+
+int UInputBackend::submit(const InputBatch& batch) {
+    m_moveOffsets.clear();
+    encode(batch, m_events, nullptr, &m_moveOffsets);
+    return writeEvents(m_events, m_moveOffsets, m_screen, batch.size());
+}
+
+namespace {
+// Encoded input_event array plus where each batch event starts in it,
+// so a move target can be patched without re-encoding
+class UInputPreparedBatch : public PreparedBatch {
+public:
+    UInputPreparedBatch(std::vector<input_event> encoded, std::vector<int> offsets, std::vector<int> moves,
+                        const ScreenRect& screen)
+        : events(std::move(encoded)), eventOffsets(std::move(offsets)), moveOffsets(std::move(moves)), origin(screen) {
+        m_size = static_cast<int>(eventOffsets.size());
+    }
+
+    void setMoveTarget(int index, int x, int y) override {
+        setAbsoluteMove(&events[eventOffsets[index]], x, y, origin);
+    }
+
+    std::vector<input_event> events;
+    std::vector<int> eventOffsets;
+    std::vector<int> moveOffsets;
+    ScreenRect origin;
+};
+} // namespace
+
+std::unique_ptr<PreparedBatch> UInputBackend::prepare(const InputBatch& batch) {
+    // Own buffer rather than m_events: a running engine may be submitting
+    // while the GUI thread prepares its next click program
+    std::vector<input_event> events;
+    std::vector<int> offsets;
+    std::vector<int> moves;
+    offsets.reserve(batch.size());
+    encode(batch, events, &offsets, &moves);
+
+    return std::make_unique<UInputPreparedBatch>(std::move(events), std::move(offsets), std::move(moves), m_screen);
+}
+
+int UInputBackend::submitPrepared(PreparedBatch& batch) {
+    auto& prepared = static_cast<UInputPreparedBatch&>(batch);
+    return writeEvents(prepared.events, prepared.moveOffsets, prepared.origin, prepared.size());
+}
@@ -0,0 +1,53 @@
+#ifndef UINPUTBACKEND_H
+#define UINPUTBACKEND_H
+
+#include "InputBackend.h"
+
+#include <linux/input.h>
+#include <vector>
+
+// Linux /dev/uinput injection through a virtual absolute pointer device.
+// Every batch is written as one array of input_events, i.e. one write() per click.
+class UInputBackend : public InputBackend {
+public:
+    // Name of the virtual device; the macro recorder skips it
+    static constexpr const char* DeviceName = "Flame Autoclicker";
+
+    UInputBackend() {
+        m_events.reserve(32);
+        m_moveOffsets.reserve(4);
+    }
+    ~UInputBackend() override;
+
+    // Absolute axis range; must be set before open() to match the desktop
+    void setScreenGeometry(const ScreenRect& rect) { m_screen = rect; }
+
+    const char* name() const override { return "uinput"; }
+    bool open() override;
+    bool virtualScreen(ScreenRect& rect) const override;
+    bool canReadCursor() const override { return false; }
+    bool cursorPosition(int& x, int& y) override;
+    bool setCursorPosition(int x, int y) override;
+    int submit(const InputBatch& batch) override;
+    std::unique_ptr<PreparedBatch> prepare(const InputBatch& batch) override;
+    int submitPrepared(PreparedBatch& batch) override;
+
+private:
+    // eventOffsets gets where each batch event starts, moveOffsets where each absolute move does
+    void encode(const InputBatch& batch, std::vector<input_event>& events, std::vector<int>* eventOffsets,
+                std::vector<int>* moveOffsets) const;
+    // Settles the moves against the device position, then writes
+    int writeEvents(std::vector<input_event>& events, const std::vector<int>& moveOffsets, const ScreenRect& screen,
+                    int accepted);
+    void setLastErrorFromErrno(const char* what);
+
+    int m_fd = -1;
+    ScreenRect m_screen{0, 0, 1920, 1080};
+    std::vector<input_event> m_events;
+    std::vector<int> m_moveOffsets;
+    // Last ABS values written; the device starts at 0, 0
+    int m_deviceX = 0;
+    int m_deviceY = 0;
+};
+
+#endif // UINPUTBACKEND_H
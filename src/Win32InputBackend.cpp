@@ -0,0 +1,222 @@
+#include "Win32InputBackend.h"
+#include "DisplayCache.h"
+#include "InputCodes.h"
+
+#include <algorithm>
+#include <string>
+
+#pragma comment(lib, "user32.lib")
+
+namespace {
+DWORD buttonFlag(MouseButton button, bool down) {
+    switch (button) {
+    case MouseButton::Right: return down ? MOUSEEVENTF_RIGHTDOWN : MOUSEEVENTF_RIGHTUP;
+    case MouseButton::Middle: return down ? MOUSEEVENTF_MIDDLEDOWN : MOUSEEVENTF_MIDDLEUP;
+    case MouseButton::Back:
+    case MouseButton::Forward: return down ? MOUSEEVENTF_XDOWN : MOUSEEVENTF_XUP;
+    default: return down ? MOUSEEVENTF_LEFTDOWN : MOUSEEVENTF_LEFTUP;
+    }
+}
+
+DWORD buttonData(MouseButton button) {
+    if (button == MouseButton::Back) return XBUTTON1;
+    if (button == MouseButton::Forward) return XBUTTON2;
+    return 0;
+}
+
+void setKey(INPUT& input, uint16_t key, bool down) {
+    const int virtualKey = virtualKeyFromCode(key);
+    input.type = INPUT_KEYBOARD;
+    input.ki.wVk = static_cast<WORD>(virtualKey);
+    input.ki.wScan = static_cast<WORD>(MapVirtualKeyW(virtualKey, MAPVK_VK_TO_VSC));
+    input.ki.dwFlags = (down ? 0 : KEYEVENTF_KEYUP) | (isExtendedVirtualKey(virtualKey) ? KEYEVENTF_EXTENDEDKEY : 0);
+}
+
+// SendInput absolute coordinates span 0..65535 across the virtual desktop and
+// Windows maps them back as pixel = value * extent / 65536. Rounding up makes
+// that land exactly on the requested pixel.
+LONG normalize(int value, int origin, int extent) {
+    if (extent <= 0) return 0;
+    const long long scaled = (static_cast<long long>(value - origin) * 65536 + extent - 1) / extent;
+    return static_cast<LONG>(scaled < 0 ? 0 : (scaled > 65535 ? 65535 : scaled));
+}
+} // namespace
+
+Win32InputBackend::Win32InputBackend() {
+    m_inputs.reserve(8);
+}
+
+void Win32InputBackend::setLastErrorFromSystem(const char* what) {
+    m_lastError = std::string(what) + " (Error: " + std::to_string(GetLastError()) + ")";
+}
+
+bool Win32InputBackend::open() {
+    // Probe cursor API access; fails e.g. on a locked or secure desktop
+    POINT pt;
+    if (!GetCursorPos(&pt)) {
+        setLastErrorFromSystem("Windows API access denied");
+        return false;
+    }
+    return true;
+}
+
+bool Win32InputBackend::virtualScreen(ScreenRect& rect) const {
+    // Cached layout when available; it is refreshed on screen changes only
+    if (m_displayCache && m_displayCache->isValid()) {
+        rect = m_displayCache->virtualDesktop();
+        return rect.width > 0 && rect.height > 0;
+    }
+
+    rect.x = GetSystemMetrics(SM_XVIRTUALSCREEN);
+    rect.y = GetSystemMetrics(SM_YVIRTUALSCREEN);
+    rect.width = GetSystemMetrics(SM_CXVIRTUALSCREEN);
+    rect.height = GetSystemMetrics(SM_CYVIRTUALSCREEN);
+    return rect.width > 0 && rect.height > 0;
+}
+
+bool Win32InputBackend::cursorPosition(int& x, int& y) {
+    POINT pt;
+    if (!GetCursorPos(&pt)) {
+        setLastErrorFromSystem("Failed to get cursor position");
+        return false;
+    }
+    x = pt.x;
+    y = pt.y;
+    return true;
+}
+
+bool Win32InputBackend::setCursorPosition(int x, int y) {
+    if (!SetCursorPos(x, y)) {
+        setLastErrorFromSystem("Failed to set cursor position");
+        return false;
+    }
+    return true;
+}
+
+void Win32InputBackend::appendInput(const InputEvent& event, const ScreenRect& screen,
+                                    std::vector<INPUT>& inputs) const {
+    INPUT input = {};
+    input.type = INPUT_MOUSE;
+    switch (event.type) {
+    case InputEvent::Type::MoveAbsolute:
+        input.mi.dx = normalize(event.x, screen.x, screen.width);
+        input.mi.dy = normalize(event.y, screen.y, screen.height);
+        input.mi.dwFlags = MOUSEEVENTF_MOVE | MOUSEEVENTF_ABSOLUTE | MOUSEEVENTF_VIRTUALDESK;
+        break;
+    case InputEvent::Type::ButtonDown:
+        input.mi.dwFlags = buttonFlag(event.button, true);
+        input.mi.mouseData = buttonData(event.button);
+        break;
+    case InputEvent::Type::ButtonUp:
+        input.mi.dwFlags = buttonFlag(event.button, false);
+        input.mi.mouseData = buttonData(event.button);
+        break;
+    case InputEvent::Type::MoveRelative:
+        input.mi.dx = event.x;
+        input.mi.dy = event.y;
+        input.mi.dwFlags = MOUSEEVENTF_MOVE;
+        break;
+    case InputEvent::Type::Wheel:
+        input.mi.mouseData = static_cast<DWORD>((event.y != 0 ? event.y : event.x) * WHEEL_DELTA);
+        input.mi.dwFlags = event.y != 0 ? MOUSEEVENTF_WHEEL : MOUSEEVENTF_HWHEEL;
+        break;
+    case InputEvent::Type::KeyDown:
+    case InputEvent::Type::KeyUp:
+        // Keys without a virtual key still take their slot, as a no-op key event
+        setKey(input, event.key, event.type == InputEvent::Type::KeyDown);
+        break;
+    }
+    if (input.type == INPUT_KEYBOARD) {
+        input.ki.dwExtraInfo = InjectionTag;
+    } else {
+        input.mi.dwExtraInfo = InjectionTag;
+    }
+    inputs.push_back(input);
+}
+
+int Win32InputBackend::submit(const InputBatch& batch) {
+    ScreenRect screen;
+    virtualScreen(screen);
+
+    m_inputs.clear();
+    for (const InputEvent& event : batch.events()) {
+        appendInput(event, screen, m_inputs);
+    }
+
+    if (m_inputs.empty()) {
+        return 0;
+    }
+
+    const UINT sent = SendInput(static_cast<UINT>(m_inputs.size()), m_inputs.data(), sizeof(INPUT));
+    if (sent != m_inputs.size()) {
+        setLastErrorFromSystem("SendInput failed");
+    }
+    return static_cast<int>(sent);
+}
+
+namespace {
+// Ready-made INPUT array. Pixel targets are kept so the normalized coordinates
+// can be redone if the desktop layout changes while the engine is running.
+class Win32PreparedBatch : public PreparedBatch {
+public:
+    explicit Win32PreparedBatch(const InputBatch& batch) : source(batch) {
+        m_size = batch.size();
+        inputs.reserve(batch.size());
+        dirtyMoves.reserve(2);
+    }
+
+    void setMoveTarget(int index, int x, int y) override {
+        source.setMoveTarget(index, x, y);
+        // Typically the one restore move, wherever it sits in a long burst
+        if (std::find(dirtyMoves.begin(), dirtyMoves.end(), index) == dirtyMoves.end()) {
+            dirtyMoves.push_back(index);
+        }
+    }
+
+    InputBatch source;
+    std::vector<INPUT> inputs;
+    ScreenRect screen{};          // layout the inputs were normalized against
+    uint32_t displayGeneration = 0;
+    std::vector<int> dirtyMoves;  // retargeted since the last submit
+    bool needsRebuild = true;
+};
+} // namespace
+
+std::unique_ptr<PreparedBatch> Win32InputBackend::prepare(const InputBatch& batch) {
+    return std::make_unique<Win32PreparedBatch>(batch);
+}
+
+int Win32InputBackend::submitPrepared(PreparedBatch& batch) {
+    auto& prepared = static_cast<Win32PreparedBatch&>(batch);
+
+    // Full translation only on the first submit or after a display layout change
+    const uint32_t generation = m_displayCache ? m_displayCache->generation() : 0;
+    if (prepared.needsRebuild || prepared.displayGeneration != generation) {
+        virtualScreen(prepared.screen);
+        prepared.inputs.clear();
+        for (const InputEvent& event : prepared.source.events()) {
+            appendInput(event, prepared.screen, prepared.inputs);
+        }
+        prepared.displayGeneration = generation;
+        prepared.needsRebuild = false;
+        prepared.dirtyMoves.clear();
+    } else if (!prepared.dirtyMoves.empty()) {
+        // Only re-normalize the moves whose target changed (e.g. the restore position),
+        // against the layout of the last full translation
+        const ScreenRect& screen = prepared.screen;
+        for (int index : prepared.dirtyMoves) {
+            if (index >= 0 && index < prepared.size()) {
+                const InputEvent& event = prepared.source.events()[index];
+                prepared.inputs[index].mi.dx = normalize(event.x, screen.x, screen.width);
+                prepared.inputs[index].mi.dy = normalize(event.y, screen.y, screen.height);
+            }
+        }
+        prepared.dirtyMoves.clear();
+    }
+
+    const UINT sent = SendInput(static_cast<UINT>(prepared.inputs.size()), prepared.inputs.data(), sizeof(INPUT));
+    if (sent != prepared.inputs.size()) {
+        setLastErrorFromSystem("SendInput failed");
+    }
+    return static_cast<int>(sent);
+}
@@ -0,0 +1,34 @@
+#ifndef WIN32INPUTBACKEND_H
+#define WIN32INPUTBACKEND_H
+
+#include "InputBackend.h"
+
+#include <vector>
+#include <windows.h>
+
+// SendInput-based injection; one SendInput call per batch
+class Win32InputBackend : public InputBackend {
+public:
+    // dwExtraInfo of everything this backend sends, so the macro recorder can
+    // tell its own injections apart
+    static constexpr ULONG_PTR InjectionTag = 0x464C414D; // "FLAM"
+
+    Win32InputBackend();
+
+    const char* name() const override { return "win32"; }
+    bool open() override;
+    bool virtualScreen(ScreenRect& rect) const override;
+    bool cursorPosition(int& x, int& y) override;
+    bool setCursorPosition(int x, int y) override;
+    int submit(const InputBatch& batch) override;
+    std::unique_ptr<PreparedBatch> prepare(const InputBatch& batch) override;
+    int submitPrepared(PreparedBatch& batch) override;
+
+private:
+    void setLastErrorFromSystem(const char* what);
+    void appendInput(const InputEvent& event, const ScreenRect& screen, std::vector<INPUT>& inputs) const;
+
+    std::vector<INPUT> m_inputs;
+};
+
+#endif // WIN32INPUTBACKEND_H
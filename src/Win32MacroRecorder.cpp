@@ -0,0 +1,204 @@
+#include "Win32MacroRecorder.h"
+#include "RingLogger.h"
+#include "Win32InputBackend.h"
+
+#pragma comment(lib, "user32.lib")
+
+std::atomic<Win32MacroRecorder*> Win32MacroRecorder::s_active{nullptr};
+
+namespace {
+int64_t performanceCounter() {
+    LARGE_INTEGER ticks;
+    QueryPerformanceCounter(&ticks);
+    return ticks.QuadPart;
+}
+
+std::string systemError(const char* what) {
+    return std::string(what) + " (Error: " + std::to_string(GetLastError()) + ")";
+}
+
+uint16_t buttonCode(WPARAM message, const MSLLHOOKSTRUCT& info) {
+    switch (message) {
+    case WM_LBUTTONDOWN: case WM_LBUTTONUP: return InputCode::BtnLeft;
+    case WM_RBUTTONDOWN: case WM_RBUTTONUP: return InputCode::BtnRight;
+    case WM_MBUTTONDOWN: case WM_MBUTTONUP: return InputCode::BtnMiddle;
+    case WM_XBUTTONDOWN: case WM_XBUTTONUP:
+        return HIWORD(info.mouseData) == XBUTTON1 ? InputCode::BtnSide : InputCode::BtnExtra;
+    default: return 0;
+    }
+}
+} // namespace
+
+Win32MacroRecorder::~Win32MacroRecorder() {
+    stop();
+}
+
+bool Win32MacroRecorder::start(MacroBuffer& buffer) {
+    if (isRecording()) {
+        m_lastError = "Already recording";
+        return false;
+    }
+    // Hook callbacks have no context argument, so they reach the recorder through s_active
+    Win32MacroRecorder* expected = nullptr;
+    if (!s_active.compare_exchange_strong(expected, this)) {
+        m_lastError = "Another macro recorder is running";
+        return false;
+    }
+
+    m_buffer = &buffer;
+    m_buffer->clear();
+    m_held.reset();
+    m_wheelX = m_wheelY = 0;
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    m_frequency = frequency.QuadPart;
+    m_startTicks = performanceCounter();
+
+    // The hooks belong to the recording thread; wait until they are in place
+    std::promise<std::string> started;
+    std::future<std::string> result = started.get_future();
+    m_thread = std::thread(&Win32MacroRecorder::run, this, std::move(started));
+    const std::string error = result.get();
+    if (!error.empty()) {
+        m_thread.join();
+        s_active.store(nullptr);
+        m_buffer = nullptr;
+        m_lastError = error;
+        return false;
+    }
+    return true;
+}
+
+void Win32MacroRecorder::stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+    if (!PostThreadMessageW(m_threadId, WM_QUIT, 0, 0)) {
+        FLAME_LOG(Warning, "Macro recorder wake-up failed (error %lld)", static_cast<long long>(GetLastError()));
+    }
+    m_thread.join();
+    s_active.store(nullptr);
+
+    dropUnreleasedPresses(*m_buffer, m_held);
+    m_buffer = nullptr;
+}
+
+void Win32MacroRecorder::run(std::promise<std::string> started) {
+    // Creates the thread's message queue, so stop() can post to it
+    MSG msg;
+    PeekMessageW(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+    m_threadId = GetCurrentThreadId();
+
+    const HINSTANCE module = GetModuleHandleW(nullptr);
+    HHOOK mouse = SetWindowsHookExW(WH_MOUSE_LL, &Win32MacroRecorder::mouseProc, module, 0);
+    HHOOK keyboard = mouse ? SetWindowsHookExW(WH_KEYBOARD_LL, &Win32MacroRecorder::keyboardProc, module, 0) : nullptr;
+    if (!keyboard) {
+        const std::string error = systemError("Cannot install the input hooks");
+        if (mouse) {
+            UnhookWindowsHookEx(mouse);
+        }
+        started.set_value(error);
+        return;
+    }
+    // Windows skips a hook that keeps input waiting too long
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+    started.set_value(std::string());
+
+    // The hooks are called from inside GetMessageW
+    while (GetMessageW(&msg, nullptr, 0, 0) > 0) {
+        DispatchMessageW(&msg);
+    }
+    UnhookWindowsHookEx(keyboard);
+    UnhookWindowsHookEx(mouse);
+}
+
+LRESULT CALLBACK Win32MacroRecorder::mouseProc(int code, WPARAM message, LPARAM data) {
+    Win32MacroRecorder* recorder = s_active.load(std::memory_order_acquire);
+    if (code == HC_ACTION && recorder) {
+        recorder->onMouse(message, *reinterpret_cast<const MSLLHOOKSTRUCT*>(data));
+    }
+    return CallNextHookEx(nullptr, code, message, data);
+}
+
+LRESULT CALLBACK Win32MacroRecorder::keyboardProc(int code, WPARAM message, LPARAM data) {
+    Win32MacroRecorder* recorder = s_active.load(std::memory_order_acquire);
+    if (code == HC_ACTION && recorder) {
+        recorder->onKey(message, *reinterpret_cast<const KBDLLHOOKSTRUCT*>(data));
+    }
+    return CallNextHookEx(nullptr, code, message, data);
+}
+
+int64_t Win32MacroRecorder::nowUs() const {
+    // Split so the multiplication cannot overflow in a long recording
+    const int64_t ticks = performanceCounter() - m_startTicks;
+    return ticks / m_frequency * 1000000 + ticks % m_frequency * 1000000 / m_frequency;
+}
+
+void Win32MacroRecorder::onMouse(WPARAM message, const MSLLHOOKSTRUCT& info) {
+    // Our own injections would be recorded twice
+    if (info.dwExtraInfo == Win32InputBackend::InjectionTag) {
+        return;
+    }
+    const int64_t timeUs = nowUs();
+    switch (message) {
+    case WM_MOUSEMOVE:
+        m_buffer->append(timeUs, MacroEvent::Type::MoveAbsolute, 0, info.pt.x, info.pt.y);
+        break;
+    case WM_MOUSEWHEEL:
+    case WM_MOUSEHWHEEL:
+        onWheel(timeUs, static_cast<short>(HIWORD(info.mouseData)), message == WM_MOUSEHWHEEL);
+        break;
+    case WM_LBUTTONDOWN:
+    case WM_RBUTTONDOWN:
+    case WM_MBUTTONDOWN:
+    case WM_XBUTTONDOWN:
+        onPress(timeUs, buttonCode(message, info), true, true);
+        break;
+    case WM_LBUTTONUP:
+    case WM_RBUTTONUP:
+    case WM_MBUTTONUP:
+    case WM_XBUTTONUP:
+        onPress(timeUs, buttonCode(message, info), true, false);
+        break;
+    default:
+        break;
+    }
+}
+
+void Win32MacroRecorder::onKey(WPARAM message, const KBDLLHOOKSTRUCT& info) {
+    if (info.dwExtraInfo == Win32InputBackend::InjectionTag) {
+        return;
+    }
+    // Keypad Enter shares VK_RETURN with Enter and is told apart by the extended flag
+    const bool keypadEnter = info.vkCode == VK_RETURN && (info.flags & LLKHF_EXTENDED);
+    const uint16_t code = keypadEnter ? 96 : codeFromVirtualKey(static_cast<int>(info.vkCode));
+    if (code == 0) {
+        return;
+    }
+    const bool pressed = message == WM_KEYDOWN || message == WM_SYSKEYDOWN;
+    onPress(nowUs(), code, false, pressed);
+}
+
+void Win32MacroRecorder::onPress(int64_t timeUs, uint16_t code, bool button, bool pressed) {
+    // Auto-repeat presses are the OS's business, and a release of something
+    // pressed before recording started (e.g. the start hotkey) is not part of the macro
+    if (code == 0 || m_held.test(code) == pressed) {
+        return;
+    }
+    m_held.set(code, pressed);
+    using Type = MacroEvent::Type;
+    const Type type = button ? (pressed ? Type::ButtonDown : Type::ButtonUp) : (pressed ? Type::KeyDown : Type::KeyUp);
+    m_buffer->append(timeUs, type, code, 0, 0);
+}
+
+void Win32MacroRecorder::onWheel(int64_t timeUs, int delta, bool horizontal) {
+    // Macros store whole detents; the rest waits for the next wheel event
+    int& pending = horizontal ? m_wheelX : m_wheelY;
+    pending += delta;
+    const int detents = pending / WHEEL_DELTA;
+    if (detents == 0) {
+        return;
+    }
+    pending -= detents * WHEEL_DELTA;
+    m_buffer->append(timeUs, MacroEvent::Type::Wheel, 0, horizontal ? detents : 0, horizontal ? 0 : detents);
+}
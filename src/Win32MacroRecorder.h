@@ -0,0 +1,57 @@
+#ifndef WIN32MACRORECORDER_H
+#define WIN32MACRORECORDER_H
+
+#include "MacroRecorder.h"
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <thread>
+#include <windows.h>
+
+// Records through global low-level hooks (WH_MOUSE_LL, WH_KEYBOARD_LL) set on
+// a thread of its own, which runs the message loop the hooks are called from.
+// Events are stamped with QueryPerformanceCounter as the hook sees them; keys
+// are stored as Linux key codes (InputCodes.h) and moves as virtual desktop
+// pixels, like the evdev recorder. The autoclicker's own SendInput events are
+// skipped. Hooks must return quickly, so a callback only appends to the
+// buffer. One recorder can be running at a time.
+class Win32MacroRecorder : public MacroRecorder {
+public:
+    Win32MacroRecorder() = default;
+    ~Win32MacroRecorder() override;
+
+    const char* name() const override { return "win32-hooks"; }
+    bool start(MacroBuffer& buffer) override;
+    void stop() override;
+    bool isRecording() const override { return m_thread.joinable(); }
+
+private:
+    static LRESULT CALLBACK mouseProc(int code, WPARAM message, LPARAM data);
+    static LRESULT CALLBACK keyboardProc(int code, WPARAM message, LPARAM data);
+
+    // Installs the hooks, reports the outcome through `started` and pumps
+    // messages until stop(); returns right away if the hooks cannot be set
+    void run(std::promise<std::string> started);
+    void onMouse(WPARAM message, const MSLLHOOKSTRUCT& info);
+    void onKey(WPARAM message, const KBDLLHOOKSTRUCT& info);
+    void onPress(int64_t timeUs, uint16_t code, bool button, bool pressed);
+    void onWheel(int64_t timeUs, int delta, bool horizontal);
+    int64_t nowUs() const;
+
+    // The recorder the hook callbacks forward to
+    static std::atomic<Win32MacroRecorder*> s_active;
+
+    MacroBuffer* m_buffer = nullptr;
+    std::thread m_thread;
+    DWORD m_threadId = 0;
+    int64_t m_frequency = 1;
+    int64_t m_startTicks = 0;
+    // Wheel movement below one detent (high resolution wheels), carried over
+    int m_wheelX = 0;
+    int m_wheelY = 0;
+    HeldCodes m_held; // pressed during the recording
+};
+
+#endif // WIN32MACRORECORDER_H
@@ -0,0 +1,173 @@
+#include "XTestInputBackend.h"
+
+#include <X11/Xlib.h>
+#include <X11/extensions/XTest.h>
+
+#include <string>
+
+namespace {
+unsigned int buttonNumber(MouseButton button) {
+    switch (button) {
+    case MouseButton::Right: return 3;
+    case MouseButton::Middle: return 2;
+    case MouseButton::Back: return 8;
+    case MouseButton::Forward: return 9;
+    default: return 1;
+    }
+}
+
+// One press and release of the wheel's button per detent: 4/5 up/down, 6/7 left/right
+Bool fakeWheel(Display* display, int steps, unsigned int positive, unsigned int negative) {
+    const unsigned int button = steps > 0 ? positive : negative;
+    Bool ok = True;
+    for (int i = 0; i < (steps > 0 ? steps : -steps) && ok; ++i) {
+        ok = XTestFakeButtonEvent(display, button, True, CurrentTime)
+          && XTestFakeButtonEvent(display, button, False, CurrentTime);
+    }
+    return ok;
+}
+
+// X keycodes of evdev-based servers are the Linux key codes shifted by 8
+constexpr unsigned int EvdevKeycodeOffset = 8;
+} // namespace
+
+XTestInputBackend::~XTestInputBackend() {
+    if (m_display) {
+        XCloseDisplay(m_display);
+    }
+}
+
+bool XTestInputBackend::open() {
+    if (m_display) {
+        return true;
+    }
+
+    // Own connection, independent of Qt's; honours $DISPLAY (e.g. an Xvfb server)
+    m_display = XOpenDisplay(nullptr);
+    if (!m_display) {
+        m_lastError = "Cannot connect to the X server (is DISPLAY set?)";
+        return false;
+    }
+
+    int eventBase, errorBase, major, minor;
+    if (!XTestQueryExtension(m_display, &eventBase, &errorBase, &major, &minor)) {
+        m_lastError = "X server does not support the XTest extension";
+        XCloseDisplay(m_display);
+        m_display = nullptr;
+        return false;
+    }
+
+    // Fake input must not be held back by another client's server grab
+    XTestGrabControl(m_display, True);
+    return true;
+}
+
+bool XTestInputBackend::virtualScreen(ScreenRect& rect) const {
+    if (!m_display) {
+        return false;
+    }
+    // The root window spans all monitors of the X screen
+    const int screen = DefaultScreen(m_display);
+    rect = {0, 0, DisplayWidth(m_display, screen), DisplayHeight(m_display, screen)};
+    return rect.width > 0 && rect.height > 0;
+}
+
+bool XTestInputBackend::cursorPosition(int& x, int& y) {
+    if (!m_display) {
+        m_lastError = "X display not open";
+        return false;
+    }
+
+    Window root, child;
+    int winX, winY;
+    unsigned int mask;
+    if (!XQueryPointer(m_display, DefaultRootWindow(m_display), &root, &child, &x, &y, &winX, &winY, &mask)) {
+        m_lastError = "Pointer is not on the default X screen";
+        return false;
+    }
+    return true;
+}
+
+bool XTestInputBackend::setCursorPosition(int x, int y) {
+    InputBatch batch;
+    batch.moveTo(x, y);
+    return submit(batch) == 1;
+}
+
+void XTestInputBackend::flush() {
+    const auto start = std::chrono::steady_clock::now();
+    if (m_waitForServer) {
+        XSync(m_display, False);
+    } else {
+        XFlush(m_display);
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+
+    m_flushStats.batches++;
+    m_flushStats.last = elapsed;
+    m_flushStats.total += elapsed;
+    if (elapsed > m_flushStats.max) {
+        m_flushStats.max = elapsed;
+    }
+}
+
+int XTestInputBackend::submit(const InputBatch& batch) {
+    if (!m_display) {
+        m_lastError = "X display not open";
+        return 0;
+    }
+    if (batch.isEmpty()) {
+        return 0;
+    }
+
+    // Xlib only buffers these requests; nothing is sent until flush()
+    int queued = 0;
+    for (const InputEvent& event : batch.events()) {
+        Bool ok = False;
+        switch (event.type) {
+        case InputEvent::Type::MoveAbsolute:
+            ok = XTestFakeMotionEvent(m_display, -1, event.x, event.y, CurrentTime);
+            break;
+        case InputEvent::Type::ButtonDown:
+            ok = XTestFakeButtonEvent(m_display, buttonNumber(event.button), True, CurrentTime);
+            break;
+        case InputEvent::Type::ButtonUp:
+            ok = XTestFakeButtonEvent(m_display, buttonNumber(event.button), False, CurrentTime);
+            break;
+        case InputEvent::Type::MoveRelative:
+            ok = XTestFakeRelativeMotionEvent(m_display, event.x, event.y, CurrentTime);
+            break;
+        case InputEvent::Type::Wheel:
+            ok = event.y != 0 ? fakeWheel(m_display, event.y, 4, 5) : fakeWheel(m_display, event.x, 7, 6);
+            break;
+        case InputEvent::Type::KeyDown:
+            ok = XTestFakeKeyEvent(m_display, event.key + EvdevKeycodeOffset, True, CurrentTime);
+            break;
+        case InputEvent::Type::KeyUp:
+            ok = XTestFakeKeyEvent(m_display, event.key + EvdevKeycodeOffset, False, CurrentTime);
+            break;
+        }
+        if (!ok) {
+            m_lastError = "XTest rejected a fake event";
+            break;
+        }
+        queued++;
+    }
+
+    flush();
+    return queued;
+}
+
+std::string XTestInputBackend::diagnostics() const {
+    if (m_flushStats.batches == 0) {
+        return std::string();
+    }
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    return std::string(m_waitForServer ? "XSync" : "XFlush") + " per batch: "
+        + std::to_string(m_flushStats.batches) + " batches, avg "
+        + std::to_string(duration_cast<microseconds>(m_flushStats.average()).count()) + " us, last "
+        + std::to_string(duration_cast<microseconds>(m_flushStats.last).count()) + " us, max "
+        + std::to_string(duration_cast<microseconds>(m_flushStats.max).count()) + " us";
+}
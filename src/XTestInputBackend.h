@@ -0,0 +1,56 @@
+#ifndef XTESTINPUTBACKEND_H
+#define XTESTINPUTBACKEND_H
+
+#include "InputBackend.h"
+
+#include <chrono>
+#include <cstdint>
+
+typedef struct _XDisplay Display;
+
+// X11 XTest injection. Fake events of a batch (one click or a whole burst)
+// are only queued in Xlib's output buffer and leave in a single XSync/XFlush,
+// so the cost is one round trip per batch instead of one per event.
+// Works against any X server including Xvfb, which makes it usable headless.
+class XTestInputBackend : public InputBackend {
+public:
+    // Cost of the flush that ends each batch
+    struct FlushStats {
+        int64_t batches = 0;
+        std::chrono::nanoseconds last{0};
+        std::chrono::nanoseconds max{0};
+        std::chrono::nanoseconds total{0};
+
+        std::chrono::nanoseconds average() const {
+            return batches > 0 ? total / batches : std::chrono::nanoseconds(0);
+        }
+    };
+
+    XTestInputBackend() = default;
+    ~XTestInputBackend() override;
+
+    // XSync (default) waits for the server to process the batch, which makes
+    // the measured cost a true round trip; XFlush only writes the buffer.
+    void setWaitForServer(bool enabled) { m_waitForServer = enabled; }
+
+    const char* name() const override { return "xtest"; }
+    bool open() override;
+    bool virtualScreen(ScreenRect& rect) const override;
+    bool cursorPosition(int& x, int& y) override;
+    bool setCursorPosition(int x, int y) override;
+    int submit(const InputBatch& batch) override;
+    std::string diagnostics() const override;
+
+    // Written by the engine thread; read or reset it only while no engine runs
+    const FlushStats& flushStats() const { return m_flushStats; }
+    void resetFlushStats() { m_flushStats = FlushStats(); }
+
+private:
+    void flush();
+
+    Display* m_display = nullptr;
+    bool m_waitForServer = true;
+    FlushStats m_flushStats;
+};
+
+#endif // XTESTINPUTBACKEND_H
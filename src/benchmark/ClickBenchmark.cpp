@@ -0,0 +1,373 @@
+// Click timing benchmark: runs ClickEngine against the recording input backend and
+// reports inter-click interval percentiles, drift against the ideal schedule
+// and CPU time. Prints a table and optionally writes the results as JSON.
+//
+// --simulate HOURS instead runs a duration-limited session per interval on a
+// virtual clock and checks that exactly duration / interval clicks were made.
+//
+// --burst sends intervals below 1 ms as bursts, one injection per millisecond,
+// the way AutoClicker's burst mode does; the percentiles then include the
+// zero gaps inside each burst.
+//
+// --backend xtest (builds with XTest only) injects real clicks through the X
+// server in $DISPLAY, e.g. under xvfb-run, instead of recording them. Click
+// times are then taken when each injection returns, and the table adds the
+// XSync round trip that ends every batch.
+//
+// Usage: ClickBenchmark [--clicks N] [--intervals 1,5,16,100] [--high-rate] [--burst] [--json FILE]
+//                       [--simulate HOURS] [--backend recording|xtest]
+
+#include "ClickEngine.h"
+#include "ClickProgram.h"
+#include "EngineClock.h"
+#include "PreciseWaiter.h"
+#include "RecordingInputBackend.h"
+#ifdef FLAME_HAVE_XTEST
+#include "XTestInputBackend.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace {
+using Clock = ClickEngine::Clock;
+
+struct Options {
+    int64_t clicks = 200;
+    std::vector<double> intervalsMs = {1, 5, 16, 100};
+    bool highRate = false;
+    bool burst = false;
+    const char* jsonPath = nullptr;
+    double simulateHours = 0;
+    bool xtest = false;
+};
+
+struct Result {
+    double intervalMs = 0;
+    int64_t clicks = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+    double p999Us = 0;
+    double maxUs = 0;
+    double driftUs = 0;     // last click versus start + n * interval
+    double cpuMs = 0;
+    double wallMs = 0;
+    // --backend xtest: the flush that ends each batch
+    int64_t flushes = 0;
+    double flushAvgUs = 0;
+    double flushMaxUs = 0;
+};
+
+double processCpuMs() {
+#ifdef _WIN32
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) {
+        return 0.0;
+    }
+    auto toMs = [](const FILETIME& ft) {
+        ULARGE_INTEGER v;
+        v.LowPart = ft.dwLowDateTime;
+        v.HighPart = ft.dwHighDateTime;
+        return v.QuadPart / 10000.0; // 100 ns units
+    };
+    return toMs(kernel) + toMs(user);
+#else
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+// Engine settings for one per-click interval, split into bursts if asked to
+ClickEngine::Settings settingsFor(const Options& options, double intervalMs) {
+    ClickEngine::Settings settings;
+    settings.interval = std::chrono::nanoseconds(static_cast<int64_t>(intervalMs * 1e6));
+    settings.highRate = options.highRate;
+    if (options.burst) {
+        settings = ClickEngine::planBurst(settings, std::chrono::milliseconds(1), 1000);
+    }
+    return settings;
+}
+
+ClickConfig configFor(const ClickEngine::Settings& settings) {
+    ClickConfig config;
+    config.burst = settings.burst;
+    return config;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    const size_t index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// Against `live` if given, otherwise against a recording backend
+bool runOne(const Options& options, InputBackend* live, double intervalMs, Result& result) {
+    // One down + one up per click
+    RecordingInputBackend recording(live ? 0 : static_cast<size_t>(options.clicks) * 2);
+    InputBackend& backend = live ? *live : recording;
+    std::atomic<bool> done{false};
+
+    ClickEngine::Settings settings = settingsFor(options, intervalMs);
+    settings.clickLimit = options.clicks;
+
+    std::vector<Clock::time_point> times;
+    times.reserve(static_cast<size_t>(options.clicks));
+    ClickEngine engine;
+    ClickEngine::ClickFunction program = compileClickProgram(backend, configFor(settings), nullptr);
+    if (live) {
+        // A live backend keeps no timeline; its clicks count when the injection returned
+        engine.setClickFunction([&times, program](int clicks, std::chrono::nanoseconds& settled) {
+            const int accepted = program(clicks, settled);
+            times.insert(times.end(), static_cast<size_t>(std::max(accepted, 0)), Clock::now());
+            return accepted;
+        });
+    } else {
+        engine.setClickFunction(program);
+    }
+    engine.setFinishedCallback([&done](ClickEngine::StopReason) { done.store(true); });
+
+    const double cpuBefore = processCpuMs();
+    if (!engine.start(settings)) {
+        std::fprintf(stderr, "Failed to start engine for %.3f ms\n", intervalMs);
+        return false;
+    }
+    while (!done.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    engine.stop();
+    const double cpuAfter = processCpuMs();
+
+    for (const RecordingInputBackend::Record& record : recording.records()) {
+        if (record.event.type == InputEvent::Type::ButtonDown) {
+            times.push_back(record.time);
+        }
+    }
+    std::vector<double> deltas;
+    deltas.reserve(times.size());
+    Clock::time_point previous = engine.startTime();
+    for (const Clock::time_point& t : times) {
+        deltas.push_back(std::chrono::duration<double, std::micro>(t - previous).count());
+        previous = t;
+    }
+    std::sort(deltas.begin(), deltas.end());
+
+    result.intervalMs = intervalMs;
+    result.clicks = static_cast<int64_t>(times.size());
+    result.p50Us = percentile(deltas, 0.50);
+    result.p99Us = percentile(deltas, 0.99);
+    result.p999Us = percentile(deltas, 0.999);
+    result.maxUs = deltas.empty() ? 0.0 : deltas.back();
+    if (!times.empty()) {
+        const Clock::time_point ideal = engine.startTime() + (times.size() + settings.burst - 1) / settings.burst * settings.interval;
+        result.driftUs = std::chrono::duration<double, std::micro>(times.back() - ideal).count();
+    }
+    result.cpuMs = cpuAfter - cpuBefore;
+    result.wallMs = std::chrono::duration<double, std::milli>(engine.stats().elapsed).count();
+    return true;
+}
+
+// Runs a whole duration-limited session on virtual time; returns false on a count mismatch
+bool simulate(const Options& options, double intervalMs) {
+    VirtualClock clock;
+    RecordingInputBackend backend(0, &clock); // counters only
+    std::atomic<bool> done{false};
+    ClickEngine::StopReason reason = ClickEngine::StopReason::Requested;
+
+    ClickEngine::Settings settings = settingsFor(options, intervalMs);
+    settings.highRate = false;
+
+    ClickEngine engine;
+    engine.setClock(&clock);
+    engine.setClickFunction(compileClickProgram(backend, configFor(settings), nullptr));
+    engine.setFinishedCallback([&done, &reason](ClickEngine::StopReason r) {
+        reason = r;
+        done.store(true);
+    });
+
+    settings.duration = std::chrono::nanoseconds(static_cast<int64_t>(options.simulateHours * 3600e9));
+
+    const auto wallStart = Clock::now();
+    if (!engine.start(settings)) {
+        return false;
+    }
+    while (!done.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    engine.stop();
+    const double wallMs = std::chrono::duration<double, std::milli>(Clock::now() - wallStart).count();
+
+    const int64_t expected = settings.duration / settings.interval * settings.burst;
+    const bool ok = reason == ClickEngine::StopReason::Duration
+                 && backend.buttonDowns() == expected
+                 && backend.buttonUps() == expected
+                 && engine.stats().elapsed == settings.duration;
+    std::printf("%8.3fms %14lld %14lld %12.1f  %s\n", intervalMs, static_cast<long long>(expected),
+                static_cast<long long>(backend.buttonDowns()), wallMs, ok ? "ok" : "MISMATCH");
+    return ok;
+}
+
+bool parseArgs(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--clicks") == 0 && hasValue) {
+            options.clicks = std::max<int64_t>(1, std::atoll(argv[++i]));
+        } else if (std::strcmp(arg, "--intervals") == 0 && hasValue) {
+            options.intervalsMs.clear();
+            std::string list = argv[++i];
+            size_t pos = 0;
+            while (pos <= list.size()) {
+                const size_t comma = std::min(list.find(',', pos), list.size());
+                const double value = std::atof(list.substr(pos, comma - pos).c_str());
+                if (value > 0) options.intervalsMs.push_back(value);
+                pos = comma + 1;
+            }
+        } else if (std::strcmp(arg, "--high-rate") == 0) {
+            options.highRate = true;
+        } else if (std::strcmp(arg, "--burst") == 0) {
+            options.burst = true;
+        } else if (std::strcmp(arg, "--simulate") == 0 && hasValue) {
+            options.simulateHours = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--json") == 0 && hasValue) {
+            options.jsonPath = argv[++i];
+        } else if (std::strcmp(arg, "--backend") == 0 && hasValue) {
+            const char* backend = argv[++i];
+            options.xtest = std::strcmp(backend, "xtest") == 0;
+            if (!options.xtest && std::strcmp(backend, "recording") != 0) {
+                std::fprintf(stderr, "Unknown backend %s (recording or xtest)\n", backend);
+                return false;
+            }
+#ifndef FLAME_HAVE_XTEST
+            if (options.xtest) {
+                std::fprintf(stderr, "This build has no XTest support\n");
+                return false;
+            }
+#endif
+        } else {
+            std::fprintf(stderr,
+                         "Usage: %s [--clicks N] [--intervals 1,5,16,100] [--high-rate] [--burst] [--json FILE]"
+                         " [--simulate HOURS] [--backend recording|xtest]\n",
+                         argv[0]);
+            return false;
+        }
+    }
+    return !options.intervalsMs.empty();
+}
+
+void printTable(const Options& options, const std::vector<Result>& results) {
+    std::printf("Mode: %s%s, spin margin %.0f us, backend %s\n\n", options.highRate ? "high-rate" : "sleep",
+                options.burst ? " + burst" : "", PreciseWaiter::spinMargin().count() / 1000.0,
+                options.xtest ? "xtest" : "recording");
+    std::printf("%10s %8s %10s %10s %10s %10s %12s %10s",
+                "interval", "clicks", "p50 us", "p99 us", "p99.9 us", "max us", "drift us", "cpu ms");
+    std::printf(options.xtest ? " %8s %12s %12s\n" : "\n", "syncs", "sync avg us", "sync max us");
+    for (const Result& r : results) {
+        std::printf("%8.3fms %8lld %10.1f %10.1f %10.1f %10.1f %12.1f %10.1f",
+                    r.intervalMs, static_cast<long long>(r.clicks), r.p50Us, r.p99Us, r.p999Us,
+                    r.maxUs, r.driftUs, r.cpuMs);
+        if (options.xtest) {
+            std::printf(" %8lld %12.1f %12.1f", static_cast<long long>(r.flushes), r.flushAvgUs, r.flushMaxUs);
+        }
+        std::printf("\n");
+    }
+}
+
+bool writeJson(const Options& options, const std::vector<Result>& results) {
+    FILE* file = std::fopen(options.jsonPath, "w");
+    if (!file) {
+        std::fprintf(stderr, "Cannot write %s\n", options.jsonPath);
+        return false;
+    }
+    std::fprintf(file, "{\n  \"mode\": \"%s\",\n  \"backend\": \"%s\",\n  \"spin_margin_us\": %.1f,\n  \"results\": [\n",
+                 options.highRate ? "high-rate" : "sleep", options.xtest ? "xtest" : "recording",
+                 PreciseWaiter::spinMargin().count() / 1000.0);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        std::fprintf(file,
+                     "    {\"interval_ms\": %.3f, \"clicks\": %lld, \"p50_us\": %.1f, \"p99_us\": %.1f, "
+                     "\"p999_us\": %.1f, \"max_us\": %.1f, \"drift_us\": %.1f, \"cpu_ms\": %.1f, "
+                     "\"wall_ms\": %.1f, \"syncs\": %lld, \"sync_avg_us\": %.1f, \"sync_max_us\": %.1f}%s\n",
+                     r.intervalMs, static_cast<long long>(r.clicks), r.p50Us, r.p99Us, r.p999Us, r.maxUs,
+                     r.driftUs, r.cpuMs, r.wallMs, static_cast<long long>(r.flushes), r.flushAvgUs, r.flushMaxUs,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    std::fclose(file);
+    return true;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) {
+        return 2;
+    }
+
+    if (options.simulateHours > 0) {
+        std::printf("Simulated %.2f h session on a virtual clock\n\n", options.simulateHours);
+        std::printf("%10s %14s %14s %12s\n", "interval", "expected", "clicks", "wall ms");
+        bool allOk = true;
+        for (double intervalMs : options.intervalsMs) {
+            allOk = simulate(options, intervalMs) && allOk;
+        }
+        return allOk ? 0 : 1;
+    }
+
+    PreciseWaiter::calibrate();
+
+    InputBackend* live = nullptr;
+#ifdef FLAME_HAVE_XTEST
+    std::unique_ptr<XTestInputBackend> xtest;
+    if (options.xtest) {
+        xtest = std::make_unique<XTestInputBackend>();
+        if (!xtest->open()) {
+            std::fprintf(stderr, "%s\n", xtest->lastError().c_str());
+            return 1;
+        }
+        live = xtest.get();
+    }
+#endif
+
+    std::vector<Result> results;
+    for (double intervalMs : options.intervalsMs) {
+        Result result;
+#ifdef FLAME_HAVE_XTEST
+        if (xtest) {
+            xtest->resetFlushStats();
+        }
+#endif
+        if (!runOne(options, live, intervalMs, result)) {
+            return 1;
+        }
+#ifdef FLAME_HAVE_XTEST
+        if (xtest) {
+            const XTestInputBackend::FlushStats& flushes = xtest->flushStats();
+            result.flushes = flushes.batches;
+            result.flushAvgUs = std::chrono::duration<double, std::micro>(flushes.average()).count();
+            result.flushMaxUs = std::chrono::duration<double, std::micro>(flushes.max).count();
+        }
+#endif
+        results.push_back(result);
+    }
+
+    printTable(options, results);
+    if (options.jsonPath && !writeJson(options, results)) {
+        return 1;
+    }
+    return 0;
+}
@@ -5,8 +5,9 @@
 #include <QApplication>
 #include <QGraphicsDropShadowEffect>
 
-HotkeySettingsTab::HotkeySettingsTab(QWidget *parent)
+HotkeySettingsTab::HotkeySettingsTab(QWidget *parent, HotkeyAction action)
     : QWidget(parent)
+    , m_action(action)
 {
     // Adjusted size for better proportions
     setFixedSize(650, 500);
@@ -199,7 +200,7 @@ HotkeySettingsTab::HotkeySettingsTab(QWidget *parent)
 
 void HotkeySettingsTab::createHeaderSection(QVBoxLayout *mainLayout) {
     // Title
-    QLabel *titleLabel = new QLabel("Hotkey Configuration");
+    QLabel *titleLabel = new QLabel(m_action == HotkeyAction::AutoPress ? "Key Press Configuration" : "Hotkey Configuration");
     titleLabel->setStyleSheet(R"(
         QLabel {
             font-size: 20px;
@@ -211,7 +212,11 @@ void HotkeySettingsTab::createHeaderSection(QVBoxLayout *mainLayout) {
     titleLabel->setAlignment(Qt::AlignCenter);
 
     // Description
-    QLabel *descLabel = new QLabel("Configure the global hotkey to start/stop the autoclicker");
+    QLabel *descLabel = new QLabel(m_action == HotkeyAction::PauseResume
+                                       ? "Configure the global hotkey to pause/resume a running autoclicker"
+                                   : m_action == HotkeyAction::AutoPress
+                                       ? "Configure the key or key combination pressed at the click interval"
+                                       : "Configure the global hotkey to start/stop the autoclicker");
     descLabel->setStyleSheet(R"(
         QLabel {
             font-size: 12px;
@@ -316,7 +321,7 @@ void HotkeySettingsTab::createButtonSection(QVBoxLayout *mainLayout) {
     buttonLayout->setAlignment(Qt::AlignCenter);
 
     // Save button
-    saveButton = new QPushButton("Apply Hotkey");
+    saveButton = new QPushButton(m_action == HotkeyAction::AutoPress ? "Apply Key" : "Apply Hotkey");
     saveButton->setMinimumHeight(35);
     saveButton->setCursor(Qt::PointingHandCursor);
     saveButton->setMinimumWidth(180);
@@ -409,10 +414,15 @@ void HotkeySettingsTab::setupMainKeys() {
         keyCombo->addItem(pair.first);
     }
 
-    // Set F6 as default
-    for (int i = 0; i < keyCombo->count(); ++i) {
-        // MODIFICATION: Changed "Print Screen" to "F6"
-        if (keyCombo->itemText(i) == "F6") {
+    selectDefaultKey();
+}
+
+void HotkeySettingsTab::selectDefaultKey() {
+    // F6 starts/stops, F7 pauses/resumes, key press mode taps Space
+    const int defaultKey = m_action == HotkeyAction::PauseResume ? VK_F7
+                         : m_action == HotkeyAction::AutoPress ? VK_SPACE : VK_F6;
+    for (int i = 0; i < keyMap.size(); ++i) {
+        if (keyMap[i].second == defaultKey) {
             keyCombo->setCurrentIndex(i);
             break;
         }
@@ -492,13 +502,8 @@ void HotkeySettingsTab::onSaveClicked() {
 }
 
 void HotkeySettingsTab::onResetClicked() {
-    // MODIFICATION: Also need to set the key back to F6 on reset
+    // MODIFICATION: Also need to set the key back to the default on reset
     setDefaultValues();
-    for (int i = 0; i < keyCombo->count(); ++i) {
-        if (keyCombo->itemText(i) == "F6") {
-            keyCombo->setCurrentIndex(i);
-            break;
-        }
-    }
+    selectDefaultKey();
     updatePreview();
 }
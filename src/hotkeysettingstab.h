@@ -22,11 +22,18 @@ struct Hotkey {
     int keyCode = 0;  // Windows virtual key code
 };
 
+// What a hotkey is bound to; picks the dialog text and the default key
+enum class HotkeyAction {
+    StartStop,   // F6
+    PauseResume, // F7
+    AutoPress    // Space: the chord key press mode sends, not a global hotkey
+};
+
 class HotkeySettingsTab : public QWidget {
     Q_OBJECT
 
 public:
-    explicit HotkeySettingsTab(QWidget *parent = nullptr);
+    explicit HotkeySettingsTab(QWidget *parent = nullptr, HotkeyAction action = HotkeyAction::StartStop);
 
     // Returns currently configured hotkey
     Hotkey getCurrentHotkey() const;
@@ -49,6 +56,9 @@ private:
     void setDefaultValues();
     void updatePreview();
     void onResetClicked();
+    void selectDefaultKey();
+
+    HotkeyAction m_action;
 
     // Modifier checkboxes
     QCheckBox *ctrlCheck;
@@ -1,7 +1,7 @@
 #include "hotkeysettingswindow.h"
 #include <QVBoxLayout>
 
-WindowConfig HotkeySettingsWindow::createConfig()
+WindowConfig HotkeySettingsWindow::createConfig(HotkeyAction action)
 {
     WindowConfig config;
     config.width = 650;
@@ -10,7 +10,8 @@ WindowConfig HotkeySettingsWindow::createConfig()
     config.borderWidth = 1;
     config.backgroundColor = QColor("#1e1e1e");
     config.borderColor = QColor("#242424 ");
-    config.windowTitle = "Hotkey Settings";
+    config.windowTitle = action == HotkeyAction::PauseResume ? "Pause Hotkey Settings"
+                       : action == HotkeyAction::AutoPress ? "Key Press Settings" : "Hotkey Settings";
     config.titleTextColor = QColor("#ff6b00");
     config.titleBarColor = QColor("#242424");
     config.titleBarBorderColor = QColor("#757575");
@@ -29,15 +30,15 @@ WindowConfig HotkeySettingsWindow::createConfig()
     return config;
 }
 
-HotkeySettingsWindow::HotkeySettingsWindow(QWidget *parent)
-    : CustomWindowBase(parent, createConfig())
+HotkeySettingsWindow::HotkeySettingsWindow(QWidget *parent, HotkeyAction action)
+    : CustomWindowBase(parent, createConfig(action))
 {
-    setupWindow();
+    setupWindow(action);
 }
 
-void HotkeySettingsWindow::setupWindow()
+void HotkeySettingsWindow::setupWindow(HotkeyAction action)
 {
-    settingsTab = new HotkeySettingsTab(this);
+    settingsTab = new HotkeySettingsTab(this, action);
 
     QVBoxLayout *mainLayout = qobject_cast<QVBoxLayout*>(centralWidget()->layout());
 
@@ -9,15 +9,15 @@ class HotkeySettingsWindow : public CustomWindowBase
     Q_OBJECT
 
 public:
-    explicit HotkeySettingsWindow(QWidget *parent = nullptr);
+    explicit HotkeySettingsWindow(QWidget *parent = nullptr, HotkeyAction action = HotkeyAction::StartStop);
 
 signals:
     void hotkeySaved(const Hotkey &hotkey);
 
 private:
-    void setupWindow();
+    void setupWindow(HotkeyAction action);
 
-    static WindowConfig createConfig();
+    static WindowConfig createConfig(HotkeyAction action);
 
     HotkeySettingsTab *settingsTab;
 };
@@ -1,10 +1,26 @@
 #include "mainwindow.h"
+#include "PreciseWaiter.h"
+#include "RingLogger.h"
 
 #include <QApplication>
+#include <QDebug>
 
 int main(int argc, char *argv[]) {
     QApplication app(argc, argv);
 
+    // Per-machine spin margin for the high-rate click mode
+    PreciseWaiter::calibrate();
+
+    // Engine-thread log messages are formatted here, off the click path
+    RingLogger::instance().setSink([](RingLogger::Level level, const char* message) {
+        if (level == RingLogger::Level::Warning) {
+            qWarning().noquote() << message;
+        } else {
+            qDebug().noquote() << message;
+        }
+    });
+    RingLogger::instance().start();
+
     // Config
     WindowConfig config;
     config.width = 500;
@@ -32,5 +48,7 @@ int main(int argc, char *argv[]) {
     MainWindow customWindow(nullptr, config);
     customWindow.show();
 
-    return app.exec();
+    const int result = app.exec();
+    RingLogger::instance().stop();
+    return result;
 }
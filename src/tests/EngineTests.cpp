@@ -0,0 +1,538 @@
+// Exact checks of the click engine: runs against the recording backend on a
+// virtual clock, so every click time is a deadline and every count is exact.
+
+#include "ClickEngine.h"
+#include "ClickJobScheduler.h"
+#include "ClickProgram.h"
+#include "EngineClock.h"
+#include "InputCodes.h"
+#include "LiveClickRate.h"
+#include "MacroBuffer.h"
+#include "MacroPlayer.h"
+#include "RateController.h"
+#include "RecordingInputBackend.h"
+#include "TestCheck.h"
+#include "TimingWheel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+using Clock = ClickEngine::Clock;
+using std::chrono::milliseconds;
+
+// Until a finished callback set `done`; false if none did within a few seconds
+bool waitForDone(const std::atomic<bool>& done) {
+    const auto giveUp = Clock::now() + std::chrono::seconds(10);
+    while (!done.load(std::memory_order_acquire) && Clock::now() < giveUp) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return done.load(std::memory_order_acquire);
+}
+
+// One engine run on its own virtual clock and recording backend
+struct Run {
+    VirtualClock clock;
+    RecordingInputBackend backend;
+    ClickEngine engine;
+    std::atomic<bool> done{false};
+    ClickEngine::StopReason reason = ClickEngine::StopReason::Requested;
+
+    explicit Run(size_t capacity = 4096) : backend(capacity, &clock) {
+        engine.setClock(&clock);
+        engine.setFinishedCallback([this](ClickEngine::StopReason r) {
+            reason = r;
+            done.store(true, std::memory_order_release);
+        });
+    }
+
+    bool start(const ClickEngine::Settings& settings, const ClickConfig& config = ClickConfig()) {
+        engine.setClickFunction(compileClickProgram(backend, config, nullptr));
+        return engine.start(settings);
+    }
+
+    // Until the engine ends on its own; false if it did not within a few seconds
+    bool waitFinished() {
+        const bool finished = waitForDone(done);
+        engine.stop();
+        return finished;
+    }
+
+    // Completion times of every button down, in order
+    std::vector<Clock::time_point> downTimes() const {
+        std::vector<Clock::time_point> times;
+        for (const RecordingInputBackend::Record& record : backend.records()) {
+            if (record.event.type == InputEvent::Type::ButtonDown) {
+                times.push_back(record.time);
+            }
+        }
+        return times;
+    }
+};
+
+ClickEngine::Settings every(milliseconds interval) {
+    ClickEngine::Settings settings;
+    settings.interval = interval;
+    return settings;
+}
+} // namespace
+
+TEST(clickLimitIsExact) {
+    Run run;
+    ClickEngine::Settings settings = every(milliseconds(5));
+    settings.clickLimit = 250;
+    CHECK(run.start(settings));
+    CHECK(run.waitFinished());
+
+    CHECK(run.reason == ClickEngine::StopReason::ClickLimit);
+    CHECK_EQ(run.engine.clicksPerformed(), 250);
+    CHECK_EQ(run.engine.remainingClicks(), 0);
+    CHECK_EQ(run.backend.buttonDowns(), 250);
+    CHECK_EQ(run.backend.buttonUps(), 250);
+    CHECK_EQ(run.backend.submits(), 250);
+
+    // Click n lands on start + n * interval
+    const std::vector<Clock::time_point> times = run.downTimes();
+    CHECK_EQ(times.size(), 250);
+    for (size_t i = 0; i < times.size(); ++i) {
+        CHECK_EQ((times[i] - run.engine.startTime()).count(), Clock::duration(milliseconds(5) * (i + 1)).count());
+    }
+}
+
+TEST(clickLimitWithBurstsIsExact) {
+    Run run;
+    ClickEngine::Settings settings = every(milliseconds(1));
+    settings.burst = 7;
+    settings.clickLimit = 250;
+    ClickConfig config;
+    config.burst = settings.burst;
+    CHECK(run.start(settings, config));
+    CHECK(run.waitFinished());
+
+    CHECK(run.reason == ClickEngine::StopReason::ClickLimit);
+    CHECK_EQ(run.engine.clicksPerformed(), 250);
+    CHECK_EQ(run.backend.buttonDowns(), 250);
+    CHECK_EQ(run.backend.buttonUps(), 250);
+    // 35 full bursts, then the 5 left over as a 4 and a 1 batch
+    CHECK_EQ(run.backend.submits(), 35 + 2);
+}
+
+TEST(durationLimitIsExact) {
+    Run run;
+    ClickEngine::Settings settings = every(milliseconds(10));
+    settings.duration = std::chrono::seconds(3);
+    CHECK(run.start(settings));
+    CHECK(run.waitFinished());
+
+    // A click due exactly at the end of the budget still happens
+    CHECK(run.reason == ClickEngine::StopReason::Duration);
+    CHECK_EQ(run.backend.buttonDowns(), 300);
+    CHECK_EQ(run.engine.stats().elapsed.count(), std::chrono::nanoseconds(std::chrono::seconds(3)).count());
+}
+
+TEST(durationLimitWithBurstsIsExact) {
+    Run run;
+    ClickEngine::Settings settings = every(milliseconds(1));
+    settings.burst = 10;
+    settings.duration = milliseconds(500);
+    ClickConfig config;
+    config.burst = settings.burst;
+    CHECK(run.start(settings, config));
+    CHECK(run.waitFinished());
+
+    CHECK(run.reason == ClickEngine::StopReason::Duration);
+    CHECK_EQ(run.backend.buttonDowns(), 5000);
+    CHECK_EQ(run.backend.submits(), 500);
+}
+
+TEST(stopLeavesNoTrailingClick) {
+    // Real time: stop() has to interrupt an actual wait
+    RecordingInputBackend backend(100000);
+    ClickEngine engine;
+    engine.setClickFunction(compileClickProgram(backend, ClickConfig(), nullptr));
+    CHECK(engine.start(every(milliseconds(5))));
+    std::this_thread::sleep_for(milliseconds(100));
+    engine.stop();
+
+    // Every click the engine counted is complete, and nothing follows
+    const int64_t clicks = engine.clicksPerformed();
+    CHECK(clicks > 0);
+    CHECK_EQ(backend.buttonDowns(), clicks);
+    CHECK_EQ(backend.buttonUps(), clicks);
+    CHECK(!engine.isRunning());
+    std::this_thread::sleep_for(milliseconds(50));
+    CHECK_EQ(backend.buttonDowns(), clicks);
+
+    const std::optional<Clock::time_point> end = engine.endTime();
+    CHECK(end.has_value());
+    if (end && !backend.records().empty()) {
+        CHECK(backend.records().back().time <= *end);
+    }
+}
+
+TEST(pauseKeepsThePhase) {
+    Run run;
+    ClickEngine::Settings settings = every(milliseconds(10));
+    settings.clickLimit = 100;
+    settings.duration = std::chrono::seconds(1);
+
+    // Pause from inside click 40; the engine stops before click 41
+    ClickEngine::ClickFunction program = compileClickProgram(run.backend, ClickConfig(), nullptr);
+    int clicked = 0;
+    run.engine.setClickFunction([&](int clicks, std::chrono::nanoseconds& settled) {
+        const int accepted = program(clicks, settled);
+        if (++clicked == 40) {
+            run.engine.pause();
+        }
+        return accepted;
+    });
+    CHECK(run.engine.start(settings));
+
+    while (run.engine.clicksPerformed() < 40) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    // Give the engine thread time to reach its pause wait, then let 2.345 s pass
+    std::this_thread::sleep_for(milliseconds(100));
+    CHECK(run.engine.isPaused());
+    CHECK_EQ(run.backend.buttonDowns(), 40);
+    const auto pausedFor = milliseconds(2345);
+    run.clock.advance(pausedFor);
+    CHECK(run.engine.resume());
+    CHECK(run.waitFinished());
+
+    // Both limits carry over: the paused time is not part of the budget
+    CHECK(run.reason == ClickEngine::StopReason::ClickLimit);
+    CHECK_EQ(run.backend.buttonDowns(), 100);
+    CHECK_EQ(run.engine.stats().elapsed.count(), std::chrono::nanoseconds(milliseconds(1000)).count());
+
+    // Every click after the pause is on the original grid, shifted by the pause
+    const std::vector<Clock::time_point> times = run.downTimes();
+    CHECK_EQ(times.size(), 100);
+    for (size_t i = 0; i < times.size(); ++i) {
+        const Clock::duration expected = milliseconds(10) * (i + 1) + (i >= 40 ? pausedFor : milliseconds(0));
+        CHECK_EQ((times[i] - run.engine.startTime()).count(), expected.count());
+    }
+}
+
+TEST(liveRateIsSteadyAcrossAPause) {
+    Run run;
+    ClickEngine::Settings settings = every(milliseconds(10));
+    settings.clickLimit = 300;
+
+    // Pause from inside click 150, two and a half seconds in
+    ClickEngine::ClickFunction program = compileClickProgram(run.backend, ClickConfig(), nullptr);
+    int clicked = 0;
+    run.engine.setClickFunction([&](int clicks, std::chrono::nanoseconds& settled) {
+        const int accepted = program(clicks, settled);
+        if (++clicked == 150) {
+            run.engine.pause();
+        }
+        return accepted;
+    });
+    CHECK(run.engine.start(settings));
+    while (run.engine.clicksPerformed() < 150) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    std::this_thread::sleep_for(milliseconds(100));
+    CHECK(run.engine.isPaused());
+
+    LiveClickRate rate;
+    auto sample = [&] {
+        run.engine.telemetry().drain([&](const ClickEngine::ClickSample& s) { rate.add(s); });
+        return rate.update(run.engine.stats().elapsed);
+    };
+    const double before = sample();
+    CHECK(before > 99.0 && before < 101.0);
+
+    // Several seconds paused: the rate neither drops nor doubles afterwards
+    run.clock.advance(std::chrono::seconds(5));
+    CHECK(sample() > 99.0 && sample() < 101.0);
+    CHECK(run.engine.resume());
+    CHECK(run.waitFinished());
+    const double after = sample();
+    CHECK(after > 99.0 && after < 101.0);
+}
+
+TEST(settleTimeIsNotPushback) {
+    using std::chrono::microseconds;
+
+    // Fixed position bursts: 1000 clicks every 1 ms, each call about 2.1 ms of
+    // which 2 ms are the two settle sleeps
+    RateController controller;
+    controller.reset(milliseconds(1), 1000);
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(controller.record(1000, 1000, microseconds(2100), microseconds(2020)) == RateController::Verdict::Keep);
+    }
+    CHECK_EQ(controller.burst(), 1000);
+    CHECK_EQ(controller.period().count(), std::chrono::nanoseconds(milliseconds(1)).count());
+    CHECK_EQ(controller.backoffs(), 0);
+
+    // Single clicks every 2 ms, each call slower than the period
+    controller.reset(milliseconds(2), 1);
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(controller.record(1, 1, microseconds(2300), microseconds(2150)) == RateController::Verdict::Keep);
+    }
+    CHECK_EQ(controller.period().count(), std::chrono::nanoseconds(milliseconds(2)).count());
+    CHECK_EQ(controller.backoffs(), 0);
+
+    // The same call time spent blocked in the OS is pushback
+    controller.reset(milliseconds(1), 1000);
+    CHECK(controller.record(1000, 1000, microseconds(2100)) == RateController::Verdict::Changed);
+    CHECK_EQ(controller.burst(), 500);
+    CHECK(controller.record(1000, 1000, microseconds(2100), microseconds(1000)) == RateController::Verdict::Changed);
+    CHECK_EQ(controller.burst(), 250);
+}
+
+TEST(rateRecoversAfterPushback) {
+    RateController controller;
+    controller.reset(milliseconds(1), 64);
+
+    // A batch the queue cut short shrinks to what it took
+    CHECK(controller.record(64, 40, std::chrono::microseconds(100)) == RateController::Verdict::Changed);
+    CHECK_EQ(controller.burst(), 40);
+
+    // Clean calls win the full burst back, a window at a time
+    for (int i = 0; i < 32 * 64 && controller.burst() < 64; ++i) {
+        controller.record(controller.burst(), controller.burst(), std::chrono::microseconds(100));
+    }
+    CHECK_EQ(controller.burst(), 64);
+    CHECK(controller.rateFactor() > 0.999);
+}
+
+namespace {
+// Runs one job whose first batch the backend cuts after cutAfter events, and
+// returns what the scheduler sent to release held buttons and keys
+std::vector<InputEvent> releaseAfterCut(const ClickJob& job, int cutAfter) {
+    VirtualClock clock;
+    RecordingInputBackend backend(64, &clock);
+    backend.cutSubmit(0, cutAfter);
+    ClickJobScheduler scheduler;
+    scheduler.setClock(&clock);
+    scheduler.setBackend(&backend, nullptr);
+    std::atomic<bool> done{false};
+    scheduler.setFinishedCallback([&](ClickEngine::StopReason) { done.store(true, std::memory_order_release); });
+    scheduler.addJob(job);
+    CHECK(scheduler.start());
+    CHECK(waitForDone(done));
+    scheduler.stop();
+
+    std::vector<InputEvent> release;
+    for (size_t i = cutAfter; i < backend.records().size(); ++i) {
+        release.push_back(backend.records()[i].event);
+    }
+    // Nothing further when nothing was held
+    CHECK_EQ(backend.submits(), release.empty() ? 1 : 2);
+    return release;
+}
+} // namespace
+
+TEST(cutBatchReleasesOnlyWhatIsHeld) {
+    // Ctrl, Shift, Space down and Space up went out: Shift then Ctrl come back up
+    ClickJob chord;
+    chord.click.key = InputCode::KeySpace;
+    chord.click.modifiers = KeyModifier::Ctrl | KeyModifier::Shift;
+    chord.interval = milliseconds(10);
+    std::vector<InputEvent> release = releaseAfterCut(chord, 4);
+    CHECK_EQ(release.size(), 2);
+    if (release.size() == 2) {
+        CHECK(release[0].type == InputEvent::Type::KeyUp);
+        CHECK_EQ(release[0].key, InputCode::KeyLeftShift);
+        CHECK(release[1].type == InputEvent::Type::KeyUp);
+        CHECK_EQ(release[1].key, InputCode::KeyLeftCtrl);
+    }
+
+    // A right press went out: only the right button comes back up
+    ClickJob right;
+    right.click.button = MouseButton::Right;
+    right.interval = milliseconds(10);
+    release = releaseAfterCut(right, 1);
+    CHECK_EQ(release.size(), 1);
+    if (release.size() == 1) {
+        CHECK(release[0].type == InputEvent::Type::ButtonUp);
+        CHECK(release[0].button == MouseButton::Right);
+    }
+
+    // A complete click went out: nothing is held, nothing is sent
+    right.click.burst = 2;
+    CHECK(releaseAfterCut(right, 2).empty());
+}
+
+namespace {
+// Plays Space and a left press at 0 and their releases 20 ms later, with the
+// first batch cut after cutAfter events; returns everything the backend took
+std::vector<InputEvent> playCut(int cutAfter) {
+    MacroBuffer macro;
+    macro.append(0, MacroEvent::Type::KeyDown, InputCode::KeySpace, 0, 0);
+    macro.append(0, MacroEvent::Type::ButtonDown, InputCode::BtnLeft, 0, 0);
+    macro.append(20000, MacroEvent::Type::KeyUp, InputCode::KeySpace, 0, 0);
+    macro.append(20000, MacroEvent::Type::ButtonUp, InputCode::BtnLeft, 0, 0);
+
+    VirtualClock clock;
+    RecordingInputBackend backend(64, &clock);
+    backend.cutSubmit(0, cutAfter);
+    MacroPlayer player;
+    player.setClock(&clock);
+    player.setBackend(&backend);
+    player.setMacro(&macro);
+    std::atomic<bool> done{false};
+    player.setFinishedCallback([&](ClickEngine::StopReason) { done.store(true, std::memory_order_release); });
+    CHECK(player.start(MacroPlayer::Settings()));
+    CHECK(waitForDone(done));
+    player.stop();
+
+    std::vector<InputEvent> events;
+    for (const RecordingInputBackend::Record& record : backend.records()) {
+        events.push_back(record.event);
+    }
+    return events;
+}
+} // namespace
+
+TEST(macroReleasesOnlyWhatWentOut) {
+    // Only the Space press went out, so only Space comes back up
+    std::vector<InputEvent> events = playCut(1);
+    CHECK_EQ(events.size(), 2);
+    if (events.size() == 2) {
+        CHECK(events[0].type == InputEvent::Type::KeyDown);
+        CHECK(events[1].type == InputEvent::Type::KeyUp);
+        CHECK_EQ(events[1].key, InputCode::KeySpace);
+    }
+
+    // Nothing went out: nothing to release
+    CHECK(playCut(0).empty());
+}
+
+namespace {
+// The wheel's contract without the wheel: per id its expiry, or Never
+struct WheelModel {
+    uint64_t now = 0;
+    std::vector<uint64_t> expiry;
+
+    explicit WheelModel(int capacity) : expiry(capacity, TimingWheel::Never) {}
+
+    void schedule(int id, uint64_t at) { expiry[id] = std::max(at, now); }
+    void cancel(int id) { expiry[id] = TimingWheel::Never; }
+
+    uint64_t nextExpiry() const { return *std::min_element(expiry.begin(), expiry.end()); }
+
+    // (expiry, id) of everything due by `to`, earliest first
+    std::vector<std::pair<uint64_t, int>> advance(uint64_t to) {
+        std::vector<std::pair<uint64_t, int>> due;
+        for (int id = 0; id < static_cast<int>(expiry.size()); ++id) {
+            if (expiry[id] <= to) {
+                due.emplace_back(expiry[id], id);
+                expiry[id] = TimingWheel::Never;
+            }
+        }
+        std::sort(due.begin(), due.end());
+        now = std::max(now, to);
+        return due;
+    }
+};
+} // namespace
+
+TEST(timingWheelMatchesBruteForce) {
+    const int ids = 48;
+    TimingWheel wheel;
+    wheel.reserve(ids);
+    WheelModel model(ids);
+    std::mt19937_64 random(20240517);
+
+    // Distances and steps from the same tick up to past the top level's
+    // horizon, so entries cascade through every level
+    const auto distance = [&random]() {
+        const int bits = static_cast<int>(random() % (TimingWheel::SlotBits * TimingWheel::Levels + 4));
+        return random() % (uint64_t(1) << bits);
+    };
+
+    int mismatches = 0;
+    int fired = 0;
+    for (int step = 0; step < 20000; ++step) {
+        const int id = static_cast<int>(random() % ids);
+        switch (random() % 4) {
+        case 0:
+        case 1: {
+            // Now and then in the past, which is due on the next advance
+            const uint64_t at = random() % 8 == 0 ? model.now - std::min<uint64_t>(model.now, random() % 100)
+                                                  : model.now + distance();
+            wheel.schedule(id, at);
+            model.schedule(id, at);
+            break;
+        }
+        case 2:
+            wheel.cancel(id);
+            model.cancel(id);
+            break;
+        case 3: {
+            // Half the time straight to the next expiry, the way the scheduler wakes
+            const uint64_t next = model.nextExpiry();
+            const uint64_t to = random() % 2 == 0 && next != TimingWheel::Never ? next : model.now + distance();
+            std::vector<std::pair<uint64_t, int>> due;
+            wheel.advance(to, [&](int expired) { due.emplace_back(wheel.expiryOf(expired), expired); });
+            const std::vector<std::pair<uint64_t, int>> expected = model.advance(to);
+
+            // Same-tick entries come in any order; ticks must not
+            for (size_t i = 1; i < due.size(); ++i) {
+                mismatches += due[i - 1].first <= due[i].first ? 0 : 1;
+            }
+            std::sort(due.begin(), due.end());
+            mismatches += due == expected ? 0 : 1;
+            mismatches += wheel.now() == model.now ? 0 : 1;
+            fired += static_cast<int>(due.size());
+            break;
+        }
+        }
+
+        mismatches += wheel.nextExpiry() == model.nextExpiry() ? 0 : 1;
+        int scheduled = 0;
+        for (int i = 0; i < ids; ++i) {
+            const bool inModel = model.expiry[i] != TimingWheel::Never;
+            scheduled += inModel ? 1 : 0;
+            mismatches += wheel.isScheduled(i) == inModel ? 0 : 1;
+            mismatches += !inModel || wheel.expiryOf(i) == model.expiry[i] ? 0 : 1;
+        }
+        mismatches += wheel.size() == scheduled ? 0 : 1;
+    }
+    CHECK_EQ(mismatches, 0);
+    // The run must actually exercise expiry
+    CHECK(fired > 1000);
+}
+
+TEST(timingWheelCallbackMayReschedule) {
+    // A periodic entry rescheduled from its own callback fires once per period,
+    // across the first level's boundary and into the next
+    TimingWheel wheel;
+    wheel.reserve(2);
+    wheel.schedule(0, 3);
+    wheel.schedule(1, 5000);
+    std::vector<uint64_t> fired;
+    wheel.advance(200, [&](int id) {
+        fired.push_back(wheel.now());
+        wheel.schedule(id, wheel.now() + 50);
+    });
+    const std::vector<uint64_t> expected = {3, 53, 103, 153};
+    CHECK(fired == expected);
+    CHECK_EQ(wheel.nextExpiry(), 203);
+    CHECK_EQ(wheel.now(), 200);
+
+    // Rescheduled at or before now waits for the next call
+    fired.clear();
+    wheel.advance(203, [&](int id) {
+        fired.push_back(wheel.now());
+        wheel.schedule(id, wheel.now());
+    });
+    CHECK_EQ(fired.size(), 1);
+    CHECK_EQ(wheel.nextExpiry(), 203);
+    wheel.cancel(0);
+    CHECK_EQ(wheel.nextExpiry(), 5000);
+    CHECK_EQ(wheel.size(), 1);
+}
+
+int main() {
+    return test::runAll();
+}
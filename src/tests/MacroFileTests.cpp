@@ -0,0 +1,221 @@
+// Macro file checks: the written file decodes to exactly the events that went
+// in, any damaged byte in a block is caught, and blocks read in any order.
+// Files are written to the working directory, the build directory under ctest.
+
+#include "MacroBuffer.h"
+#include "MacroFile.h"
+#include "MappedMacroFile.h"
+#include "TestCheck.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+const char* const MacroPath = "MacroFileTests.flmacro";
+const char* const DamagedPath = "MacroFileTests.damaged.flmacro";
+constexpr size_t EventCount = 100000;
+
+// Every event type, with the awkward values mixed in: equal timestamps,
+// long gaps, extreme coordinates and codes
+void fillMacro(MacroBuffer& macro) {
+    std::mt19937_64 random(20260417);
+    int64_t time = 0;
+    for (size_t i = 0; i < EventCount; ++i) {
+        const uint64_t r = random();
+        switch (r % 16) {
+        case 0: break;                                       // same microsecond
+        case 1: time += int64_t(1) << (20 + r % 20); break;  // seconds to days
+        default: time += static_cast<int64_t>(r % 20000); break;
+        }
+
+        MacroEvent event;
+        event.timeUs = time;
+        event.type = static_cast<MacroEvent::Type>((r >> 8) % 7);
+        const uint64_t v = random();
+        switch (event.type) {
+        case MacroEvent::Type::Move:
+        case MacroEvent::Type::Wheel:
+            event.x = static_cast<int32_t>(static_cast<int64_t>(v % 201) - 100);
+            event.y = static_cast<int32_t>(static_cast<int64_t>((v >> 16) % 201) - 100);
+            break;
+        case MacroEvent::Type::MoveAbsolute:
+            if (v % 50 == 0) {
+                event.x = std::numeric_limits<int32_t>::min();
+                event.y = std::numeric_limits<int32_t>::max();
+            } else {
+                event.x = static_cast<int32_t>(static_cast<int64_t>(v % 7680) - 3840);
+                event.y = static_cast<int32_t>(static_cast<int64_t>((v >> 16) % 4320) - 1080);
+            }
+            break;
+        default:
+            event.code = static_cast<uint16_t>(v % 2 ? v % 0x300 : 0xFFFF);
+            break;
+        }
+        macro.append(event);
+    }
+}
+
+bool sameEvent(const MacroEvent& a, const MacroEvent& b) {
+    return a.timeUs == b.timeUs && a.type == b.type && a.code == b.code && a.x == b.x && a.y == b.y;
+}
+
+std::vector<uint8_t> readFile(const char* path) {
+    std::vector<uint8_t> bytes;
+    if (std::FILE* file = std::fopen(path, "rb")) {
+        uint8_t buffer[65536];
+        size_t n;
+        while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            bytes.insert(bytes.end(), buffer, buffer + n);
+        }
+        std::fclose(file);
+    }
+    return bytes;
+}
+
+bool writeFile(const char* path, const std::vector<uint8_t>& bytes) {
+    std::FILE* file = std::fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    const bool ok = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+// Shared by the cases: written once, removed by the last one
+MacroBuffer& macro() {
+    static MacroBuffer buffer;
+    if (buffer.empty()) {
+        fillMacro(buffer);
+    }
+    return buffer;
+}
+} // namespace
+
+TEST(roundTripIsExact) {
+    std::string error;
+    CHECK(saveMacroFile(macro(), MacroPath, error));
+
+    MappedMacroFile file;
+    CHECK(file.open(MacroPath));
+    CHECK_EQ(file.size(), EventCount);
+    CHECK_EQ(file.durationUs(), macro().durationUs());
+    CHECK_EQ(file.blockCount(), (EventCount + MacroBlockEvents - 1) / MacroBlockEvents);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < EventCount; ++i) {
+        MacroEvent event;
+        if (!file.read(i, event) || !sameEvent(event, macro().at(i))) {
+            ++mismatches;
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+TEST(blocksReadInAnyOrder) {
+    MappedMacroFile file;
+    CHECK(file.open(MacroPath));
+
+    // Backwards, so every block is decoded again from the last one
+    size_t mismatches = 0;
+    for (size_t i = EventCount; i-- > 0;) {
+        MacroEvent event;
+        if (!file.read(i, event) || !sameEvent(event, macro().at(i))) {
+            ++mismatches;
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+
+    // Jumping between blocks, and the edges of each
+    std::mt19937 random(7);
+    for (int i = 0; i < 20000; ++i) {
+        const size_t index = random() % EventCount;
+        MacroEvent event;
+        if (!file.read(index, event) || !sameEvent(event, macro().at(index))) {
+            ++mismatches;
+        }
+    }
+    for (size_t block = 0; block < file.blockCount(); ++block) {
+        const size_t first = block * MacroBlockEvents;
+        const size_t last = std::min(first + MacroBlockEvents, EventCount) - 1;
+        for (size_t index : {last, first}) {
+            MacroEvent event;
+            if (!file.read(index, event) || !sameEvent(event, macro().at(index))) {
+                ++mismatches;
+            }
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+
+    MacroEvent event;
+    CHECK(!file.read(EventCount, event));
+}
+
+TEST(singleByteCorruptionIsDetected) {
+    const std::vector<uint8_t> original = readFile(MacroPath);
+    CHECK(original.size() > sizeof(MacroFileHeader));
+    if (original.size() <= sizeof(MacroFileHeader)) {
+        return;
+    }
+    MacroFileHeader header;
+    std::memcpy(&header, original.data(), sizeof(header));
+    CHECK(header.indexOffset <= original.size());
+
+    // The first and last byte of every block, then bytes anywhere in between
+    std::vector<MacroBlockEntry> index(header.blockCount);
+    std::memcpy(index.data(), original.data() + header.indexOffset, index.size() * sizeof(MacroBlockEntry));
+    std::vector<uint64_t> offsets;
+    for (const MacroBlockEntry& entry : index) {
+        offsets.push_back(entry.offset);
+        offsets.push_back(entry.offset + entry.bytes - 1);
+    }
+    std::mt19937_64 random(11);
+    for (int i = 0; i < 100; ++i) {
+        offsets.push_back(sizeof(MacroFileHeader) + random() % (header.indexOffset - sizeof(MacroFileHeader)));
+    }
+
+    // Whole blocks are checked: the damaged one must fail, the others read as written
+    int undetected = 0;
+    int spurious = 0;
+    for (uint64_t offset : offsets) {
+        std::vector<uint8_t> damaged = original;
+        damaged[offset] ^= static_cast<uint8_t>(1u << (offset % 8));
+        CHECK(writeFile(DamagedPath, damaged));
+
+        MappedMacroFile file;
+        CHECK(file.open(DamagedPath));
+        for (size_t block = 0; block < index.size(); ++block) {
+            const bool isDamaged = offset >= index[block].offset && offset < index[block].offset + index[block].bytes;
+            bool intact = true;
+            const size_t first = block * MacroBlockEvents;
+            const size_t last = std::min(first + MacroBlockEvents, EventCount);
+            for (size_t i = first; intact && i < last; ++i) {
+                MacroEvent event;
+                intact = file.read(i, event) && sameEvent(event, macro().at(i));
+            }
+            if (isDamaged && intact) {
+                ++undetected;
+            }
+            if (!isDamaged && !intact) {
+                ++spurious;
+            }
+            if (isDamaged && !intact) {
+                CHECK(!file.lastError().empty());
+            }
+        }
+    }
+    CHECK_EQ(spurious, 0);
+    CHECK_EQ(undetected, 0);
+
+    std::remove(DamagedPath);
+    std::remove(MacroPath);
+}
+
+int main() {
+    return test::runAll();
+}
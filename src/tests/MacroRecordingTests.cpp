@@ -0,0 +1,232 @@
+// Macro capture checks: the buffer grows without moving what it already holds,
+// and the evdev recorder (fed from a pipe) merges each SYN_REPORT frame into
+// one event per kind, in the order the frame happened.
+
+#include "MacroBuffer.h"
+#include "TestCheck.h"
+
+#ifdef __linux__
+#include "EvdevMacroRecorder.h"
+
+#include <chrono>
+#include <fcntl.h>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+MacroEvent eventAt(size_t i) {
+    MacroEvent event;
+    event.timeUs = static_cast<int64_t>(i) * 10;
+    event.type = static_cast<MacroEvent::Type>(i % 7);
+    event.code = static_cast<uint16_t>(i % 0x300);
+    event.x = static_cast<int32_t>(i);
+    event.y = -static_cast<int32_t>(i);
+    return event;
+}
+
+bool sameEvent(const MacroEvent& a, const MacroEvent& b) {
+    return a.timeUs == b.timeUs && a.type == b.type && a.code == b.code && a.x == b.x && a.y == b.y;
+}
+} // namespace
+
+TEST(bufferGrowsWithoutMoving) {
+    MacroBuffer buffer;
+    CHECK_EQ(buffer.capacity(), 0);
+    buffer.append(eventAt(0));
+    CHECK_EQ(buffer.capacity(), MacroBuffer::ChunkSize);
+    const MacroBuffer::Chunk* first = &buffer.chunk(0);
+
+    // Past three chunk boundaries: one new chunk each, the first one stays put
+    const size_t count = 3 * MacroBuffer::ChunkSize + 5;
+    for (size_t i = 1; i < count; ++i) {
+        buffer.append(eventAt(i));
+    }
+    CHECK(&buffer.chunk(0) == first);
+    CHECK_EQ(buffer.size(), count);
+    CHECK_EQ(buffer.capacity(), 4 * MacroBuffer::ChunkSize);
+    CHECK_EQ(buffer.chunkCount(), 4);
+    CHECK_EQ(buffer.chunkLength(2), MacroBuffer::ChunkSize);
+    CHECK_EQ(buffer.chunkLength(3), 5);
+    CHECK_EQ(buffer.durationUs(), eventAt(count - 1).timeUs);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < count; ++i) {
+        mismatches += sameEvent(buffer.at(i), eventAt(i)) ? 0 : 1;
+    }
+    CHECK_EQ(mismatches, 0);
+
+    // Shrinking keeps the chunks for the next recording
+    buffer.truncate(MacroBuffer::ChunkSize);
+    CHECK_EQ(buffer.size(), MacroBuffer::ChunkSize);
+    CHECK_EQ(buffer.chunkCount(), 1);
+    buffer.truncate(count);
+    CHECK_EQ(buffer.size(), MacroBuffer::ChunkSize);
+    buffer.clear();
+    CHECK(buffer.empty());
+    CHECK_EQ(buffer.durationUs(), 0);
+    CHECK_EQ(buffer.capacity(), 4 * MacroBuffer::ChunkSize);
+    CHECK(&buffer.chunk(0) == first);
+}
+
+TEST(reservedBufferDoesNotAllocate) {
+    MacroBuffer buffer;
+    const size_t count = 2 * MacroBuffer::ChunkSize + 1;
+    buffer.reserve(count);
+    const size_t reserved = buffer.capacity();
+    CHECK(reserved >= count);
+    std::vector<const MacroBuffer::Chunk*> chunks;
+    for (size_t i = 0; i < reserved / MacroBuffer::ChunkSize; ++i) {
+        chunks.push_back(&buffer.chunk(i));
+    }
+
+    for (size_t i = 0; i < reserved; ++i) {
+        buffer.append(eventAt(i));
+    }
+    CHECK_EQ(buffer.capacity(), reserved);
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        CHECK(&buffer.chunk(i) == chunks[i]);
+    }
+    // The next event is the first one past the reservation
+    buffer.append(eventAt(reserved));
+    CHECK_EQ(buffer.capacity(), reserved + MacroBuffer::ChunkSize);
+}
+
+#ifdef __linux__
+namespace {
+using std::chrono::milliseconds;
+
+int64_t monotonicUs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+// Writes input_events stamped like the kernel does, one frame per time
+struct EventPipe {
+    int fds[2] = {-1, -1};
+
+    EventPipe() {
+        if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) != 0) {
+            fds[0] = fds[1] = -1;
+        }
+    }
+    ~EventPipe() { close(); }
+
+    void close() {
+        if (fds[1] >= 0) {
+            ::close(fds[1]);
+            fds[1] = -1;
+        }
+    }
+
+    bool send(int64_t timeUs, uint16_t type, uint16_t code, int32_t value) {
+        input_event event{};
+        event.input_event_sec = static_cast<decltype(event.input_event_sec)>(timeUs / 1000000);
+        event.input_event_usec = static_cast<decltype(event.input_event_usec)>(timeUs % 1000000);
+        event.type = type;
+        event.code = code;
+        event.value = value;
+        return ::write(fds[1], &event, sizeof(event)) == static_cast<ssize_t>(sizeof(event));
+    }
+};
+
+// Until the recorder appended `count` events; false if it did not within a few seconds
+bool waitForEvents(const MacroBuffer& buffer, size_t count) {
+    const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (buffer.size() < count && std::chrono::steady_clock::now() < giveUp) {
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    return buffer.size() >= count;
+}
+} // namespace
+
+TEST(recorderMergesEachFrame) {
+    EventPipe pipe;
+    CHECK(pipe.fds[0] >= 0);
+    if (pipe.fds[0] < 0) {
+        return;
+    }
+    MacroBuffer buffer;
+    EvdevMacroRecorder recorder;
+    CHECK(recorder.startOn(buffer, pipe.fds[0]));
+    const int64_t base = monotonicUs() + 1000000;
+
+    // Split motion and a wheel step: one move and one wheel event
+    const int64_t t1 = base;
+    pipe.send(t1, EV_REL, REL_X, 3);
+    pipe.send(t1, EV_REL, REL_Y, 4);
+    pipe.send(t1, EV_REL, REL_X, 2);
+    pipe.send(t1, EV_REL, REL_WHEEL, 1);
+    pipe.send(t1, EV_SYN, SYN_REPORT, 0);
+    // Motion before a press in the same frame comes first
+    const int64_t t2 = base + 2500;
+    pipe.send(t2, EV_REL, REL_X, 1);
+    pipe.send(t2, EV_KEY, BTN_LEFT, 1);
+    pipe.send(t2, EV_SYN, SYN_REPORT, 0);
+    // Auto-repeat is not part of the macro
+    const int64_t t3 = base + 4000;
+    pipe.send(t3, EV_KEY, KEY_A, 1);
+    pipe.send(t3, EV_SYN, SYN_REPORT, 0);
+    pipe.send(t3 + 500, EV_KEY, KEY_A, 2);
+    pipe.send(t3 + 500, EV_SYN, SYN_REPORT, 0);
+    // Everything up to the frame end after an overflow is dropped
+    pipe.send(base + 5000, EV_SYN, SYN_DROPPED, 0);
+    pipe.send(base + 5000, EV_REL, REL_X, 7);
+    pipe.send(base + 5000, EV_KEY, BTN_RIGHT, 1);
+    pipe.send(base + 5000, EV_SYN, SYN_REPORT, 0);
+    // Releases; one of a key pressed before recording started is skipped
+    const int64_t t4 = base + 6000;
+    pipe.send(t4, EV_KEY, BTN_LEFT, 0);
+    pipe.send(t4, EV_KEY, KEY_B, 0);
+    pipe.send(t4, EV_KEY, KEY_A, 0);
+    pipe.send(t4, EV_SYN, SYN_REPORT, 0);
+    // Still held when recording stops, like the stop hotkey
+    pipe.send(base + 7000, EV_KEY, KEY_C, 1);
+    pipe.send(base + 7000, EV_SYN, SYN_REPORT, 0);
+
+    CHECK(waitForEvents(buffer, 8));
+    recorder.stop();
+    CHECK_EQ(recorder.droppedFrames(), 1);
+
+    using Type = MacroEvent::Type;
+    struct Expected {
+        Type type;
+        uint16_t code;
+        int32_t x;
+        int32_t y;
+        int64_t sinceFirstUs;
+    };
+    const Expected expected[] = {
+        {Type::Move, 0, 5, 4, 0},
+        {Type::Wheel, 0, 0, 1, 0},
+        {Type::Move, 0, 1, 0, t2 - t1},
+        {Type::ButtonDown, BTN_LEFT, 0, 0, t2 - t1},
+        {Type::KeyDown, KEY_A, 0, 0, t3 - t1},
+        {Type::ButtonUp, BTN_LEFT, 0, 0, t4 - t1},
+        {Type::KeyUp, KEY_A, 0, 0, t4 - t1},
+    };
+    CHECK_EQ(buffer.size(), sizeof(expected) / sizeof(expected[0]));
+    if (buffer.size() != sizeof(expected) / sizeof(expected[0])) {
+        return;
+    }
+    const int64_t first = buffer.at(0).timeUs;
+    CHECK(first > 0);
+    for (size_t i = 0; i < buffer.size(); ++i) {
+        const MacroEvent event = buffer.at(i);
+        CHECK(event.type == expected[i].type);
+        CHECK_EQ(event.code, expected[i].code);
+        CHECK_EQ(event.x, expected[i].x);
+        CHECK_EQ(event.y, expected[i].y);
+        CHECK_EQ(event.timeUs - first, expected[i].sinceFirstUs);
+    }
+}
+#endif
+
+int main() {
+    return test::runAll();
+}
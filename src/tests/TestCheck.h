@@ -0,0 +1,68 @@
+#ifndef TESTCHECK_H
+#define TESTCHECK_H
+
+#include <cstdio>
+#include <vector>
+
+// Minimal checks for the test executables. TEST(name) registers a case,
+// a failed CHECK reports file:line and fails it, and runAll() returns
+// non-zero if any case failed, which is what ctest looks at.
+namespace test {
+struct Case {
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<Case>& cases() {
+    static std::vector<Case> list;
+    return list;
+}
+
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+
+struct Registrar {
+    Registrar(const char* name, void (*run)()) { cases().push_back({name, run}); }
+};
+
+inline int runAll() {
+    int failed = 0;
+    for (const Case& c : cases()) {
+        const int before = failures();
+        c.run();
+        const bool ok = failures() == before;
+        failed += ok ? 0 : 1;
+        std::printf("%-40s %s\n", c.name, ok ? "ok" : "FAILED");
+    }
+    std::printf("%d of %d test(s) failed\n", failed, static_cast<int>(cases().size()));
+    return failed == 0 ? 0 : 1;
+}
+} // namespace test
+
+#define TEST(name)                                                \
+    static void name();                                           \
+    static const test::Registrar name##Registrar(#name, name);   \
+    static void name()
+
+#define CHECK(condition)                                                                    \
+    do {                                                                                    \
+        if (!(condition)) {                                                                 \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++test::failures();                                                             \
+        }                                                                                   \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                                  \
+    do {                                                                                            \
+        const long long actualValue = static_cast<long long>(actual);                               \
+        const long long expectedValue = static_cast<long long>(expected);                           \
+        if (actualValue != expectedValue) {                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ failed: %s is %lld, expected %lld\n", __FILE__, __LINE__, \
+                         #actual, actualValue, expectedValue);                                      \
+            ++test::failures();                                                                     \
+        }                                                                                           \
+    } while (0)
+
+#endif // TESTCHECK_H
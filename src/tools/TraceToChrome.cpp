@@ -0,0 +1,170 @@
+// Converts a binary click trace (FLAME_TRACE=<path>) into Chrome trace_event
+// JSON for chrome://tracing or ui.perfetto.dev.
+//
+// Each run becomes a span, each click an "inject" slice, each late wake-up a
+// "late wake" slice from the deadline to the actual wake time, and wake-up
+// lateness is also plotted as a counter track. Pauses are "paused" slices;
+// errors and missed deadlines are instant events. Adaptive rate changes are
+// plotted as a "click rate" counter track.
+//
+// Usage: TraceToChrome TRACE_FILE [OUTPUT_JSON]   (default output: stdout)
+
+#include "TraceFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+const char* stopReasonName(int64_t reason) {
+    // ClickEngine::StopReason order
+    switch (reason) {
+    case 0: return "stopped";
+    case 1: return "click limit";
+    case 2: return "duration";
+    case 3: return "error";
+    default: return "unknown";
+    }
+}
+
+bool readTrace(const char* path, TraceFileHeader& header, std::vector<TraceRecord>& records) {
+    FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        std::fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+           && std::memcmp(header.magic, TraceMagic, sizeof(TraceMagic)) == 0
+           && header.version == TraceVersion
+           && header.recordSize == sizeof(TraceRecord)
+           && header.ticksPerSecond > 0;
+    if (!ok) {
+        std::fprintf(stderr, "%s is not a click trace (version %u)\n", path, TraceVersion);
+        std::fclose(file);
+        return false;
+    }
+
+    // The header count is only trusted as far as the file actually reaches,
+    // so a damaged count cannot make us allocate for records that are not there
+    uint64_t available = 0;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        const long size = std::ftell(file);
+        if (size > static_cast<long>(sizeof(header))) {
+            available = (static_cast<uint64_t>(size) - sizeof(header)) / sizeof(TraceRecord);
+        }
+    }
+    std::fseek(file, static_cast<long>(sizeof(header)), SEEK_SET);
+
+    // A trace cut short by a crash is still usable up to the last full record
+    const uint64_t count = header.recordCount < available ? header.recordCount : available;
+    if (count != header.recordCount) {
+        std::fprintf(stderr, "Trace truncated: %llu of %llu records\n", static_cast<unsigned long long>(count),
+                     static_cast<unsigned long long>(header.recordCount));
+    }
+    records.resize(static_cast<size_t>(count));
+    const size_t read = records.empty() ? 0 : std::fread(records.data(), sizeof(TraceRecord), records.size(), file);
+    std::fclose(file);
+    records.resize(read);
+    return true;
+}
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::fprintf(stderr, "Usage: %s TRACE_FILE [OUTPUT_JSON]\n", argv[0]);
+        return 2;
+    }
+
+    TraceFileHeader header;
+    std::vector<TraceRecord> records;
+    if (!readTrace(argv[1], header, records)) {
+        return 1;
+    }
+
+    FILE* out = argc == 3 ? std::fopen(argv[2], "w") : stdout;
+    if (!out) {
+        std::fprintf(stderr, "Cannot write %s\n", argv[2]);
+        return 1;
+    }
+
+    // trace_event timestamps are microseconds; start the timeline at zero
+    const int64_t origin = records.empty() ? 0 : records.front().time;
+    const double usPerTick = 1e6 / static_cast<double>(header.ticksPerSecond);
+    auto us = [&](int64_t ticks) { return (ticks - origin) * usPerTick; };
+
+    std::fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    std::fprintf(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"click engine\"}}");
+
+    int64_t runStart = 0;
+    bool inRun = false;
+    for (const TraceRecord& record : records) {
+        switch (record.type) {
+        case TraceRecord::RunStart:
+            runStart = record.time;
+            inRun = true;
+            std::fprintf(out, ",\n{\"name\":\"run start\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":1,\"ts\":%.3f,"
+                              "\"args\":{\"interval_us\":%.3f,\"click_limit\":%lld}}",
+                         us(record.time), record.value * usPerTick, static_cast<long long>(record.tick));
+            break;
+        case TraceRecord::Wake: {
+            const double lateUs = (record.time - record.value) * usPerTick;
+            if (lateUs > 0.0) {
+                std::fprintf(out, ",\n{\"name\":\"late wake\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+                                  "\"args\":{\"tick\":%lld}}",
+                             us(record.value), lateUs, static_cast<long long>(record.tick));
+            }
+            std::fprintf(out, ",\n{\"name\":\"wake lateness us\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"late\":%.3f}}",
+                         us(record.time), lateUs);
+            break;
+        }
+        case TraceRecord::Inject:
+            std::fprintf(out, ",\n{\"name\":\"inject\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+                              "\"args\":{\"tick\":%lld}}",
+                         us(record.time), (record.value - record.time) * usPerTick, static_cast<long long>(record.tick));
+            break;
+        case TraceRecord::Error:
+            std::fprintf(out, ",\n{\"name\":\"injection error\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":1,\"ts\":%.3f,"
+                              "\"args\":{\"tick\":%lld}}",
+                         us(record.time), static_cast<long long>(record.tick));
+            break;
+        case TraceRecord::Pause:
+            std::fprintf(out, ",\n{\"name\":\"paused\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f,"
+                              "\"args\":{\"after_tick\":%lld}}",
+                         us(record.time), (record.value - record.time) * usPerTick, static_cast<long long>(record.tick));
+            break;
+        case TraceRecord::Missed:
+            std::fprintf(out, ",\n{\"name\":\"missed deadlines\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":1,\"ts\":%.3f,"
+                              "\"args\":{\"tick\":%lld,\"missed\":%lld}}",
+                         us(record.time), static_cast<long long>(record.tick), static_cast<long long>(record.value));
+            break;
+        case TraceRecord::Rate:
+            // value: new period in ticks, tick: new burst size
+            if (record.value > 0) {
+                std::fprintf(out, ",\n{\"name\":\"click rate\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,"
+                                  "\"args\":{\"clicks_per_second\":%.1f,\"burst\":%lld}}",
+                             us(record.time), record.tick * 1e6 / (record.value * usPerTick),
+                             static_cast<long long>(record.tick));
+            }
+            break;
+        case TraceRecord::RunEnd:
+            if (inRun) {
+                std::fprintf(out, ",\n{\"name\":\"run\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%.3f,\"dur\":%.3f,"
+                                  "\"args\":{\"clicks\":%lld,\"end\":\"%s\"}}",
+                             us(runStart), (record.time - runStart) * usPerTick,
+                             static_cast<long long>(record.tick), stopReasonName(record.value));
+            }
+            inRun = false;
+            break;
+        default:
+            break;
+        }
+    }
+
+    std::fprintf(out, "\n]}\n");
+    if (out != stdout) {
+        std::fclose(out);
+    }
+    std::fprintf(stderr, "Converted %zu records\n", records.size());
+    return 0;
+}